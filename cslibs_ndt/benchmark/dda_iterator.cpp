@@ -0,0 +1,51 @@
+#include <cslibs_ndt/utility/utility.hpp>
+#include <cslibs_math/random/random.hpp>
+#include <cslibs_math_3d/linear/pose.hpp>
+#include <cslibs_math_3d/algorithms/simple_iterator.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_RAYS = 100000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+using point_t   = cslibs_math_3d::Point3d;
+using dda_t     = cslibs_ndt::utility::DDAIterator<double,3>;
+
+int main()
+{
+    const double resolution = 0.5;
+    rng_t rng(-20.0, 20.0);
+    const point_t origin(0.3, -0.2, 1.1);
+    std::vector<point_t> points;
+    for (std::size_t k=0; k<NUM_RAYS; ++k)
+        points.emplace_back(rng.get(), rng.get(), rng.get());
+
+    std::size_t simple_cells = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const point_t &p : points)
+        for (cslibs_math_3d::algorithms::SimpleIterator<double> it(origin, p, resolution); !it.done(); ++ it)
+            simple_cells += static_cast<std::size_t>(it()[0] & 1);
+    const double simple_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_RAYS;
+
+    std::size_t dda_cells = 0;
+    start = std::chrono::steady_clock::now();
+    for (const point_t &p : points)
+        for (dda_t it(origin, p, resolution); !it.done(); ++ it)
+            dda_cells += static_cast<std::size_t>(it()[0] & 1);
+    const double dda_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_RAYS;
+
+    std::size_t simple_steps = 0, dda_steps = 0;
+    for (const point_t &p : points) {
+        for (cslibs_math_3d::algorithms::SimpleIterator<double> it(origin, p, resolution); !it.done(); ++ it)
+            ++ simple_steps;
+        dda_steps += static_cast<std::size_t>(dda_t(origin, p, resolution).remaining());
+    }
+
+    /// the simple iterator skips cells the ray only cuts through diagonally
+    std::cout << "[DDAIterator]: simple iterator " << simple_ns << "ns/ray (" << static_cast<double>(simple_steps) / NUM_RAYS << " cells/ray), "
+              << "dda " << dda_ns << "ns/ray (" << static_cast<double>(dda_steps) / NUM_RAYS << " cells/ray), "
+              << "checksum " << simple_cells + dda_cells << std::endl;
+    return 0;
+}
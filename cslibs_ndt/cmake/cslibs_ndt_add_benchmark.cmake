@@ -0,0 +1,27 @@
+# add_benchmark builds a timing executable which is not registered as a test,
+# it is only built with -D<project>_BUILD_BENCHMARKS=ON or -DCSLIBS_NDT_BUILD_BENCHMARKS=ON
+#   BENCHMARK_NAME : is the name for the executable
+#   BENCHMARK_SRCS : a list of sources - make sure to wrap into quotes
+#   BENCHMARK_LIBS : a list of libraries to link - make sure to wrap into quotes
+#                    and use semicoli as delimiters.
+function(${PROJECT_NAME}_add_benchmark)
+    if(NOT (${PROJECT_NAME}_BUILD_BENCHMARKS OR CSLIBS_NDT_BUILD_BENCHMARKS))
+        return()
+    endif()
+
+    cmake_parse_arguments(benchmark
+        ""          # list of names of the boolean arguments (only defined ones will be true)
+        ""          # list of names of mono-valued arguments
+        "SRCS;LIBS" # list of names of multi-valued arguments (output variables are lists)
+        ${ARGN}     # arguments of the function to parse, here we take the all original ones
+    )
+
+    set(benchmark_NAME ${ARGV0})
+    add_executable(${benchmark_NAME}
+        ${benchmark_SRCS}
+    )
+    target_link_libraries(${benchmark_NAME}
+        ${benchmark_LIBS}
+        -lpthread
+    )
+endfunction()
@@ -0,0 +1,27 @@
+#ifndef CSLIBS_NDT_BACKEND_MORTON_HPP
+#define CSLIBS_NDT_BACKEND_MORTON_HPP
+
+#include <cslibs_ndt/backend/paged.hpp>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Backend tag selecting a PagedStorage in Z-order (Morton) layout, so
+ *        spatial neighbours are close in memory and traverse visits bundles
+ *        and distributions in Morton order without sorting.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class Morton {};
+
+template <typename data_t,
+          typename index_t,
+          template <typename, typename, typename...> class backend_t,
+          typename... options_ts>
+struct storage<data_t, index_t, backend_t, Morton<data_t, index_t, options_ts...>>
+{
+    using type = PagedStorage<data_t, index_t, default_page_bits<index_t>::value, true>;
+};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_MORTON_HPP
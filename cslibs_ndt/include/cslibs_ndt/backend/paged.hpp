@@ -0,0 +1,317 @@
+#ifndef CSLIBS_NDT_BACKEND_PAGED_HPP
+#define CSLIBS_NDT_BACKEND_PAGED_HPP
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <algorithm>
+#include <stdexcept>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <cslibs_ndt/backend/storage.hpp>
+#include <cslibs_ndt/utility/morton.hpp>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Backend tag selecting PagedStorage.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class Paged {};
+
+/**
+ * @brief Default page size of PagedStorage, 16x16 in 2D and 8x8x8 in 3D.
+ */
+template <typename index_t>
+struct default_page_bits :
+        std::integral_constant<std::size_t, (std::tuple_size<index_t>::value > 2 ? 3 : 4)> {};
+
+/**
+ * @brief Two-level array, the configured extent is split into pages of
+ *        2^page_bits cells per dimension, which are allocated on first insertion.
+ *        Lookups are O(1) index arithmetic like the dense array, while memory
+ *        is only spent on the touched parts of the extent.
+ *        With z_order the cells of a page are laid out and pages are traversed
+ *        in Z-order (Morton order) of their offset from the array offset,
+ *        otherwise both are row-major.
+ */
+template <typename data_t, typename index_t,
+          std::size_t page_bits = default_page_bits<index_t>::value,
+          bool z_order = false>
+class PagedStorage
+{
+public:
+    static constexpr std::size_t Dim        = std::tuple_size<index_t>::value;
+    static constexpr int         page_edge  = 1 << page_bits;
+    static constexpr int         page_mask  = page_edge - 1;
+    using size_t = std::array<std::size_t, Dim>;
+
+    inline PagedStorage()
+    {
+        size_.fill(0ul);
+        offset_.fill(0);
+        pages_size_.fill(0ul);
+    }
+
+    inline PagedStorage(const PagedStorage &other) :
+        size_(other.size_),
+        offset_(other.offset_),
+        pages_size_(other.pages_size_),
+        pages_(other.pages_.size()),
+        order_(other.order_)
+    {
+        for (std::size_t p=0; p<pages_.size(); ++p)
+            if (other.pages_[p])
+                pages_[p].reset(new page_t(*other.pages_[p]));
+    }
+
+    inline PagedStorage& operator = (const PagedStorage &other)
+    {
+        if (this != &other) {
+            PagedStorage copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    PagedStorage(PagedStorage &&other) = default;
+    PagedStorage& operator = (PagedStorage &&other) = default;
+
+    template <typename tag_t, typename value_t>
+    inline void set(const value_t &value)
+    {
+        configure(tag_t(), value);
+    }
+
+    inline size_t getSize() const
+    {
+        return size_;
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        std::size_t page, cell;
+        if (!toPage(index, page, cell) || !pages_[page])
+            return nullptr;
+        slot_t &s = (*pages_[page])[cell];
+        return s.valid ? &s.data : nullptr;
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        std::size_t page, cell;
+        if (!toPage(index, page, cell) || !pages_[page])
+            return nullptr;
+        const slot_t &s = (*pages_[page])[cell];
+        return s.valid ? &s.data : nullptr;
+    }
+
+    /**
+     * @brief Insert data at index, which has to be inside of the configured
+     *        extent, otherwise std::out_of_range is thrown. Data already
+     *        stored at index is merged.
+     */
+    inline data_t& insert(const index_t &index,
+                          const data_t  &data)
+    {
+        std::size_t page, cell;
+        if (!toPage(index, page, cell))
+            throw std::out_of_range("[PagedStorage]: index outside of the configured extent");
+        std::unique_ptr<page_t> &p = pages_[page];
+        if (!p)
+            p.reset(new page_t(cells()));
+
+        slot_t &s = (*p)[cell];
+        if (s.valid) {
+            s.data.merge(data);
+            return s.data;
+        }
+        s.valid = true;
+        s.data  = data;
+        return s.data;
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        std::size_t page, cell;
+        if (!toPage(index, page, cell) || !pages_[page])
+            return false;
+        slot_t &s = (*pages_[page])[cell];
+        if (!s.valid)
+            return false;
+        s.valid = false;
+        s.data  = data_t();
+        return true;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (std::size_t k=0; k<pages_.size(); ++k) {
+            const std::size_t p = z_order ? order_[k] : k;
+            if (!pages_[p])
+                continue;
+            page_t &page = *pages_[p];
+            for (std::size_t c=0; c<page.size(); ++c)
+                if (page[c].valid)
+                    function(toIndex(p, c), page[c].data);
+        }
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        for (std::size_t k=0; k<pages_.size(); ++k) {
+            const std::size_t p = z_order ? order_[k] : k;
+            if (!pages_[p])
+                continue;
+            const page_t &page = *pages_[p];
+            for (std::size_t c=0; c<page.size(); ++c)
+                if (page[c].valid)
+                    function(toIndex(p, c), page[c].data);
+        }
+    }
+
+    inline std::size_t size() const
+    {
+        std::size_t count = 0;
+        traverse([&count](const index_t &, const data_t &) { ++ count; });
+        return count;
+    }
+
+    inline std::size_t allocatedPages() const
+    {
+        std::size_t count = 0;
+        for (const auto &p : pages_)
+            if (p)
+                ++ count;
+        return count;
+    }
+
+    inline std::size_t byte_size() const
+    {
+        std::size_t size = sizeof(*this) + pages_.size() * sizeof(std::unique_ptr<page_t>);
+        for (const auto &p : pages_)
+            if (p)
+                for (const slot_t &s : *p)
+                    size += sizeof(slot_t) - sizeof(data_t) + s.data.byte_size();
+        return size;
+    }
+
+private:
+    struct EIGEN_ALIGN16 slot_t {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        bool   valid = false;
+        data_t data;
+    };
+    using page_t = std::vector<slot_t, Eigen::aligned_allocator<slot_t>>;
+    using morton_t = utility::morton<Dim>;
+
+    size_t                                  size_;
+    index_t                                 offset_;
+    size_t                                  pages_size_;
+    std::vector<std::unique_ptr<page_t>>    pages_;
+    std::vector<std::size_t>                order_;
+
+    inline static constexpr std::size_t cells()
+    {
+        return static_cast<std::size_t>(1) << (page_bits * Dim);
+    }
+
+    inline void configure(const cis::option::tags::array_size &,
+                          const size_t &size)
+    {
+        size_ = size;
+        std::size_t pages = 1ul;
+        for (std::size_t i=0; i<Dim; ++i) {
+            pages_size_[i] = (size_[i] + page_mask) >> page_bits;
+            pages         *= pages_size_[i];
+        }
+        pages_.clear();
+        pages_.resize(pages);
+
+        order_.clear();
+        if (!z_order)
+            return;
+        std::vector<std::pair<uint64_t, std::size_t>> codes(pages);
+        for (std::size_t p=0; p<pages; ++p) {
+            uint64_t code = 0ull;
+            std::size_t rest = p;
+            for (std::size_t i=0; i<Dim; ++i) {
+                code |= morton_t::spread(rest % pages_size_[i]) << i;
+                rest /= pages_size_[i];
+            }
+            codes[p] = std::make_pair(code, p);
+        }
+        std::sort(codes.begin(), codes.end());
+        order_.reserve(pages);
+        for (const auto &c : codes)
+            order_.emplace_back(c.second);
+    }
+
+    inline void configure(const cis::option::tags::array_offset &,
+                          const index_t &offset)
+    {
+        offset_ = offset;
+    }
+
+    inline bool toPage(const index_t &index,
+                       std::size_t   &page,
+                       std::size_t   &cell) const
+    {
+        page = 0ul;
+        cell = 0ul;
+        std::size_t page_stride = 1ul;
+        for (std::size_t i=0; i<Dim; ++i) {
+            const int local = index[i] - offset_[i];
+            if (local < 0 || local >= static_cast<int>(size_[i]))
+                return false;
+            page += static_cast<std::size_t>(local >> page_bits) * page_stride;
+            cell |= toCell(static_cast<std::size_t>(local & page_mask), i);
+            page_stride *= pages_size_[i];
+        }
+        return true;
+    }
+
+    inline index_t toIndex(std::size_t page,
+                           const std::size_t cell) const
+    {
+        index_t index;
+        for (std::size_t i=0; i<Dim; ++i) {
+            const int p = static_cast<int>(page % pages_size_[i]);
+            page /= pages_size_[i];
+            index[i] = offset_[i] + (p << page_bits) + fromCell(cell, i);
+        }
+        return index;
+    }
+
+    inline static std::size_t toCell(const std::size_t local,
+                                     const std::size_t i)
+    {
+        return z_order ? static_cast<std::size_t>(morton_t::spread(local) << i) :
+                         local << (page_bits * i);
+    }
+
+    inline static int fromCell(const std::size_t cell,
+                               const std::size_t i)
+    {
+        return static_cast<int>(z_order ? morton_t::compact(cell >> i) :
+                                          (cell >> (page_bits * i)) & page_mask);
+    }
+};
+
+template <typename data_t,
+          typename index_t,
+          template <typename, typename, typename...> class backend_t,
+          typename... options_ts>
+struct storage<data_t, index_t, backend_t, Paged<data_t, index_t, options_ts...>>
+{
+    using type = PagedStorage<data_t, index_t>;
+};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_PAGED_HPP
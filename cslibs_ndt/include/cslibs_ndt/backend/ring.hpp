@@ -0,0 +1,182 @@
+#ifndef CSLIBS_NDT_BACKEND_RING_HPP
+#define CSLIBS_NDT_BACKEND_RING_HPP
+
+#include <array>
+#include <vector>
+#include <tuple>
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+
+#include <cslibs_ndt/backend/storage.hpp>
+
+#include <cslibs_math/common/mod.hpp>
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Backend tag selecting RingStorage.
+ */
+template <typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+class Ring {};
+
+/**
+ * @brief Fixed size ring buffer, an index is stored at its position modulo the
+ *        size of the ring. Any window of at most array_size consecutive indices
+ *        can be stored without collisions, indices leaving the window have to
+ *        be removed before indices entering it are inserted.
+ */
+template <typename data_t, typename index_t>
+class RingStorage
+{
+public:
+    static constexpr std::size_t Dim = std::tuple_size<index_t>::value;
+    using size_t = std::array<std::size_t, Dim>;
+
+    inline RingStorage() :
+        count_(0ul)
+    {
+        size_.fill(0ul);
+        stride_.fill(0ul);
+    }
+
+    template <typename tag_t, typename value_t>
+    inline void set(const value_t &value)
+    {
+        configure(tag_t(), value);
+    }
+
+    inline size_t getSize() const
+    {
+        return size_;
+    }
+
+    inline data_t* get(const index_t &index)
+    {
+        slot_t &s = slots_[toSlot(index)];
+        return (s.valid && s.index == index) ? &s.data : nullptr;
+    }
+
+    inline const data_t* get(const index_t &index) const
+    {
+        const slot_t &s = slots_[toSlot(index)];
+        return (s.valid && s.index == index) ? &s.data : nullptr;
+    }
+
+    inline data_t& insert(const index_t &index,
+                          const data_t  &data)
+    {
+        slot_t &s = slots_[toSlot(index)];
+        if (s.valid && s.index == index) {
+            s.data.merge(data);
+            return s.data;
+        }
+
+        if (!s.valid)
+            ++ count_;
+        s.valid = true;
+        s.index = index;
+        s.data  = data;
+        return s.data;
+    }
+
+    inline bool remove(const index_t &index)
+    {
+        slot_t &s = slots_[toSlot(index)];
+        if (!s.valid || s.index != index)
+            return false;
+
+        s.valid = false;
+        s.data  = data_t();
+        -- count_;
+        return true;
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (slot_t &s : slots_)
+            if (s.valid)
+                function(s.index, s.data);
+    }
+
+    template <typename Fn>
+    inline void traverse(const Fn &function) const
+    {
+        for (const slot_t &s : slots_)
+            if (s.valid)
+                function(s.index, s.data);
+    }
+
+    inline std::size_t size() const
+    {
+        return count_;
+    }
+
+    inline std::size_t capacity() const
+    {
+        return slots_.size();
+    }
+
+    inline std::size_t byte_size() const
+    {
+        std::size_t size = sizeof(*this);
+        for (const slot_t &s : slots_)
+            size += sizeof(slot_t) - sizeof(data_t) + s.data.byte_size();
+        return size;
+    }
+
+private:
+    struct EIGEN_ALIGN16 slot_t {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        bool    valid = false;
+        index_t index;
+        data_t  data;
+    };
+
+    size_t                                                  size_;
+    size_t                                                  stride_;
+    std::vector<slot_t, Eigen::aligned_allocator<slot_t>>   slots_;
+    std::size_t                                             count_;
+
+    inline void configure(const cis::option::tags::array_size &,
+                          const size_t &size)
+    {
+        size_ = size;
+        std::size_t capacity = 1ul;
+        for (std::size_t i=0; i<Dim; ++i) {
+            stride_[i] = capacity;
+            capacity  *= size_[i];
+        }
+        slots_.clear();
+        slots_.resize(capacity);
+        count_ = 0ul;
+    }
+
+    inline void configure(const cis::option::tags::array_offset &,
+                          const index_t &)
+    {
+        /// positions are relative to the ring, not to an offset
+    }
+
+    inline std::size_t toSlot(const index_t &index) const
+    {
+        std::size_t slot = 0ul;
+        for (std::size_t i=0; i<Dim; ++i)
+            slot += static_cast<std::size_t>(cslibs_math::common::mod(index[i], static_cast<int>(size_[i]))) * stride_[i];
+        return slot;
+    }
+};
+
+template <typename data_t,
+          typename index_t,
+          template <typename, typename, typename...> class backend_t,
+          typename... options_ts>
+struct storage<data_t, index_t, backend_t, Ring<data_t, index_t, options_ts...>>
+{
+    using type = RingStorage<data_t, index_t>;
+};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_RING_HPP
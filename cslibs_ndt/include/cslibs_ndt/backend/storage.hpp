@@ -0,0 +1,28 @@
+#ifndef CSLIBS_NDT_BACKEND_STORAGE_HPP
+#define CSLIBS_NDT_BACKEND_STORAGE_HPP
+
+#include <cslibs_indexed_storage/storage.hpp>
+
+namespace cis = cslibs_indexed_storage;
+
+namespace cslibs_ndt {
+namespace backend {
+/**
+ * @brief Maps a backend to the storage type used by the maps. Backends of
+ *        cslibs_indexed_storage are wrapped into cis::Storage, backends
+ *        provided by cslibs_ndt specialize this with their own storage. The
+ *        instantiated backend is matched, so backends can also be selected
+ *        through alias templates such as tags::default_types.
+ */
+template <typename data_t,
+          typename index_t,
+          template <typename, typename, typename...> class backend_t,
+          typename backend_instance_t = backend_t<data_t, index_t>>
+struct storage
+{
+    using type = cis::Storage<data_t, index_t, backend_t>;
+};
+}
+}
+
+#endif // CSLIBS_NDT_BACKEND_STORAGE_HPP
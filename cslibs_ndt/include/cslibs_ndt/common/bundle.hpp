@@ -2,6 +2,7 @@
 #define CSLIBS_NDT_COMMON_BUNDLE_HPP
 
 #include <array>
+#include <type_traits>
 
 namespace cslibs_ndt {
 template<typename T, std::size_t Size>
@@ -11,42 +12,11 @@ public:
     using bundle_t = Bundle<T, Size>;
     using data_t   = std::array<T, Size>;
 
-    inline Bundle() :
-        id_(n_ ++)
-    {
-    }
-
-    inline virtual ~Bundle() = default;
-
     inline static std::size_t size()
     {
         return Size;
     }
 
-    inline Bundle(const Bundle &other) :
-        data_(other.data_),
-        id_(n_ ++)
-    {
-    }
-
-   inline  Bundle(Bundle &&other) :
-        data_(std::move(other.data_)),
-        id_(n_ ++)
-    {
-    }
-
-    inline Bundle& operator = (const Bundle &other)
-    {
-        data_ = other.data_;
-        return *this;
-    }
-
-    inline Bundle& operator = (Bundle &&other)
-    {
-        data_ = std::move(other.data_);
-        return *this;
-    }
-
     inline T& operator [] (const std::size_t i)
     {
         return data_[i];
@@ -77,8 +47,15 @@ public:
         return data_;
     }
 
-    inline void merge(const Bundle &)
+    /**
+     * @brief Merge bin by bin. Bins holding pointers, e.g. to the distributions
+     *        of a map, are only filled where they are still empty, as the
+     *        pointed to data is owned and merged elsewhere.
+     */
+    inline void merge(const Bundle &other)
     {
+        for (std::size_t i = 0 ; i < Size ; ++ i)
+            merge(data_[i], other.data_[i], std::is_pointer<T>());
     }
 
     inline std::size_t byte_size() const
@@ -86,11 +63,6 @@ public:
         return sizeof(*this);
     }
 
-    inline const int& id() const
-    {
-        return id_;
-    }
-
     inline typename data_t::const_iterator begin() const
     {
         return data_.begin();
@@ -112,13 +84,19 @@ public:
     }
 
 private:
-    data_t     data_;
-    const int  id_;
-    static int n_;
-};
+    data_t data_;
 
-template<typename T, std::size_t Size>
-int Bundle<T, Size>::n_ = 0;
+    inline static void merge(T &v, const T &other, std::true_type)
+    {
+        if (!v)
+            v = other;
+    }
+
+    inline static void merge(T &v, const T &other, std::false_type)
+    {
+        v.merge(other);
+    }
+};
 }
 
 #endif // CSLIBS_NDT_COMMON_BUNDLE_HPP
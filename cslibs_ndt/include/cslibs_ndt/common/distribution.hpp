@@ -5,6 +5,8 @@
 
 #include <cslibs_math/statistics/distribution.hpp>
 
+#include <cslibs_ndt/common/subtract.hpp>
+
 #include <cslibs_indexed_storage/storage.hpp>
 #include <cslibs_indexed_storage/backend/kdtree/kdtree.hpp>
 
@@ -77,8 +79,27 @@ public:
         return data_;
     }
 
-    inline void merge(const Distribution &)
+    /**
+     * @brief Compute the statistics the distribution caches lazily on const
+     *        access, so that concurrent readers do not write to it.
+     */
+    inline void finalize() const
+    {
+        data_.getCovariance();
+    }
+
+    inline void merge(const Distribution &other)
+    {
+        data_ += other.data_;
+    }
+
+    /**
+     * @brief Undo adding d, the samples of d are subtracted from the
+     *        distribution again.
+     */
+    inline void remove(const distribution_t &d)
     {
+        data_ = subtract(data_, d);
     }
 
     inline std::size_t byte_size() const
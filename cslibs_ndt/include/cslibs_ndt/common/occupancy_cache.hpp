@@ -0,0 +1,77 @@
+#ifndef CSLIBS_NDT_COMMON_OCCUPANCY_CACHE_HPP
+#define CSLIBS_NDT_COMMON_OCCUPANCY_CACHE_HPP
+
+#include <atomic>
+
+namespace cslibs_ndt {
+/**
+ * @brief Single entry cache for the occupancy value of a distribution, keyed
+ *        by the inverse model it was computed with. Several readers may query
+ *        and fill the cache concurrently: entries are guarded by a sequence
+ *        counter, a reader never waits and a filler that loses the race just
+ *        does not cache its value. Invalidation requires exclusive access.
+ */
+template <typename T, typename ivm_t>
+class OccupancyCache
+{
+public:
+    inline OccupancyCache() :
+        sequence_(0u),
+        inverse_model_(nullptr),
+        occupancy_(T())
+    {
+    }
+
+    /// copies start cold, the cached inverse model might not outlive the copy anyway
+    inline OccupancyCache(const OccupancyCache &) :
+        OccupancyCache()
+    {
+    }
+
+    inline OccupancyCache& operator = (const OccupancyCache &)
+    {
+        reset();
+        return *this;
+    }
+
+    inline bool get(const ivm_t *inverse_model,
+                    T &occupancy) const
+    {
+        const unsigned int sequence = sequence_.load(std::memory_order_acquire);
+        if (sequence & 1u)
+            return false;
+
+        const ivm_t *cached = inverse_model_.load(std::memory_order_relaxed);
+        occupancy = occupancy_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return cached == inverse_model &&
+               sequence_.load(std::memory_order_relaxed) == sequence;
+    }
+
+    inline void set(const ivm_t *inverse_model,
+                    const T &occupancy) const
+    {
+        unsigned int sequence = sequence_.load(std::memory_order_relaxed);
+        if ((sequence & 1u) ||
+                !sequence_.compare_exchange_strong(sequence, sequence + 1u, std::memory_order_acquire))
+            return;
+
+        std::atomic_thread_fence(std::memory_order_release);
+        inverse_model_.store(inverse_model, std::memory_order_relaxed);
+        occupancy_.store(occupancy, std::memory_order_relaxed);
+        sequence_.store(sequence + 2u, std::memory_order_release);
+    }
+
+    inline void reset()
+    {
+        inverse_model_.store(nullptr, std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::atomic<unsigned int> sequence_;
+    mutable std::atomic<const ivm_t*> inverse_model_;   // may point to invalid memory!
+    mutable std::atomic<T>            occupancy_;
+};
+}
+
+#endif // CSLIBS_NDT_COMMON_OCCUPANCY_CACHE_HPP
@@ -2,10 +2,14 @@
 #define CSLIBS_NDT_COMMON_OCCUPANCY_DISTRIBUTION_HPP
 
 #include <mutex>
+#include <algorithm>
 
 #include <cslibs_math/statistics/distribution.hpp>
 #include <cslibs_gridmaps/utility/inverse_model.hpp>
 
+#include <cslibs_ndt/common/occupancy_cache.hpp>
+#include <cslibs_ndt/common/subtract.hpp>
+
 #include <cslibs_indexed_storage/storage.hpp>
 
 namespace cslibs_ndt {
@@ -42,31 +46,28 @@ public:
 
     inline OccupancyDistribution(const OccupancyDistribution &other) :
         num_free_(other.num_free_),
-        distribution_(other.distribution_),
-        occupancy_(other.occupancy_),
-        inverse_model_(other.inverse_model_)
+        distribution_(other.distribution_ ? new distribution_t(*other.distribution_) : nullptr)
     {
     }
 
     inline OccupancyDistribution& operator = (const OccupancyDistribution &other)
     {
         num_free_      = other.num_free_;
-        distribution_  = other.distribution_;
-        occupancy_     = other.occupancy_;
-        inverse_model_ = other.inverse_model_;
+        distribution_.reset(other.distribution_ ? new distribution_t(*other.distribution_) : nullptr);
+        cache_.reset();
         return *this;
     }
 
     inline void updateFree()
     {
         ++ num_free_;
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline void updateFree(const std::size_t &num_free)
     {
         num_free_ += num_free;
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline void updateOccupied(const point_t & p)
@@ -75,7 +76,7 @@ public:
             distribution_.reset(new distribution_t());
 
         distribution_->add(p);
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline void updateOccupied(const distribution_ptr_t &d)
@@ -87,7 +88,30 @@ public:
             distribution_.reset(new distribution_t());
 
         *distribution_ += *d;
-        inverse_model_ = nullptr;
+        cache_.reset();
+    }
+
+    /**
+     * @brief Undo updateFree(num_free).
+     */
+    inline void removeFree(const std::size_t &num_free)
+    {
+        num_free_ -= std::min(num_free, num_free_);
+        cache_.reset();
+    }
+
+    /**
+     * @brief Undo updateOccupied(d), the samples of d are subtracted from
+     *        the distribution again.
+     */
+    inline void removeOccupied(const distribution_ptr_t &d)
+    {
+        if (!d || !distribution_)
+            return;
+
+        const distribution_t rest = subtract(*distribution_, *d);
+        distribution_.reset(rest.getN() > 0 ? new distribution_t(rest) : nullptr);
+        cache_.reset();
     }
 
     inline std::size_t numFree() const
@@ -110,19 +134,20 @@ public:
 
     inline T getOccupancy(const ivm_t &inverse_model) const
     {
-        if (&inverse_model == inverse_model_)
-            return occupancy_;
+        T occupancy;
+        if (cache_.get(&inverse_model, occupancy))
+            return occupancy;
 
-        inverse_model_ = &inverse_model;
-        occupancy_ = distribution_ ?
+        occupancy = distribution_ ?
                     cslibs_math::common::LogOdds<T>::from(
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsFree() +
-                        distribution_->getN() * inverse_model_->getLogOddsOccupied() -
-                        static_cast<T>(num_free_ + distribution_->getN()) * inverse_model_->getLogOddsPrior()) :
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsFree() +
+                        distribution_->getN() * inverse_model.getLogOddsOccupied() -
+                        static_cast<T>(num_free_ + distribution_->getN()) * inverse_model.getLogOddsPrior()) :
                     cslibs_math::common::LogOdds<T>::from(
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsFree() -
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsPrior());
-        return occupancy_;
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsFree() -
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsPrior());
+        cache_.set(&inverse_model, occupancy);
+        return occupancy;
     }
 
     inline const distribution_ptr_t &getDistribution() const
@@ -135,8 +160,26 @@ public:
         return distribution_;
     }
 
-    inline void merge(const OccupancyDistribution&)
+    /**
+     * @brief Compute the statistics the occupied distribution caches lazily on const
+     *        access, so that concurrent readers do not write to it.
+     */
+    inline void finalize() const
+    {
+        if (distribution_)
+            distribution_->getCovariance();
+    }
+
+    inline void merge(const OccupancyDistribution &other)
     {
+        num_free_ += other.num_free_;
+        if (other.distribution_) {
+            if (distribution_)
+                *distribution_ += *other.distribution_;
+            else
+                distribution_.reset(new distribution_t(*other.distribution_));
+        }
+        cache_.reset();
     }
 
     inline std::size_t byte_size() const
@@ -148,8 +191,7 @@ private:
     std::size_t        num_free_;
     distribution_ptr_t distribution_;
 
-    mutable T            occupancy_     = 0;
-    mutable const ivm_t* inverse_model_ = nullptr; // may point to invalid memory!
+    OccupancyCache<T,ivm_t> cache_;
 };
 }
 
@@ -0,0 +1,87 @@
+#ifndef CSLIBS_NDT_COMMON_RAY_TABLE_HPP
+#define CSLIBS_NDT_COMMON_RAY_TABLE_HPP
+
+#include <cslibs_ndt/map/traits.hpp>
+
+#include <cmath>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace cslibs_ndt {
+/**
+ * @brief Unit beam directions of a sensor in its own frame, computed once and
+ *        reused for every scan, so that inserting ranges needs no trigonometry.
+ *        Beam k belongs to range k of a scan, for organized range images the
+ *        beams are stored row by row. Only the end points profit from the
+ *        order, free space is carved per ray as for a pointcloud.
+ */
+template <typename T, std::size_t Dim>
+class RayTable
+{
+public:
+    using Ptr           = std::shared_ptr<RayTable<T,Dim>>;
+    using ConstPtr      = std::shared_ptr<const RayTable<T,Dim>>;
+    using point_t       = typename map::traits<Dim,T>::point_t;
+    using point_list_t  = std::vector<point_t, Eigen::aligned_allocator<point_t>>;
+
+    /**
+     * @brief Arbitrary beam directions, normalized on construction.
+     */
+    inline explicit RayTable(const point_list_t &directions)
+    {
+        directions_.reserve(directions.size());
+        for (const point_t &d : directions)
+            directions_.emplace_back(d * (static_cast<T>(1) / d.length()));
+    }
+
+    /**
+     * @brief Planar laser scanner, beam k has angle angle_min + k * angle_increment.
+     */
+    template <std::size_t D = Dim,
+              typename = typename std::enable_if<D == 2>::type>
+    inline RayTable(const T angle_min,
+                    const T angle_increment,
+                    const std::size_t size)
+    {
+        directions_.reserve(size);
+        for (std::size_t k=0; k<size; ++k) {
+            const T angle = angle_min + static_cast<T>(k) * angle_increment;
+            directions_.emplace_back(std::cos(angle), std::sin(angle));
+        }
+    }
+
+    /**
+     * @brief Organized range image of a spinning 3D scanner, row r and column
+     *        c look along elevations[r] and azimuths[c].
+     */
+    template <std::size_t D = Dim,
+              typename = typename std::enable_if<D == 3>::type>
+    inline RayTable(const std::vector<T> &elevations,
+                    const std::vector<T> &azimuths)
+    {
+        directions_.reserve(elevations.size() * azimuths.size());
+        for (const T e : elevations) {
+            const T ce = std::cos(e);
+            const T se = std::sin(e);
+            for (const T a : azimuths)
+                directions_.emplace_back(ce * std::cos(a), ce * std::sin(a), se);
+        }
+    }
+
+    inline std::size_t size() const
+    {
+        return directions_.size();
+    }
+
+    inline const point_t& operator [] (const std::size_t k) const
+    {
+        return directions_[k];
+    }
+
+private:
+    point_list_t    directions_;
+};
+}
+
+#endif // CSLIBS_NDT_COMMON_RAY_TABLE_HPP
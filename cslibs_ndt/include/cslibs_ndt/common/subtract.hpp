@@ -0,0 +1,30 @@
+#ifndef CSLIBS_NDT_COMMON_SUBTRACT_HPP
+#define CSLIBS_NDT_COMMON_SUBTRACT_HPP
+
+#include <cslibs_math/statistics/distribution.hpp>
+
+namespace cslibs_ndt {
+/**
+ * @brief Undo merging d into from, the result holds the samples of from
+ *        without those of d. It is empty if d has at least as many samples.
+ */
+template <typename T, std::size_t Dim, std::size_t lambda>
+inline cslibs_math::statistics::Distribution<T,Dim,lambda> subtract(const cslibs_math::statistics::Distribution<T,Dim,lambda> &from,
+                                                                    const cslibs_math::statistics::Distribution<T,Dim,lambda> &d)
+{
+    using distribution_t = cslibs_math::statistics::Distribution<T,Dim,lambda>;
+
+    const std::size_t n = from.getN();
+    if (d.getN() >= n)
+        return distribution_t();
+
+    const T w   = static_cast<T>(n);
+    const T w_d = static_cast<T>(d.getN());
+    const T inv = static_cast<T>(1) / (w - w_d);
+    return distribution_t(n - d.getN(),
+                          typename distribution_t::sample_t((from.getMean() * w - d.getMean() * w_d) * inv),
+                          typename distribution_t::covariance_t((from.getCorrelated() * w - d.getCorrelated() * w_d) * inv));
+}
+}
+
+#endif // CSLIBS_NDT_COMMON_SUBTRACT_HPP
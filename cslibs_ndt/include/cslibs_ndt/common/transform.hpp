@@ -0,0 +1,31 @@
+#ifndef CSLIBS_NDT_COMMON_TRANSFORM_HPP
+#define CSLIBS_NDT_COMMON_TRANSFORM_HPP
+
+#include <cslibs_math/statistics/distribution.hpp>
+
+namespace cslibs_ndt {
+/**
+ * @brief Move all samples of a distribution by x -> R * x + t. Mean and
+ *        correlation are transformed exactly, so the result is the same as
+ *        adding the transformed samples.
+ */
+template <typename T, std::size_t Dim, std::size_t lambda>
+inline cslibs_math::statistics::Distribution<T,Dim,lambda> transform(const cslibs_math::statistics::Distribution<T,Dim,lambda> &d,
+                                                                     const typename cslibs_math::statistics::Distribution<T,Dim,lambda>::covariance_t &R,
+                                                                     const typename cslibs_math::statistics::Distribution<T,Dim,lambda>::sample_t     &t)
+{
+    using distribution_t = cslibs_math::statistics::Distribution<T,Dim,lambda>;
+    using sample_t       = typename distribution_t::sample_t;
+    using covariance_t   = typename distribution_t::covariance_t;
+
+    if (d.getN() == 0)
+        return d;
+
+    const sample_t rotated = R * d.getMean();
+    const covariance_t corr = R * d.getCorrelated() * R.transpose() +
+                              rotated * t.transpose() + t * rotated.transpose() + t * t.transpose();
+    return distribution_t(d.getN(), sample_t(rotated + t), corr);
+}
+}
+
+#endif // CSLIBS_NDT_COMMON_TRANSFORM_HPP
@@ -4,8 +4,11 @@
 #include <mutex>
 
 #include <cslibs_math/statistics/weighted_distribution.hpp>
+#include <cslibs_math/utility/traits.hpp>
 #include <cslibs_gridmaps/utility/inverse_model.hpp>
 
+#include <cslibs_ndt/common/occupancy_cache.hpp>
+
 #include <cslibs_indexed_storage/storage.hpp>
 
 namespace cslibs_ndt {
@@ -48,9 +51,7 @@ public:
     inline WeightedOccupancyDistribution(const WeightedOccupancyDistribution &other) :
         num_free_(other.num_free_),
         weight_free_(other.weight_free_),
-        distribution_(other.distribution_),
-        occupancy_(other.occupancy_),
-        inverse_model_(other.inverse_model_)
+        distribution_(other.distribution_ ? new distribution_t(*other.distribution_) : nullptr)
     {
     }
 
@@ -58,9 +59,8 @@ public:
     {
         num_free_      = other.num_free_;
         weight_free_   = other.weight_free_;
-        distribution_  = other.distribution_;
-        occupancy_     = other.occupancy_;
-        inverse_model_ = other.inverse_model_;
+        distribution_.reset(other.distribution_ ? new distribution_t(*other.distribution_) : nullptr);
+        cache_.reset();
         return *this;
     }
 
@@ -68,7 +68,7 @@ public:
     {
         num_free_     += num_free;
         weight_free_  += weight_free;
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline void updateOccupied(const point_t& p, const T& w = cslibs_math::utility::traits<T>::One)
@@ -77,7 +77,7 @@ public:
             distribution_.reset(new distribution_t());
 
         distribution_->add(p, w);
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline void updateOccupied(const distribution_ptr_t &d)
@@ -89,7 +89,7 @@ public:
             distribution_.reset(new distribution_t());
 
         *distribution_ += *d;
-        inverse_model_ = nullptr;
+        cache_.reset();
     }
 
     inline T weightFree() const
@@ -117,19 +117,20 @@ public:
 
     inline T getOccupancy(const ivm_t &inverse_model) const
     {
-        if (&inverse_model == inverse_model_)
-            return occupancy_;
+        T occupancy;
+        if (cache_.get(&inverse_model, occupancy))
+            return occupancy;
 
-        inverse_model_ = &inverse_model;
-        occupancy_ = distribution_ ?
+        occupancy = distribution_ ?
                     cslibs_math::common::LogOdds<T>::from(
-                        weight_free_ * inverse_model_->getLogOddsFree() +
-                        distribution_->getWeight() * inverse_model_->getLogOddsOccupied() -
-                        static_cast<T>(num_free_ + distribution_->getSampleCount()) * inverse_model_->getLogOddsPrior()) :
+                        weight_free_ * inverse_model.getLogOddsFree() +
+                        distribution_->getWeight() * inverse_model.getLogOddsOccupied() -
+                        static_cast<T>(num_free_ + distribution_->getSampleCount()) * inverse_model.getLogOddsPrior()) :
                     cslibs_math::common::LogOdds<T>::from(
-                        weight_free_ * inverse_model_->getLogOddsFree() -
-                        static_cast<T>(num_free_) * inverse_model_->getLogOddsPrior());
-        return occupancy_;
+                        weight_free_ * inverse_model.getLogOddsFree() -
+                        static_cast<T>(num_free_) * inverse_model.getLogOddsPrior());
+        cache_.set(&inverse_model, occupancy);
+        return occupancy;
     }
 
     inline const distribution_ptr_t &getDistribution() const
@@ -142,8 +143,27 @@ public:
         return distribution_;
     }
 
-    inline void merge(const WeightedOccupancyDistribution&)
+    /**
+     * @brief Compute the statistics the occupied distribution caches lazily on const
+     *        access, so that concurrent readers do not write to it.
+     */
+    inline void finalize() const
+    {
+        if (distribution_)
+            distribution_->getCovariance();
+    }
+
+    inline void merge(const WeightedOccupancyDistribution &other)
     {
+        num_free_    += other.num_free_;
+        weight_free_ += other.weight_free_;
+        if (other.distribution_) {
+            if (distribution_)
+                *distribution_ += *other.distribution_;
+            else
+                distribution_.reset(new distribution_t(*other.distribution_));
+        }
+        cache_.reset();
     }
 
     inline std::size_t byte_size() const
@@ -156,8 +176,7 @@ private:
     T                  weight_free_;
     distribution_ptr_t distribution_;
 
-    mutable T            occupancy_     = 0;
-    mutable const ivm_t* inverse_model_ = nullptr; // may point to invalid memory!
+    OccupancyCache<T,ivm_t> cache_;
 };
 }
 
@@ -3,12 +3,22 @@
 
 #include <array>
 #include <vector>
+#include <cassert>
 #include <cmath>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
 
 #include <cslibs_ndt/map/traits.hpp>
 #include <cslibs_ndt/common/bundle.hpp>
+#include <cslibs_ndt/common/ray_table.hpp>
 #include <cslibs_ndt/utility/utility.hpp>
+#include <cslibs_ndt/backend/storage.hpp>
+#include <cslibs_ndt/map/memory_budget.hpp>
 
 #include <cslibs_math/common/array.hpp>
 #include <cslibs_math/utility/traits.hpp>
@@ -41,20 +51,23 @@ public:
     using point_t       = typename traits<Dim,T>::point_t;
     using pointcloud_t  = typename traits<Dim,T>::pointcloud_t;
     using index_t       = std::array<int,Dim>;
+    using point_list_t  = std::vector<point_t, Eigen::aligned_allocator<point_t>>;
+    using ray_table_t   = RayTable<T,Dim>;
 
     static constexpr std::size_t bin_count  = utility::two_pow(Dim);
     static constexpr T div_count = cslibs_math::utility::traits<T>::One / static_cast<T>(bin_count);
 
     using index_list_t                      = std::array<index_t, bin_count>;
     using distribution_t                    = data_t<T,Dim>;
-    using distribution_storage_t            = cis::Storage<distribution_t, index_t, backend_t>;
+    using distribution_storage_t            = typename backend::storage<distribution_t, index_t, backend_t>::type;
     using distribution_storage_ptr_t        = std::shared_ptr<distribution_storage_t>;
     using distribution_storage_array_t      = std::array<distribution_storage_ptr_t, bin_count>;
     using distribution_bundle_t             = cslibs_ndt::Bundle<distribution_t*, bin_count>;
     using distribution_const_bundle_t       = cslibs_ndt::Bundle<const distribution_t*, bin_count>;
-    using distribution_bundle_storage_t     = cis::Storage<distribution_bundle_t, index_t, backend_t>;
+    using distribution_bundle_storage_t     = typename backend::storage<distribution_bundle_t, index_t, backend_t>::type;
     using distribution_bundle_storage_ptr_t = std::shared_ptr<distribution_bundle_storage_t>;
     using dynamic_distribution_storage_t    = cis::Storage<distribution_t, index_t, dynamic_backend_t>;
+    using dynamic_bundle_storage_t          = cis::Storage<distribution_bundle_t, index_t, dynamic_backend_t>;
 
     using neighborhood_t = cis::operations::clustering::GridNeighborhoodStatic<std::tuple_size<index_t>::value, 3>;
 
@@ -104,21 +117,70 @@ public:
         min_bundle_index_(other.min_bundle_index_),
         max_bundle_index_(other.max_bundle_index_),
         storage_(utility::create<distribution_storage_t,bin_count>(other.storage_)),
-        bundle_storage_(new distribution_bundle_storage_t(*other.bundle_storage_))
+        bundle_storage_(new distribution_bundle_storage_t(*other.bundle_storage_)),
+        dirty_(other.dirty_),
+        unfinalized_(other.unfinalized_)
     {
+        /// copied bundles still point into the storages of other
+        rebind(storage_, *bundle_storage_);
+
+        /// pending copy-on-write changes end up in the copy
+        for (const overlay_ptr_t &overlay : other.overlays_)
+            fold(*overlay, base_storage_accessor_t{storage_, *bundle_storage_});
+
+        /// so do tiles evicted to disk, the copy has no memory budget
+        if (other.budget_)
+            other.budget_->restore(*this);
     }
 
+    /**
+     * @brief Move constructor, takes over the storages of other in O(1).
+     *        Other is left without storages and must not be used anymore.
+     */
     inline AbstractMap(AbstractMap &&other) :
         resolution_(other.resolution_),
         bundle_resolution_(other.bundle_resolution_),
         bundle_resolution_inv_(other.bundle_resolution_inv_),
-        w_T_m_(std::move(other.w_T_m_)),
-        m_T_w_(std::move(other.m_T_w_)),
+        w_T_m_(other.w_T_m_),
+        m_T_w_(other.m_T_w_),
+        min_bundle_index_(other.min_bundle_index_),
+        max_bundle_index_(other.max_bundle_index_),
+        storage_(std::move(other.storage_)),
+        bundle_storage_(std::move(other.bundle_storage_)),
+        overlays_(std::move(other.overlays_)),
+        budget_(std::move(other.budget_)),
+        dirty_(std::move(other.dirty_)),
+        unfinalized_(std::move(other.unfinalized_))
+    {
+    }
+
+    /**
+     * @brief Snapshot constructor, shares all storages with other. Shared
+     *        storages are not modified anymore, both maps write to private
+     *        overlays instead, so the cost of a snapshot is proportional to the
+     *        bundles changed afterwards. Tiles other has evicted to disk are
+     *        loaded into a private copy of the storages.
+     */
+    inline AbstractMap(const AbstractMap &other,
+                       const tags::snapshot &) :
+        resolution_(other.resolution_),
+        bundle_resolution_(other.bundle_resolution_),
+        bundle_resolution_inv_(other.bundle_resolution_inv_),
+        w_T_m_(other.w_T_m_),
+        m_T_w_(other.m_T_w_),
         min_bundle_index_(other.min_bundle_index_),
         max_bundle_index_(other.max_bundle_index_),
         storage_(other.storage_),
-        bundle_storage_(other.bundle_storage_)
+        bundle_storage_(other.bundle_storage_),
+        overlays_(other.overlays_),
+        dirty_(other.dirty_),
+        unfinalized_(other.unfinalized_)
     {
+        /// tiles evicted to disk are only owned by other
+        if (other.hasEvictedTiles()) {
+            detach();
+            other.budget_->restore(*this);
+        }
     }
 
     /**
@@ -201,50 +263,385 @@ public:
     inline const distribution_bundle_t* get(const point_t &p) const;
     inline const distribution_bundle_t* get(const index_t &bi) const;
 
-    inline distribution_storage_array_t const & getStorages() const
+    /**
+     * @brief Get the distribution storages. Pending copy-on-write changes are
+     *        merged into a copy of the storages, otherwise they are shared.
+     *        Throws if a memory budget evicted tiles, use traverseDistributions
+     *        or restoreEvictedTiles then.
+     * @return the storages
+     */
+    inline distribution_storage_array_t getStorages() const
+    {
+        if (hasEvictedTiles())
+            throw std::runtime_error("[AbstractMap]: Can not get the storages, tiles are evicted.");
+
+        if (overlays_.empty())
+            return storage_;
+
+        distribution_storage_array_t storage = utility::create<distribution_storage_t,bin_count>(storage_);
+        for (const overlay_ptr_t &overlay : overlays_) {
+            for (std::size_t i=0; i<bin_count; ++i) {
+                for (const index_t &index : overlay->removed[i])
+                    removeIndex(*storage[i], index, option_tag_t());
+                fold(overlay->storage[i], overlay->removed[i], *storage[i], [](const index_t &) {});
+            }
+        }
+        return storage;
+    }
+
+    /**
+     * @brief Compute the bundle indices of a range of points in world
+     *        coordinates, the batch version of toBundleIndex. The loop has no
+     *        calls and no branches, rounding uses truncating conversions, so
+     *        the compiler can vectorize it. Points have to be finite.
+     * @param begin     the first point
+     * @param end       the end of the range
+     * @param indices   the bundle indices, one per point
+     */
+    template <typename iterator_t>
+    inline void toBundleIndices(const iterator_t &begin,
+                                const iterator_t &end,
+                                std::vector<index_t> &indices) const
+    {
+        indices.resize(static_cast<std::size_t>(std::distance(begin, end)));
+
+        const T inv = bundle_resolution_inv_;
+        index_t *index = indices.data();
+        for (iterator_t it = begin; it != end; ++it, ++index) {
+            const point_t p_m = m_T_w_ * *it;
+            for (std::size_t i=0; i<Dim; ++i)
+                (*index)[i] = floorToInt(p_m(i) * inv);
+        }
+    }
+
+    /**
+     * @brief Compute the bundle indices of n points stored in a buffer, e.g.
+     *        the data of a sensor message. Point k starts at data + k * stride.
+     * @param data      the first coordinate of the first point
+     * @param n         the number of points
+     * @param stride    the distance between points, in elements of scalar_t
+     * @param indices   the bundle indices, one per point
+     */
+    template <typename scalar_t>
+    inline void toBundleIndices(const scalar_t *data,
+                                const std::size_t n,
+                                const std::size_t stride,
+                                std::vector<index_t> &indices) const
     {
-        return storage_;
+        indices.resize(n);
+
+        const T inv = bundle_resolution_inv_;
+        point_t p_w;
+        for (std::size_t k=0; k<n; ++k, data += stride) {
+            for (std::size_t i=0; i<Dim; ++i)
+                p_w(i) = static_cast<T>(data[i]);
+            const point_t p_m = m_T_w_ * p_w;
+            for (std::size_t i=0; i<Dim; ++i)
+                indices[k][i] = floorToInt(p_m(i) * inv);
+        }
     }
 
+    /**
+     * @brief Transform a pointcloud taken at points_origin into world
+     *        coordinates and compute the bundle indices of all finite points.
+     * @param points        the pointcloud
+     * @param points_origin the pose the pointcloud was taken at
+     * @param points_w      the finite points in world coordinates
+     * @param indices       their bundle indices
+     */
+    inline void toBundleIndices(const pointcloud_t &points,
+                                const pose_t &points_origin,
+                                point_list_t &points_w,
+                                std::vector<index_t> &indices) const
+    {
+        points_w.clear();
+        points_w.reserve(points.size());
+        for (const auto &p : points) {
+            const point_t pm = points_origin * p;
+            if (pm.isNormal())
+                points_w.emplace_back(pm);
+        }
+        toBundleIndices(points_w.begin(), points_w.end(), indices);
+    }
+
+    /**
+     * @brief Compute the end points in world coordinates and the bundle indices
+     *        of a range scan taken at points_origin, without building a
+     *        pointcloud first. Non-finite ranges and ranges outside of
+     *        [range_min, range_max] are skipped.
+     * @param rays          beam directions of the sensor
+     * @param ranges        one range per beam of rays
+     * @param points_origin the pose the scan was taken at
+     * @param range_min     minimum valid range
+     * @param range_max     maximum valid range
+     * @param points_w      the valid end points in world coordinates
+     * @param indices       their bundle indices
+     */
+    template <typename scalar_t>
+    inline void toBundleIndices(const ray_table_t &rays,
+                                const scalar_t *ranges,
+                                const pose_t &points_origin,
+                                const T range_min,
+                                const T range_max,
+                                point_list_t &points_w,
+                                std::vector<index_t> &indices) const
+    {
+        points_w.clear();
+        points_w.reserve(rays.size());
+        for (std::size_t k=0; k<rays.size(); ++k) {
+            const T r = static_cast<T>(ranges[k]);
+            if (std::isfinite(r) && r >= range_min && r <= range_max)
+                points_w.emplace_back(points_origin * (rays[k] * r));
+        }
+        toBundleIndices(points_w.begin(), points_w.end(), indices);
+    }
+
+    /**
+     * @brief Visit all bundles. Bundles of tiles evicted by a memory budget are
+     *        read from the tile store one tile at a time, they refer to
+     *        temporary copies of their distributions which are only valid
+     *        during the call. function must not access other bundles then.
+     */
     template <typename Fn>
     inline void traverse(const Fn& function) const
     {
-        return bundle_storage_->traverse(function);
+        traverseResident(function);
+        traverseEvicted(function, [](const index_t &) { return true; });
     }
 
-    inline void getBundleIndices(std::vector<index_t> &indices) const
+    /**
+     * @brief Visit all distributions of bin i, in memory and evicted, e.g. to
+     *        write them without loading evicted tiles. Evicted distributions
+     *        are read into temporaries which are only valid during the call.
+     */
+    template <typename Fn>
+    inline void traverseDistributions(const std::size_t i,
+                                      const Fn &function) const
     {
-        auto add_index = [&indices](const index_t &i, const distribution_bundle_t &) {
-            indices.emplace_back(i);
+        auto shadowed = [this, i](const index_t &index, const std::size_t layer) {
+            for (std::size_t l=layer; l<overlays_.size(); ++l)
+                if (overlays_[l]->storage[i].get(index) || overlays_[l]->removed[i].count(index) > 0)
+                    return true;
+            return false;
         };
-        bundle_storage_->traverse(add_index);
+        for (std::size_t l=overlays_.size(); l>0; --l) {
+            const index_set_t &removed = overlays_[l-1]->removed[i];
+            overlays_[l-1]->storage[i].traverse([&function, &shadowed, &removed, &l](const index_t &index, const distribution_t &d) {
+                if (removed.count(index) == 0 && !shadowed(index, l))
+                    function(index, d);
+            });
+        }
+        storage_[i]->traverse([&function, &shadowed](const index_t &index, const distribution_t &d) {
+            if (!shadowed(index, 0ul))
+                function(index, d);
+        });
+
+        if (hasEvictedTiles())
+            budget_->traverseEvictedDistributions(*this, i, function);
+    }
+    /**
+     * @brief Visit all bundles in Z-order (Morton order) of their indices, so
+     *        consecutive bundles are spatial neighbours whatever the backend.
+     *        Costs sorting the bundles on top of traverse. Throws if a memory
+     *        budget evicted tiles, their bundles can not be sorted in.
+     */
+    template <typename Fn>
+    inline void traverseMorton(const Fn& function) const
+    {
+        if (hasEvictedTiles())
+            throw std::runtime_error("[AbstractMap]: Can not traverse in Morton order, tiles are evicted.");
+
+        std::vector<morton_entry_t> entries;
+        getMortonEntries(entries);
+        for (const morton_entry_t &e : entries)
+            function(e.bi, *e.bundle);
     }
 
-    inline virtual bool validate(const pose_2d_t &p_w_2d) const
+    /**
+     * @brief Visit all bundles, concurrently with parallelTraverse if a pool
+     *        is given, serially otherwise.
+     */
+    template <typename Fn>
+    inline void traverse(const Fn& function,
+                         utility::ThreadPool *pool) const
     {
-        const point_t p_w = toPoint(p_w_2d.translation());
-        return valid(toBundleIndex(p_w));
+        if (pool)
+            parallelTraverse(function, *pool);
+        else
+            traverse(function);
     }
 
-    inline void allocatePartiallyAllocatedBundles()
+    /**
+     * @brief Visit all bundles concurrently on a thread pool. The bundles are
+     *        split into chunks of consecutive bundles in Morton order, so each
+     *        task works on a compact region of the map. The map must not be
+     *        changed while traversing and as neighbouring bundles share their
+     *        distributions, function may only read them. Use
+     *        utility::ThreadLocal for reductions. Evicted tiles are streamed
+     *        afterwards, one task per tile, see traverse.
+     * @param function  called with the bundle index and the bundle
+     * @param pool      thread pool to run on
+     * @param chunks_per_thread number of tasks per thread, for load balancing
+     */
+    template <typename Fn>
+    inline void parallelTraverse(const Fn& function,
+                                 utility::ThreadPool &pool,
+                                 const std::size_t chunks_per_thread = 4ul) const
     {
-        std::vector<index_t> bis;
-        getBundleIndices(bis);
+        std::vector<morton_entry_t> entries;
+        getMortonEntries(entries);
 
-        static constexpr neighborhood_t grid{};
+        const std::size_t chunks = std::min(entries.size(), pool.size() * std::max<std::size_t>(chunks_per_thread, 1ul));
+        pool.run(chunks, [&entries, &function, chunks](const std::size_t chunk) {
+            const std::size_t begin = chunk       * entries.size() / chunks;
+            const std::size_t end   = (chunk + 1) * entries.size() / chunks;
+            for (std::size_t i=begin; i<end; ++i)
+                function(entries[i].bi, *entries[i].bundle);
+        });
 
-        for (const index_t &bi : bis) {
-            const distribution_bundle_t *bundle = bundle_storage_->get(bi);
-            bool do_expand = expandBundle(bundle);
-            if (do_expand) {
-                grid.visit([this, &bi](typename neighborhood_t::offset_t o) {
-                    index_t ii;
-                    for (std::size_t i=0; i<Dim; ++i)
-                        ii[i] = bi[i] + o[i];
-                    getAllocate(ii);
-                });
+        if (!hasEvictedTiles())
+            return;
+
+        const std::vector<index_t> tiles = budget_->getEvictedTiles();
+        pool.run(tiles.size(), [this, &tiles, &function](const std::size_t t) {
+            budget_->traverseTile(*this, tiles[t], function);
+        });
+    }
+
+    /**
+     * @brief Visit all bundles with their center inside an axis aligned box
+     *        given in world coordinates. Like traverse, evicted tiles
+     *        overlapping the box are streamed from the tile store.
+     * @param min       the minimum corner of the box
+     * @param max       the maximum corner of the box
+     * @param function  called with the bundle index and the bundle
+     */
+    template <typename Fn>
+    inline void traverseRange(const point_t &min,
+                              const point_t &max,
+                              const Fn &function) const
+    {
+        std::array<point_t, bin_count> corners;
+        for (std::size_t c=0; c<bin_count; ++c)
+            for (std::size_t i=0; i<Dim; ++i)
+                corners[c](i) = ((c >> i) & 1ul) ? max(i) : min(i);
+
+        traverseRegion(corners, [&min, &max](const point_t &p) {
+            for (std::size_t i=0; i<Dim; ++i)
+                if (p(i) < min(i) || p(i) > max(i))
+                    return false;
+            return true;
+        }, function);
+    }
+
+    /**
+     * @brief Visit all bundles with their center within radius of a point
+     *        given in world coordinates.
+     */
+    template <typename Fn>
+    inline void traverseRadius(const point_t &center,
+                               const T radius,
+                               const Fn &function) const
+    {
+        std::array<point_t, bin_count> corners;
+        for (std::size_t c=0; c<bin_count; ++c)
+            for (std::size_t i=0; i<Dim; ++i)
+                corners[c](i) = center(i) + (((c >> i) & 1ul) ? radius : -radius);
+
+        const T radius_sq = radius * radius;
+        traverseRegion(corners, [&center, radius_sq](const point_t &p) {
+            T d = T();
+            for (std::size_t i=0; i<Dim; ++i)
+                d += (p(i) - center(i)) * (p(i) - center(i));
+            return d <= radius_sq;
+        }, function);
+    }
+
+    /**
+     * @brief Visit all bundles with their center inside a view frustum. The
+     *        view looks along the x axis of view, fov holds the full opening
+     *        angles around the other axes, e.g. horizontal and vertical in 3D.
+     * @param view      the pose of the viewer in world coordinates
+     * @param fov       the opening angles in radians, each less than pi
+     * @param near      the minimum distance along the view axis
+     * @param far       the maximum distance along the view axis
+     * @param function  called with the bundle index and the bundle
+     */
+    template <typename Fn>
+    inline void traverseFrustum(const pose_t &view,
+                                const std::array<T, Dim - 1> &fov,
+                                const T near,
+                                const T far,
+                                const Fn &function) const
+    {
+        std::array<T, Dim - 1> tangents;
+        for (std::size_t j=0; j<Dim-1; ++j)
+            tangents[j] = std::tan(cslibs_math::utility::traits<T>::Half * fov[j]);
+
+        const transform_t w_T_v(view);
+        const transform_t v_T_w = w_T_v.inverse();
+
+        /// the frustum is the convex hull of its near and far face
+        std::array<point_t, bin_count> corners;
+        for (std::size_t c=0; c<bin_count; ++c) {
+            point_t p_v;
+            p_v(0) = (c & 1ul) ? far : near;
+            for (std::size_t j=1; j<Dim; ++j)
+                p_v(j) = (((c >> j) & 1ul) ? p_v(0) : -p_v(0)) * tangents[j-1];
+            corners[c] = w_T_v * p_v;
+        }
+
+        traverseRegion(corners, [&v_T_w, &tangents, near, far](const point_t &p) {
+            const point_t p_v = v_T_w * p;
+            if (p_v(0) < near || p_v(0) > far)
+                return false;
+            for (std::size_t j=1; j<Dim; ++j)
+                if (std::abs(p_v(j)) > p_v(0) * tangents[j-1])
+                    return false;
+            return true;
+        }, function);
+    }
+
+    /**
+     * @brief Compute the lazily cached statistics of all distributions written
+     *        since the last call, the first call visits the whole map. Reading
+     *        a finalized map does not write to it, so that it can be shared
+     *        by several threads, e.g. for conversions or by published versions.
+     */
+    inline void finalize() const
+    {
+        auto finalize_bundle = [](const index_t &, const distribution_bundle_t &b) {
+            for (std::size_t i=0; i<bin_count; ++i)
+                if (b.at(i))
+                    b.at(i)->finalize();
+        };
+
+        /// evicted tiles are finalized again once they are loaded
+        if (unfinalized_.all) {
+            traverseResident(finalize_bundle);
+        } else {
+            for (const index_t &bi : unfinalized_.bundles) {
+                const distribution_bundle_t *b = findBundle(bi);
+                if (b)
+                    finalize_bundle(bi, *b);
             }
         }
+
+        unfinalized_.clear();
+    }
+
+    inline void getBundleIndices(std::vector<index_t> &indices) const
+    {
+        auto add_index = [&indices](const index_t &i, const distribution_bundle_t &) {
+            indices.emplace_back(i);
+        };
+        traverse(add_index);
+    }
+
+    inline bool validate(const pose_2d_t &p_w_2d) const
+    {
+        const point_t p_w = toPoint(p_w_2d.translation());
+        return valid(toBundleIndex(p_w));
     }
 
     inline std::size_t getByteSize() const
@@ -252,6 +649,14 @@ public:
         std::size_t size = sizeof(*this) + bundle_storage_->byte_size();
         for (auto &storage : storage_)
             size += storage->byte_size();
+        for (const overlay_ptr_t &overlay : overlays_) {
+            size += sizeof(overlay_t) + overlay->bundles.byte_size() +
+                    overlay->removed_bundles.size() * sizeof(index_t);
+            for (auto &storage : overlay->storage)
+                size += storage.byte_size();
+            for (auto &removed : overlay->removed)
+                size += removed.size() * sizeof(index_t);
+        }
         return size;
     }
 
@@ -264,8 +669,50 @@ protected:
 
     mutable index_t                            min_bundle_index_;
     mutable index_t                            max_bundle_index_;
+    using index_set_t = std::unordered_set<index_t, utility::bundle_hash<Dim>>;
+    /// copy-on-write layer on top of shared storages, removed indices hide the
+    /// layers below and the entries of this layer until they are written again
+    struct overlay_t {
+        std::array<dynamic_distribution_storage_t, bin_count> storage;
+        dynamic_bundle_storage_t                                bundles;
+        std::array<index_set_t, bin_count>                      removed;
+        index_set_t                                             removed_bundles;
+    };
+    using overlay_ptr_t = std::shared_ptr<overlay_t>;
+
     mutable distribution_storage_array_t       storage_;
     mutable distribution_bundle_storage_ptr_t  bundle_storage_;
+    mutable std::vector<overlay_ptr_t>         overlays_;
+
+    friend class MemoryBudget<AbstractMap>;
+    using budget_t = MemoryBudget<AbstractMap>;
+    /// memory budget, least recently used tiles are evicted to a tile store
+    std::unique_ptr<budget_t>                  budget_;
+
+    /// written bundles, hashed so that marking a write stays cheap
+    struct dirty_t {
+        bool                                                    all = true;
+        std::unordered_set<index_t, utility::bundle_hash<Dim>>  bundles;
+        index_t                                                 last;
+
+        inline void mark(const index_t &bi)
+        {
+            if (!all && (bundles.empty() || last != bi)) {
+                bundles.insert(bi);
+                last = bi;
+            }
+        }
+
+        inline void clear()
+        {
+            bundles.clear();
+            all = false;
+        }
+    };
+    /// bundles written since partially allocated bundles were last expanded
+    mutable dirty_t                            dirty_;
+    /// bundles written since the map was last finalized
+    mutable dirty_t                            unfinalized_;
 
     inline static distribution_t* getAllocate(const distribution_storage_ptr_t &s,
                                               const index_t &i)
@@ -274,8 +721,248 @@ protected:
         return d ? d : &(s->insert(i, distribution_t()));
     }
 
+    inline distribution_bundle_t *getBundle(const index_t &bi) const
+    {
+        if (budget_)
+            budget_->access(*this, bi);
+        return findBundle(bi);
+    }
+
+    inline distribution_bundle_t *findBundle(const index_t &bi) const
+    {
+        for (std::size_t l=overlays_.size(); l>0; --l) {
+            if (overlays_[l-1]->removed_bundles.count(bi) > 0)
+                return nullptr;
+            distribution_bundle_t *bundle = overlays_[l-1]->bundles.get(bi);
+            if (bundle)
+                return bundle;
+        }
+        return bundle_storage_->get(bi);
+    }
+
+    template <typename Fn>
+    inline void traverseResident(const Fn& function) const
+    {
+        if (overlays_.empty())
+            return bundle_storage_->traverse(function);
+
+        /// every bundle is visited once, in the topmost layer it appears in
+        auto shadowed = [this](const index_t &bi, const std::size_t layer) {
+            for (std::size_t i=layer; i<overlays_.size(); ++i)
+                if (overlays_[i]->bundles.get(bi) || overlays_[i]->removed_bundles.count(bi) > 0)
+                    return true;
+            return false;
+        };
+        for (std::size_t l=overlays_.size(); l>0; --l) {
+            const index_set_t &removed = overlays_[l-1]->removed_bundles;
+            overlays_[l-1]->bundles.traverse([&function, &shadowed, &removed, &l](const index_t &bi, distribution_bundle_t &b) {
+                if (removed.count(bi) == 0 && !shadowed(bi, l))
+                    function(bi, b);
+            });
+        }
+        bundle_storage_->traverse([&function, &shadowed](const index_t &bi, distribution_bundle_t &b) {
+            if (!shadowed(bi, 0ul))
+                function(bi, b);
+        });
+    }
+
+    inline bool hasEvictedTiles() const
+    {
+        return budget_ && budget_->hasEvictedTiles();
+    }
+
+    /**
+     * @brief Visit the bundles of all evicted tiles accepted by filter, see
+     *        MemoryBudget::traverseTile.
+     */
+    template <typename Fn, typename filter_t>
+    inline void traverseEvicted(const Fn &function,
+                                const filter_t &filter) const
+    {
+        if (hasEvictedTiles())
+            budget_->traverseEvicted(*this, function, filter);
+    }
+
+    struct morton_entry_t {
+        uint64_t                     code;
+        index_t                      bi;
+        const distribution_bundle_t *bundle;
+
+        inline bool operator < (const morton_entry_t &other) const
+        {
+            return code < other.code;
+        }
+    };
+
+    /**
+     * @brief All bundles in memory, sorted in Morton order of their indices.
+     */
+    inline void getMortonEntries(std::vector<morton_entry_t> &entries) const
+    {
+        entries.clear();
+        entries.reserve(bundleCount());
+        traverseResident([&entries](const index_t &bi, const distribution_bundle_t &b) {
+            entries.emplace_back(morton_entry_t{utility::morton_code<Dim>(bi), bi, &b});
+        });
+        std::sort(entries.begin(), entries.end());
+    }
+
+    /**
+     * @brief Visit the bundles with their center inside a convex region.
+     *        Candidates are the bundles in the bounding box of corners, either
+     *        looked up one by one or, if the box holds more cells than the map
+     *        holds bundles, by filtering a full traversal. So queries cost
+     *        O(min(box, map)) lookups for array and tree backends alike.
+     */
+    template <typename corners_t, typename contains_t, typename Fn>
+    inline void traverseRegion(const corners_t &corners,
+                               const contains_t &contains,
+                               const Fn &function) const
+    {
+        index_t min = utility::create<int,Dim>(std::numeric_limits<int>::max());
+        index_t max = utility::create<int,Dim>(std::numeric_limits<int>::min());
+        for (const point_t &c : corners) {
+            const index_t bi = toBundleIndex(c);
+            min = std::min(min, bi);
+            max = std::max(max, bi);
+        }
+        min = std::max(min, min_bundle_index_);
+        max = std::min(max, max_bundle_index_);
+
+        std::size_t cells = 1ul;
+        for (std::size_t i=0; i<Dim; ++i) {
+            if (min[i] > max[i])
+                return;
+            cells *= static_cast<std::size_t>(max[i] - min[i] + 1);
+        }
+
+        auto visit = [this, &contains, &function](const index_t &bi, const distribution_bundle_t &b) {
+            if (contains(toBundleCenter(bi)))
+                function(bi, b);
+        };
+
+        auto visit_box = [&min, &max, &visit](const index_t &bi, const distribution_bundle_t &b) {
+            for (std::size_t i=0; i<Dim; ++i)
+                if (bi[i] < min[i] || bi[i] > max[i])
+                    return;
+            visit(bi, b);
+        };
+
+        /// static and rolling maps are bounded by their extent anyway
+        if (option_t != tags::dynamic_map || cells <= bundleCount()) {
+            forEach(min, max, [this, &visit](const index_t &bi) {
+                const distribution_bundle_t *b = findBundle(bi);
+                if (b)
+                    visit(bi, *b);
+            });
+        } else {
+            traverseResident(visit_box);
+        }
+
+        traverseEvicted(visit_box, [this, &min, &max](const index_t &tile) {
+            return budget_->overlaps(tile, min, max);
+        });
+    }
+
+    /// upper bound of the bundles in memory, bundles in overlays may be counted twice
+    inline std::size_t bundleCount() const
+    {
+        std::size_t count = bundle_storage_->size();
+        for (const overlay_ptr_t &overlay : overlays_)
+            count += overlay->bundles.size();
+        return count;
+    }
+
+    inline point_t toBundleCenter(const index_t &bi) const
+    {
+        point_t p_m;
+        for (std::size_t i=0; i<Dim; ++i)
+            p_m(i) = (static_cast<T>(bi[i]) + cslibs_math::utility::traits<T>::Half) * bundle_resolution_;
+        return w_T_m_ * p_m;
+    }
+
+    /**
+     * @brief Visit all indices in the box [min, max].
+     */
+    template <typename Fn>
+    inline static void forEach(const index_t &min,
+                               const index_t &max,
+                               const Fn &function)
+    {
+        for (std::size_t i=0; i<Dim; ++i)
+            if (min[i] > max[i])
+                return;
+
+        index_t index = min;
+        while (true) {
+            function(index);
+
+            std::size_t i = 0;
+            for (; i<Dim; ++i) {
+                if (index[i] < max[i]) {
+                    ++ index[i];
+                    break;
+                }
+                index[i] = min[i];
+            }
+            if (i == Dim)
+                return;
+        }
+    }
+
+    inline distribution_t *findDistribution(const std::size_t i,
+                                            const index_t &index) const
+    {
+        for (std::size_t l=overlays_.size(); l>0; --l) {
+            if (overlays_[l-1]->removed[i].count(index) > 0)
+                return nullptr;
+            distribution_t *d = overlays_[l-1]->storage[i].get(index);
+            if (d)
+                return d;
+        }
+        return storage_[i]->get(index);
+    }
+
+    /**
+     * @brief Look up the distributions of a bundle without allocating it, the
+     *        ones which do not exist are nullptr. Neighbouring bundles share
+     *        distributions, so they may exist although the bundle does not.
+     *        insertVisible reads the occlusion of neighbouring bundles this
+     *        way, so that it does not allocate bundles in unobserved space.
+     */
+    inline std::array<const distribution_t*, bin_count> findDistributions(const index_t &bi) const
+    {
+        std::array<const distribution_t*, bin_count> distributions;
+        distributions.fill(nullptr);
+        if (!valid(bi))
+            return distributions;
+
+        if (budget_)
+            budget_->load(*this, bi);
+
+        const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+        for (std::size_t i=0; i<bin_count; ++i)
+            distributions[i] = findDistribution(i, indices[i]);
+        return distributions;
+    }
+
     inline distribution_bundle_t *getAllocate(const index_t &bi) const
     {
+        if (!valid(bi))
+            return nullptr;
+
+        dirty_.mark(bi);
+        unfinalized_.mark(bi);
+
+        if (budget_)
+            budget_->reserve(*this, bi);
+
+        if (!overlays_.empty() || !unique()) {
+            compact();
+            if (!overlays_.empty() || !unique())
+                return getAllocateOverlay(bi);
+        }
+
         auto get_allocate = [this](const index_t &bi) {
             distribution_bundle_t *bundle = bundle_storage_->get(bi);
 
@@ -297,18 +984,407 @@ protected:
         return get_allocate(bi);
     }
 
-    virtual void updateIndices(const index_t &chunk_index) const = 0;
-    virtual bool valid(const index_t &index) const = 0;
+    /**
+     * @brief Check if the storages are exclusively owned by this map and may
+     *        be modified in place.
+     */
+    inline bool unique() const
+    {
+        bool retval = bundle_storage_.use_count() == 1;
+        for (std::size_t i=0; i<bin_count; ++i)
+            retval = retval && storage_[i].use_count() == 1;
+        /// synchronize with the release of the last other owner
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return retval;
+    }
+
+    /**
+     * @brief Make the storages exclusively owned by this map with all pending
+     *        changes folded in, so they can be modified in place. Storages
+     *        still shared with snapshots are copied.
+     */
+    inline void detach() const
+    {
+        if (unique()) {
+            compact();
+            return;
+        }
+
+        distribution_storage_array_t storage = utility::create<distribution_storage_t,bin_count>(storage_);
+        distribution_bundle_storage_ptr_t bundles(new distribution_bundle_storage_t(*bundle_storage_));
+        rebind(storage, *bundles);
+        for (const overlay_ptr_t &overlay : overlays_)
+            fold(*overlay, base_storage_accessor_t{storage, *bundles});
+
+        storage_        = storage;
+        bundle_storage_ = bundles;
+        overlays_.clear();
+    }
+
+    /**
+     * @brief Point all bundles to the distributions in storage.
+     */
+    inline static void rebind(const distribution_storage_array_t &storage,
+                              distribution_bundle_storage_t      &bundles)
+    {
+        bundles.traverse([&storage](const index_t &bi, distribution_bundle_t &bundle) {
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            for (std::size_t i=0; i<bin_count; ++i)
+                bundle[i] = storage[i]->get(indices[i]);
+        });
+    }
+
+    /**
+     * @brief Fold all exclusively owned overlays into the topmost exclusively
+     *        owned layer below them. Ownership can only decrease bottom up, a
+     *        layer shared by a snapshot is shared together with everything below.
+     */
+    inline void compact() const
+    {
+        if (overlays_.empty())
+            return;
+
+        if (unique()) {
+            for (const overlay_ptr_t &overlay : overlays_)
+                fold(*overlay, base_storage_accessor_t{storage_, *bundle_storage_});
+            overlays_.clear();
+            return;
+        }
+
+        std::size_t target = 0;
+        while (target < overlays_.size() && overlays_[target].use_count() > 1)
+            ++ target;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (target + 1 >= overlays_.size())
+            return;
+
+        overlay_t &lower = *overlays_[target];
+        for (std::size_t l=target+1; l<overlays_.size(); ++l)
+            fold(*overlays_[l], overlay_storage_accessor_t{lower});
+        overlays_.resize(target + 1);
+    }
+
+    inline overlay_t &getTopOverlay() const
+    {
+        if (overlays_.empty() || overlays_.back().use_count() > 1)
+            overlays_.emplace_back(new overlay_t);
+        return *overlays_.back();
+    }
+
+    inline distribution_bundle_t *getAllocateOverlay(const index_t &bi) const
+    {
+        overlay_t &top = getTopOverlay();
+
+        /// look up distributions and bundles below the top overlay
+        auto find_distribution = [this](const std::size_t i, const index_t &index) -> const distribution_t* {
+            for (std::size_t l=overlays_.size()-1; l>0; --l) {
+                if (overlays_[l-1]->removed[i].count(index) > 0)
+                    return nullptr;
+                const distribution_t *d = overlays_[l-1]->storage[i].get(index);
+                if (d)
+                    return d;
+            }
+            return storage_[i]->get(index);
+        };
+        auto find_bundle = [this](const index_t &bi) -> const distribution_bundle_t* {
+            for (std::size_t l=overlays_.size()-1; l>0; --l) {
+                if (overlays_[l-1]->removed_bundles.count(bi) > 0)
+                    return nullptr;
+                const distribution_bundle_t *b = overlays_[l-1]->bundles.get(bi);
+                if (b)
+                    return b;
+            }
+            return bundle_storage_->get(bi);
+        };
+
+        /// every bundle sharing a copied distribution has to refer to the copy
+        auto repoint = [&top, &find_bundle](const std::size_t i, const index_t &index, distribution_t *d) {
+            for (std::size_t c=0; c<bin_count; ++c) {
+                index_t bi;
+                for (std::size_t j=0; j<Dim; ++j) {
+                    const bool upper = ((i >> j) & 1ul) != 0ul;
+                    const bool first = ((c >> j) & 1ul) == 0ul;
+                    bi[j] = 2 * index[j] + (upper ? (first ? -1 : 0) : (first ? 0 : 1));
+                }
+                if (top.removed_bundles.count(bi) > 0)
+                    continue;
+                distribution_bundle_t *bundle = top.bundles.get(bi);
+                if (!bundle) {
+                    const distribution_bundle_t *below = find_bundle(bi);
+                    if (!below)
+                        continue;
+                    bundle = &top.bundles.insert(bi, *below);
+                }
+                (*bundle)[i] = d;
+            }
+        };
+
+        /// removed entries of the top overlay start over when written again
+        const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+        for (std::size_t i=0; i<bin_count; ++i) {
+            const bool removed = top.removed[i].erase(indices[i]) > 0;
+            distribution_t *d = top.storage[i].get(indices[i]);
+            if (d && !removed)
+                continue;
+            const distribution_t *below = removed ? nullptr : find_distribution(i, indices[i]);
+            if (d)
+                *d = distribution_t();
+            else
+                d = &top.storage[i].insert(indices[i], below ? *below : distribution_t());
+            repoint(i, indices[i], d);
+        }
+
+        const bool removed = top.removed_bundles.erase(bi) > 0;
+        distribution_bundle_t *bundle = top.bundles.get(bi);
+        if (!bundle || removed) {
+            distribution_bundle_t b;
+            for (std::size_t i=0; i<bin_count; ++i)
+                b[i] = top.storage[i].get(indices[i]);
+            updateIndices(bi);
+            if (bundle)
+                *bundle = b;
+            else
+                bundle = &top.bundles.insert(bi, b);
+        }
+        return bundle;
+    }
+
+    /**
+     * @brief Remove a bundle. Storages shared with snapshots are not modified,
+     *        the removal is recorded in the top overlay instead.
+     */
+    inline void removeBundle(const index_t &bi) const
+    {
+        if (overlays_.empty() && unique()) {
+            removeIndex(*bundle_storage_, bi, option_tag_t());
+            return;
+        }
+        getTopOverlay().removed_bundles.insert(bi);
+    }
+
+    inline void removeDistribution(const std::size_t i,
+                                   const index_t &index) const
+    {
+        if (overlays_.empty() && unique()) {
+            removeIndex(*storage_[i], index, option_tag_t());
+            return;
+        }
+        getTopOverlay().removed[i].insert(index);
+    }
+
+    /// only rolling maps remove entries, the backends of the other maps need not support it
+    template <typename storage_t, tags::option o>
+    inline static void removeIndex(storage_t &, const index_t &, std::integral_constant<tags::option, o>)
+    {
+    }
+
+    template <typename storage_t>
+    inline static void removeIndex(storage_t &storage, const index_t &index, std::integral_constant<tags::option, tags::rolling_map>)
+    {
+        storage.remove(index);
+    }
+
+    struct base_storage_accessor_t {
+        distribution_storage_array_t  &storage;
+        distribution_bundle_storage_t &bundle_storage;
+        inline distribution_storage_t& operator () (const std::size_t i) const
+        {
+            return *storage[i];
+        }
+        inline distribution_bundle_storage_t& bundles() const
+        {
+            return bundle_storage;
+        }
+        inline distribution_t* find(const std::size_t i, const index_t &index) const
+        {
+            return storage[i]->get(index);
+        }
+        inline void remove(const std::size_t i, const index_t &index) const
+        {
+            removeIndex(*storage[i], index, option_tag_t());
+        }
+        inline void removeBundle(const index_t &bi) const
+        {
+            removeIndex(bundle_storage, bi, option_tag_t());
+        }
+        inline void written(const std::size_t, const index_t &) const
+        {
+        }
+        inline void writtenBundle(const index_t &) const
+        {
+        }
+    };
+
+    struct overlay_storage_accessor_t {
+        overlay_t &overlay;
+        inline dynamic_distribution_storage_t& operator () (const std::size_t i) const
+        {
+            return overlay.storage[i];
+        }
+        inline dynamic_bundle_storage_t& bundles() const
+        {
+            return overlay.bundles;
+        }
+        inline distribution_t* find(const std::size_t i, const index_t &index) const
+        {
+            return overlay.removed[i].count(index) > 0 ? nullptr : overlay.storage[i].get(index);
+        }
+        inline void remove(const std::size_t i, const index_t &index) const
+        {
+            overlay.removed[i].insert(index);
+        }
+        inline void removeBundle(const index_t &bi) const
+        {
+            overlay.removed_bundles.insert(bi);
+        }
+        inline void written(const std::size_t i, const index_t &index) const
+        {
+            overlay.removed[i].erase(index);
+        }
+        inline void writtenBundle(const index_t &bi) const
+        {
+            overlay.removed_bundles.erase(bi);
+        }
+    };
+
+    template <typename storage_t, typename written_t>
+    inline static void fold(dynamic_distribution_storage_t &upper,
+                            const index_set_t &removed,
+                            storage_t &lower,
+                            const written_t &written)
+    {
+        upper.traverse([&removed, &lower, &written](const index_t &index, distribution_t &d) {
+            if (removed.count(index) > 0)
+                return;
+            distribution_t *l = lower.get(index);
+            if (l)
+                *l = d;
+            else
+                lower.insert(index, d);
+            written(index);
+        });
+    }
+
+    /**
+     * @brief Apply the changes of an overlay to the layer directly below it,
+     *        removals first, entries written afterwards override them.
+     */
+    template <typename accessor_t>
+    inline static void fold(overlay_t &upper,
+                            const accessor_t &lower)
+    {
+        for (std::size_t i=0; i<bin_count; ++i) {
+            for (const index_t &index : upper.removed[i])
+                lower.remove(i, index);
+            fold(upper.storage[i], upper.removed[i], lower(i), [&lower, i](const index_t &index) {
+                lower.written(i, index);
+            });
+        }
+
+        for (const index_t &bi : upper.removed_bundles)
+            lower.removeBundle(bi);
+        upper.bundles.traverse([&upper, &lower](const index_t &bi, distribution_bundle_t &b) {
+            if (upper.removed_bundles.count(bi) > 0)
+                return;
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            distribution_bundle_t folded;
+            for (std::size_t i=0; i<bin_count; ++i) {
+                distribution_t *d = lower.find(i, indices[i]);
+                folded[i] = d ? d : b[i];
+            }
+            distribution_bundle_t *l = lower.bundles().get(bi);
+            if (l)
+                *l = folded;
+            else
+                lower.bundles().insert(bi, folded);
+            lower.writtenBundle(bi);
+        });
+    }
+
+    /**
+     * @brief Limit the estimated memory of the map to bytes. Bundles are grouped
+     *        into tiles of tile_size^Dim bundles, once the budget is exceeded the
+     *        least recently accessed tiles are written to directory and loaded
+     *        again on access.
+     *        A budgeted map is single-threaded: const lookups like get or
+     *        sample load tiles, which replaces the storages
+     *        and invalidates bundles and distributions obtained before. The
+     *        budget bookkeeping is serialized, but to read from several threads
+     *        share a snapshot instead, snapshots have no budget.
+     */
+    inline void enableBudget(const std::size_t  bytes,
+                             const std::string &directory,
+                             const std::size_t  tile_size)
+    {
+        budget_.reset(new budget_t(bytes, tile_size, directory));
+        budget_->track(*this);
+    }
+
+    /**
+     * @brief Load all evicted tiles back into memory.
+     */
+    inline void restoreEvictedTiles()
+    {
+        if (budget_)
+            budget_->restoreEvictedTiles(*this);
+    }
+
+    /// the map type is known at compile time, so bounds handling is resolved statically
+    using option_tag_t = std::integral_constant<tags::option, option_t>;
+
+    inline void updateIndices(const index_t &chunk_index) const
+    {
+        updateIndices(chunk_index, option_tag_t());
+    }
+
+    inline bool valid(const index_t &index) const
+    {
+        return valid(index, option_tag_t());
+    }
+
+    /// static and rolling maps have fixed bounds
+    template <tags::option o>
+    inline void updateIndices(const index_t &, std::integral_constant<tags::option, o>) const
+    {
+    }
+
+    /// dynamic maps grow with every new bundle
+    inline void updateIndices(const index_t &chunk_index, std::integral_constant<tags::option, tags::dynamic_map>) const
+    {
+        min_bundle_index_ = std::min(min_bundle_index_, chunk_index);
+        max_bundle_index_ = std::max(max_bundle_index_, chunk_index);
+    }
+
+    template <tags::option o>
+    inline bool valid(const index_t &index, std::integral_constant<tags::option, o>) const
+    {
+        for (std::size_t i=0; i<Dim; ++i)
+            if (index[i] < min_bundle_index_[i] || index[i] > max_bundle_index_[i])
+                return false;
+        return true;
+    }
+
+    inline bool valid(const index_t &, std::integral_constant<tags::option, tags::dynamic_map>) const
+    {
+        return true;
+    }
 
     inline index_t toBundleIndex(const point_t &p_w) const
     {
         const point_t p_m = m_T_w_ * p_w;
         index_t retval;
         for (std::size_t i=0; i<Dim; ++i)
-            retval[i] = static_cast<int>(std::floor(p_m(i) * bundle_resolution_inv_));
+            retval[i] = floorToInt(p_m(i) * bundle_resolution_inv_);
         return retval;
     }
 
+    /// the same as std::floor for finite values, but without a library call
+    inline static int floorToInt(const T v)
+    {
+        const int i = static_cast<int>(v);
+        return i - static_cast<int>(v < static_cast<T>(i));
+    }
+
     inline bool toBundleIndex(const point_t &p_w,
                               index_t &index) const
     {
@@ -316,16 +1392,385 @@ protected:
         return valid(index);
     }
 
-    virtual bool expandDistribution(const distribution_t* d) const = 0;
+    /**
+     * @brief Center of the cell covered by the distribution of bin i at index,
+     *        in map coordinates. The cell spans two bundles per dimension,
+     *        starting at bundle 2 * index, or at 2 * index - 1 if bit j of i is set.
+     */
+    inline point_t toDistributionCenter(const std::size_t i,
+                                        const index_t &index) const
+    {
+        point_t c;
+        for (std::size_t j=0; j<Dim; ++j)
+            c(j) = bundle_resolution_ * static_cast<T>(2 * index[j] + (((i >> j) & 1ul) ? 0 : 1));
+        return c;
+    }
+
+    /**
+     * @brief Index of the distribution of bin i whose cell contains p_w.
+     */
+    inline index_t toDistributionIndex(const std::size_t i,
+                                       const point_t &p_w) const
+    {
+        const point_t p_m = m_T_w_ * p_w;
+        index_t index;
+        for (std::size_t j=0; j<Dim; ++j) {
+            const T v = p_m(j) * bundle_resolution_inv_;
+            index[j] = floorToInt(T(0.5) * (((i >> j) & 1ul) ? v + T(1) : v));
+        }
+        return index;
+    }
+
+    /**
+     * @brief A bundle referring to the distribution of bin i at index, the
+     *        first one of the 2^Dim candidates in bundles, else 2 * index.
+     */
+    template <typename set_t>
+    inline static index_t toReferringBundleIndex(const std::size_t i,
+                                                 const index_t &index,
+                                                 const set_t &bundles)
+    {
+        index_t bi;
+        for (std::size_t c=0; c<bin_count; ++c) {
+            for (std::size_t j=0; j<Dim; ++j) {
+                const bool upper = ((i >> j) & 1ul) != 0ul;
+                const bool first = ((c >> j) & 1ul) == 0ul;
+                bi[j] = 2 * index[j] + (upper ? (first ? -1 : 0) : (first ? 0 : 1));
+            }
+            if (bundles.count(bi) > 0)
+                return bi;
+        }
+        for (std::size_t j=0; j<Dim; ++j)
+            bi[j] = 2 * index[j];
+        return bi;
+    }
 
-    inline bool expandBundle(const distribution_bundle_t *bundle) const
+    /**
+     * @brief Allocate the neighbourhood of all bundles with at least one
+     *        distribution expand accepts. After the first call, only bundles
+     *        sharing distributions with bundles written since the last call
+     *        are checked. Bundles allocated by the expansion itself are not
+     *        expanded again, so calling this twice without inserting in
+     *        between does not grow the map.
+     * @param expand    predicate on a distribution, given by the map implementation
+     * @param pool      optional thread pool to find the bundles to expand with
+     */
+    template <typename expand_t>
+    inline void allocatePartiallyAllocatedBundles(const expand_t &expand,
+                                                  utility::ThreadPool *pool = nullptr)
     {
-        if (!bundle)
+        auto expand_bundle = [&expand](const distribution_bundle_t &bundle) {
+            for (std::size_t i=0; i<bin_count; ++i)
+                if (expand(bundle.at(i)))
+                    return true;
             return false;
-        for (std::size_t i=0; i<bin_count; ++i)
-            if (expandDistribution(bundle->at(i)))
-                return true;
-        return false;
+        };
+
+        static constexpr neighborhood_t grid{};
+        auto neighbor = [](const index_t &bi, const typename neighborhood_t::offset_t &o) {
+            index_t ii;
+            for (std::size_t i=0; i<Dim; ++i)
+                ii[i] = bi[i] + o[i];
+            return ii;
+        };
+
+        /// finding the bundles only reads the map, allocating them is serial
+        utility::ThreadLocal<std::vector<index_t>> expanded(pool);
+        if (dirty_.all) {
+            traverse([&expanded, &expand_bundle](const index_t &bi, const distribution_bundle_t &b) {
+                if (expand_bundle(b))
+                    expanded.local().emplace_back(bi);
+            }, pool);
+        } else {
+            /// written distributions are shared with the neighbourhood
+            std::vector<index_t> candidates;
+            for (const index_t &bi : dirty_.bundles)
+                grid.visit([&candidates, &neighbor, &bi](typename neighborhood_t::offset_t o) {
+                    candidates.emplace_back(neighbor(bi, o));
+                });
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            auto check = [this, &candidates, &expanded, &expand_bundle](const std::size_t begin,
+                                                                          const std::size_t end) {
+                for (std::size_t i=begin; i<end; ++i) {
+                    const distribution_bundle_t *b = findBundle(candidates[i]);
+                    if (b && expand_bundle(*b))
+                        expanded.local().emplace_back(candidates[i]);
+                }
+            };
+            if (pool) {
+                const std::size_t chunks = std::min(candidates.size(), 4ul * pool->size());
+                pool->run(chunks, [&check, &candidates, chunks](const std::size_t c) {
+                    check(c * candidates.size() / chunks, (c + 1) * candidates.size() / chunks);
+                });
+            } else {
+                check(0ul, candidates.size());
+            }
+        }
+
+        expanded.traverse([this, &neighbor](const std::vector<index_t> &bis) {
+            for (const index_t &bi : bis)
+                grid.visit([this, &neighbor, &bi](typename neighborhood_t::offset_t o) {
+                    getAllocate(neighbor(bi, o));
+                });
+        });
+
+        dirty_.clear();
+    }
+
+    /**
+     * @brief Cast rays from start_p to the end points of rays, both in the map
+     *        frame, and sum up the value of each ray for all bundles it passes.
+     *        With a pool, the rays are cast in parallel into per thread
+     *        buffers, which are partitioned by bundle_hash, so that partitions
+     *        are merged in parallel without conflicts. apply(bi, sum) is then
+     *        called once per bundle from the calling thread.
+     * @param start_p   common origin of all rays
+     * @param rays      end point and value of each ray
+     * @param pool      optional thread pool to cast the rays with
+     * @param apply     callable taking a bundle index and the summed value
+     */
+    template <typename line_iterator_t, typename value_t, typename apply_t>
+    inline void carve(const point_t &start_p,
+                      const std::vector<std::pair<point_t,value_t>> &rays,
+                      utility::ThreadPool *pool,
+                      const apply_t &apply) const
+    {
+        using buffer_t = std::unordered_map<index_t, value_t, utility::bundle_hash<Dim>>;
+        static const utility::bundle_hash<Dim> hash{};
+
+        const std::size_t partitions = pool ? pool->size() : 1ul;
+        utility::ThreadLocal<std::vector<buffer_t>> buffers(pool, std::vector<buffer_t>(partitions));
+        auto cast = [this, &start_p, &rays, &buffers, partitions](const std::size_t begin,
+                                                                  const std::size_t end) {
+            std::vector<buffer_t> &buffer = buffers.local();
+            for (std::size_t k=begin; k<end; ++k) {
+                line_iterator_t it(start_p, rays[k].first, this->bundle_resolution_);
+                while (!it.done()) {
+                    const index_t &bi = it();
+                    buffer[hash(bi) % partitions][bi] += rays[k].second;
+                    ++ it;
+                }
+            }
+        };
+
+        std::vector<std::vector<buffer_t>*> threads;
+        buffers.traverse([&threads, &rays, partitions](std::vector<buffer_t> &buffer) {
+            threads.emplace_back(&buffer);
+            /// avoids most rehashing, rays share many bundles near the origin
+            for (buffer_t &b : buffer)
+                b.reserve(16ul * rays.size() / (partitions * partitions));
+        });
+
+        if (pool) {
+            const std::size_t chunks = std::min(rays.size(), 4ul * pool->size());
+            pool->run(chunks, [&cast, &rays, chunks](const std::size_t c) {
+                cast(c * rays.size() / chunks, (c + 1) * rays.size() / chunks);
+            });
+            pool->run(partitions, [&threads](const std::size_t p) {
+                buffer_t &merged = (*threads.front())[p];
+                for (std::size_t t=1; t<threads.size(); ++t)
+                    for (const auto &e : (*threads[t])[p])
+                        merged[e.first] += e.second;
+            });
+        } else {
+            cast(0ul, rays.size());
+        }
+
+        for (const buffer_t &merged : *threads.front())
+            for (const auto &e : merged)
+                apply(e.first, e.second);
+    }
+
+    /**
+     * @brief Add every distribution of other once to a distribution of the
+     *        same bin of this map, the one whose cell contains its moved mean,
+     *        or the moved center of its own cell if it has no samples. With an
+     *        identical grid each distribution meets its counterpart, the target
+     *        does not depend on which of the bundles sharing a distribution is
+     *        visited first. Each bundle of other is moved as well, so that the
+     *        bundle containing its center is allocated. Bundles are
+     *        allocated serially, the distributions are then merged in
+     *        parallel, partitioned by their target. Allocation may evict tiles
+     *        or replace the storages, so targets are only resolved to pointers
+     *        once all of them are allocated, resident and detached.
+     *        If both maps share origin and resolution and w_T_other is the
+     *        identity, distributions are added by merge(), directly from the
+     *        storages of other if it has no overlays and this map no budget.
+     *        Otherwise they are added by function(target, source), which has
+     *        to move source by w_T_other. If other has evicted tiles, a copy
+     *        of other holding all of them is regridded instead.
+     * @param other     the map to add
+     * @param w_T_other pose of the world frame of other in the world frame of this map
+     * @param pool      optional thread pool to merge with
+     * @param mean      callable mean(source, p), false if source has no samples
+     * @param function  callable adding a moved source to the target distribution
+     */
+    template <typename Mean, typename Fn>
+    inline void regrid(const AbstractMap &other,
+                       const transform_t &w_T_other,
+                       utility::ThreadPool *pool,
+                       const Mean &mean,
+                       const Fn &function)
+    {
+        using pair_t = std::pair<distribution_t*, const distribution_t*>;
+        struct entry_t {
+            index_t                 target;
+            std::size_t             bin;
+            const distribution_t   *source;
+        };
+        assert(&other != this);
+
+        /// traversals and the storages of other only hold the tiles in memory
+        if (other.hasEvictedTiles())
+            return regrid(AbstractMap(other), w_T_other, pool, mean, function);
+
+        auto identity = [](const transform_t &t) {
+            return t.getEigenRotation().isIdentity(1e-9) && t.translation().data().isZero(1e-9);
+        };
+        const bool aligned = identity(w_T_other) &&
+                             identity(w_T_m_.inverse() * other.w_T_m_) &&
+                             other.bundle_resolution_ == bundle_resolution_;
+
+        /// on an identical grid each distribution of other meets its counterpart, bins are merged in parallel
+        if (aligned && other.overlays_.empty() && !budget_) {
+            other.bundle_storage_->traverse([this](const index_t &bi, const distribution_bundle_t &) {
+                getAllocate(bi);
+            });
+            detach();
+
+            auto merge = [this, &other](const std::size_t i) {
+                other.storage_[i]->traverse([this, i](const index_t &index, const distribution_t &d) {
+                    distribution_t *target = storage_[i]->get(index);
+                    if (target)
+                        target->merge(d);
+                });
+            };
+            if (pool) {
+                pool->run(bin_count, merge);
+            } else {
+                for (std::size_t i=0; i<bin_count; ++i)
+                    merge(i);
+            }
+            return;
+        }
+
+        const transform_t w_T_other_m = w_T_other * other.w_T_m_;
+
+        /// moved bundles first, distributions are added through one of them
+        std::unordered_set<index_t, utility::bundle_hash<Dim>> moved;
+        other.traverse([this, &other, aligned, &w_T_other_m, &moved](const index_t &bi, const distribution_bundle_t &) {
+            index_t target = bi;
+            if (!aligned) {
+                point_t c;
+                for (std::size_t j=0; j<Dim; ++j)
+                    c(j) = other.bundle_resolution_ * (static_cast<T>(bi[j]) + T(0.5));
+                target = toBundleIndex(w_T_other_m * c);
+            }
+            if (getAllocate(target))
+                moved.insert(target);
+        });
+
+        std::vector<entry_t> entries;
+        std::unordered_set<const distribution_t*> visited;
+        other.traverse([this, &other, aligned, &w_T_other, &w_T_other_m, &mean, &moved, &entries, &visited](const index_t &bi, const distribution_bundle_t &b) {
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            for (std::size_t i=0; i<bin_count; ++i) {
+                const distribution_t *d = b.at(i);
+                if (!d || !visited.insert(d).second)
+                    continue;
+
+                index_t target = bi;
+                if (!aligned) {
+                    point_t p;
+                    const index_t index = toDistributionIndex(i, mean(*d, p) ? w_T_other * p :
+                                                                               w_T_other_m * other.toDistributionCenter(i, indices[i]));
+                    target = toReferringBundleIndex(i, index, moved);
+                }
+                if (getAllocate(target))
+                    entries.emplace_back(entry_t{target, i, d});
+            }
+        });
+
+        /// no allocation follows, tiles evicted meanwhile are loaded again
+        if (budget_) {
+            for (const entry_t &e : entries)
+                budget_->load(*this, e.target);
+        }
+        detach();
+
+        const std::size_t partitions = pool ? pool->size() : 1ul;
+        std::vector<std::vector<pair_t>> pairs(partitions);
+        for (const entry_t &e : entries) {
+            distribution_bundle_t *bundle = findBundle(e.target);
+            assert(bundle && bundle->at(e.bin));
+            const index_t index = utility::generate_indices<index_list_t,Dim>(e.target)[e.bin];
+            pairs[utility::distribution_partition<Dim>(index, e.bin, partitions)].emplace_back(bundle->at(e.bin), e.source);
+        }
+
+        auto merge = [aligned, &pairs, &function](const std::size_t p) {
+            for (const pair_t &e : pairs[p]) {
+                if (aligned)
+                    e.first->merge(*e.second);
+                else
+                    function(*e.first, *e.second);
+            }
+        };
+        if (pool)
+            pool->run(partitions, merge);
+        else
+            merge(0ul);
+    }
+
+    /**
+     * @brief Undo adding other on an identical grid, e.g. a layer added by
+     *        regrid with the identity, each distribution of other is removed
+     *        from its counterpart by function(target, source), the bins in
+     *        parallel. Bundles stay allocated, also those which only other
+     *        had allocated. Throws if other lies on another grid.
+     * @param other     the map to remove
+     * @param pool      optional thread pool to remove with
+     * @param function  callable removing source from the target distribution
+     */
+    template <typename Fn>
+    inline void unmerge(const AbstractMap &other,
+                        utility::ThreadPool *pool,
+                        const Fn &function)
+    {
+        assert(&other != this);
+        const transform_t m_T_other = w_T_m_.inverse() * other.w_T_m_;
+        if (other.bundle_resolution_ != bundle_resolution_ ||
+                !m_T_other.getEigenRotation().isIdentity(1e-9) || !m_T_other.translation().data().isZero(1e-9))
+            throw std::runtime_error("[AbstractMap]: Can only unmerge maps on the same grid.");
+
+        /// the storages of other only hold the tiles in memory
+        if (other.hasEvictedTiles())
+            return unmerge(AbstractMap(other), pool, function);
+
+        other.traverse([this](const index_t &bi, const distribution_bundle_t &) {
+            getAllocate(bi);
+        });
+        if (budget_) {
+            other.traverse([this](const index_t &bi, const distribution_bundle_t &) {
+                budget_->load(*this, bi);
+            });
+        }
+        detach();
+
+        auto remove = [this, &other, &function](const std::size_t i) {
+            other.traverseDistributions(i, [this, i, &function](const index_t &index, const distribution_t &d) {
+                distribution_t *target = storage_[i]->get(index);
+                if (target)
+                    function(*target, d);
+            });
+        };
+        if (pool) {
+            pool->run(bin_count, remove);
+        } else {
+            for (std::size_t i=0; i<bin_count; ++i)
+                remove(i);
+        }
     }
 
 protected:
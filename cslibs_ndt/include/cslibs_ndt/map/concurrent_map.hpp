@@ -0,0 +1,129 @@
+#ifndef CSLIBS_NDT_MAP_CONCURRENT_MAP_HPP
+#define CSLIBS_NDT_MAP_CONCURRENT_MAP_HPP
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Single writer / multiple reader access to a map. The writer works on
+ *        a private map, readers get an immutable published version of it which
+ *        is swapped atomically (RCU-style). Readers never wait for the writer,
+ *        a published version stays valid as long as a reader holds on to it.
+ *        Publishing takes a finalized copy-on-write snapshot of the private
+ *        map, so that published versions are not written to by concurrent
+ *        readers. Readers only use the const
+ *        interface, e.g. get, getDistributionBundle, sample or traverse, which
+ *        never allocates. Moving a rolling map only records the bundles leaving
+ *        the window in the overlay, published versions are not copied.
+ */
+template <typename map_t>
+class ConcurrentMap
+{
+public:
+    using Ptr               = std::shared_ptr<ConcurrentMap<map_t>>;
+    using ConstPtr          = std::shared_ptr<const ConcurrentMap<map_t>>;
+
+    using map_ptr_t         = std::shared_ptr<map_t>;
+    using map_const_ptr_t   = std::shared_ptr<const map_t>;
+
+    /**
+     * @brief Constructor.
+     * @param map           map that is updated by the writer
+     * @param publish_rate  number of updates after which a new version is published
+     */
+    inline explicit ConcurrentMap(const map_ptr_t   &map,
+                                  const std::size_t  publish_rate = 1ul) :
+        map_(map),
+        publish_rate_(std::max<std::size_t>(publish_rate, 1ul)),
+        pending_(0ul),
+        version_(0ul)
+    {
+        if (!map_)
+            throw std::runtime_error("[ConcurrentMap]: map must not be null!");
+        doPublish();
+    }
+
+    template <typename... args_t>
+    inline void insert(args_t&&... args)
+    {
+        update([&args...](map_t &map) {
+            map.insert(std::forward<args_t>(args)...);
+        });
+    }
+
+    template <typename... args_t>
+    inline void insertVisible(args_t&&... args)
+    {
+        update([&args...](map_t &map) {
+            map.insertVisible(std::forward<args_t>(args)...);
+        });
+    }
+
+    /**
+     * @brief Apply an arbitrary modification to the working map.
+     * @param function  callable taking a map_t&
+     */
+    template <typename Fn>
+    inline void update(const Fn &function)
+    {
+        std::unique_lock<std::mutex> l(writer_mutex_);
+        function(*map_);
+        if (++ pending_ >= publish_rate_)
+            doPublish();
+    }
+
+    /**
+     * @brief Publish all pending updates.
+     */
+    inline void publish()
+    {
+        std::unique_lock<std::mutex> l(writer_mutex_);
+        if (pending_ > 0ul)
+            doPublish();
+    }
+
+    /**
+     * @brief Get the currently published map, does not wait for the writer.
+     * @return the published map
+     */
+    inline map_const_ptr_t get() const
+    {
+        return std::atomic_load(&published_);
+    }
+
+    /**
+     * @brief Number of published versions, can be used to detect updates cheaply.
+     * @return the version
+     */
+    inline std::size_t getVersion() const
+    {
+        return version_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::mutex                  writer_mutex_;
+    map_ptr_t                   map_;
+    map_const_ptr_t             published_;
+
+    const std::size_t           publish_rate_;
+    std::size_t                 pending_;
+    std::atomic<std::size_t>    version_;
+
+    inline void doPublish()
+    {
+        /// snapshots finalize the lazily cached statistics before readers share them
+        map_const_ptr_t published = map_->snapshot();
+        std::atomic_store(&published_, published);
+        pending_ = 0ul;
+        version_.fetch_add(1ul, std::memory_order_release);
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_CONCURRENT_MAP_HPP
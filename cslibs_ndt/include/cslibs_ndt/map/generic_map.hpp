@@ -3,6 +3,8 @@
 
 #include <cslibs_ndt/map/abstract_map.hpp>
 
+#include <functional>
+
 namespace cis = cslibs_indexed_storage;
 
 namespace cslibs_ndt {
@@ -99,20 +101,33 @@ public:
     }
 
     inline GenericMap(GenericMap &&other) :
-        base_t(other),
+        base_t(std::move(other)),
         size_(other.size_),
         size_m_(other.size_m_)
     {
     }
 
+    inline GenericMap(const GenericMap &other,
+                      const tags::snapshot &s) :
+        base_t(other, s),
+        size_(other.size_),
+        size_m_(other.size_m_)
+    {
+    }
+
+    /**
+     * @brief Look up a bundle, the const overloads never allocate, so that
+     *        published maps can be read by several threads.
+     * @return the bundle, nullptr if it is not allocated
+     */
     inline const distribution_bundle_t* getDistributionBundle(const index_t &bi) const
     {
-        return valid(bi) ? this->getAllocate(bi) : nullptr;
+        return this->valid(bi) ? this->getBundle(bi) : nullptr;
     }
 
     inline distribution_bundle_t* getDistributionBundle(const index_t &bi)
     {
-        return valid(bi) ? this->getAllocate(bi) : nullptr;
+        return this->valid(bi) ? this->getAllocate(bi) : nullptr;
     }
 
     inline const distribution_bundle_t* getDistributionBundle(const point_t &p) const
@@ -121,7 +136,7 @@ public:
         if (!this->toBundleIndex(p, bi))
             return nullptr;
 
-        return this->getAllocate(bi);
+        return this->getBundle(bi);
     }
 
     inline const distribution_bundle_t* get(const point_t &p) const
@@ -130,12 +145,12 @@ public:
         if (!this->toBundleIndex(p, bi))
             return nullptr;
 
-        return this->bundle_storage_->get(bi);
+        return this->getBundle(bi);
     }
 
     inline const distribution_bundle_t* get(const index_t &bi) const
     {
-        return valid(bi) ? this->bundle_storage_->get(bi) : nullptr;
+        return this->valid(bi) ? this->getBundle(bi) : nullptr;
     }
 
     inline size_m_t getSizeM() const
@@ -156,23 +171,6 @@ public:
 protected:
     const size_t    size_;
     const size_m_t  size_m_;
-
-    virtual inline void updateIndices(const index_t &chunk_index) const override
-    {
-    }
-
-    virtual inline bool valid(const index_t &index) const override
-    {
-        auto is_valid = [this,&index](const std::size_t &c) {
-            return index[c] >= this->min_bundle_index_[c] && index[c] <= this->max_bundle_index_[c];
-        };
-        for (std::size_t i=0; i<Dim; ++i)
-            if (!is_valid(i))
-                return false;
-        return true;
-    }
-
-    virtual inline bool expandDistribution(const distribution_t* d) const = 0;
 };
 
 template <std::size_t Dim,
@@ -231,16 +229,47 @@ public:
     }
 
     inline GenericMap(const GenericMap &other) : base_t(other) { }
-    inline GenericMap(GenericMap &&other) : base_t(other) { }
+    inline GenericMap(GenericMap &&other) : base_t(std::move(other)) { }
+    inline GenericMap(const GenericMap &other, const tags::snapshot &s) : base_t(other, s) { }
 
     inline bool empty() const
     {
         return this->min_bundle_index_[0] == std::numeric_limits<int>::max();
     }
 
+    /**
+     * @brief Limit the memory used by the map. Once the estimated size exceeds
+     *        bytes, the least recently accessed tiles of tile_size^Dim bundles
+     *        are written to files in directory, which has to exist, and loaded
+     *        again when they are accessed. Evicting rebuilds the storages, so
+     *        the map is kept below 4/7 of bytes and old and new storages
+     *        together below bytes. If tiles can not be written or read again,
+     *        std::runtime_error is thrown. Copies and snapshots contain all
+     *        tiles and have no budget. Traversals and serialization read
+     *        evicted tiles one at a time without loading them, getStorages
+     *        throws while tiles are evicted. Inserting may invalidate pointers
+     *        to bundles.
+     * @param bytes     the memory budget
+     * @param directory the directory for evicted tiles
+     * @param tile_size the number of bundles per tile and dimension
+     */
+    inline void setMemoryBudget(const std::size_t  bytes,
+                                const std::string &directory,
+                                const std::size_t  tile_size = 32)
+    {
+        this->enableBudget(bytes, directory, tile_size);
+    }
+
+    using base_t::restoreEvictedTiles;
+
+    /**
+     * @brief Look up a bundle, the const overloads never allocate, so that
+     *        published maps can be read by several threads.
+     * @return the bundle, nullptr if it is not allocated
+     */
     inline const distribution_bundle_t* getDistributionBundle(const index_t &bi) const
     {
-        return this->getAllocate(bi);
+        return this->getBundle(bi);
     }
 
     inline distribution_bundle_t* getDistributionBundle(const index_t &bi)
@@ -251,34 +280,270 @@ public:
     inline const distribution_bundle_t* getDistributionBundle(const point_t &p) const
     {
         const index_t bi = this->toBundleIndex(p);
-        return this->getAllocate(bi);
+        return this->getBundle(bi);
     }
 
     inline const distribution_bundle_t* get(const point_t &p) const
     {
         const index_t bi = this->toBundleIndex(p);
-        return this->bundle_storage_->get(bi);
+        return this->getBundle(bi);
     }
 
     inline const distribution_bundle_t* get(const index_t &bi) const
     {
-        return this->bundle_storage_->get(bi);
+        return this->getBundle(bi);
+    }
+};
+template <std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class backend_t,
+          template <typename, typename, typename...> class dynamic_backend_t>
+class EIGEN_ALIGN16 GenericMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t> :
+        public AbstractMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t>
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using allocator_t   = Eigen::aligned_allocator<GenericMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t>>;
+
+    using ConstPtr      = std::shared_ptr<const GenericMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t>>;
+    using Ptr           = std::shared_ptr<GenericMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t>>;
+
+    using base_t = AbstractMap<tags::rolling_map, Dim, data_t, T, backend_t, dynamic_backend_t>;
+    using typename base_t::pose_t;
+    using typename base_t::transform_t;
+    using typename base_t::point_t;
+    using typename base_t::pointcloud_t;
+    using typename base_t::index_t;
+    using typename base_t::index_list_t;
+    using typename base_t::distribution_t;
+    using typename base_t::distribution_storage_t;
+    using typename base_t::distribution_storage_ptr_t;
+    using typename base_t::distribution_storage_array_t;
+    using typename base_t::distribution_bundle_t;
+    using typename base_t::distribution_const_bundle_t;
+    using typename base_t::distribution_bundle_storage_t;
+    using typename base_t::distribution_bundle_storage_ptr_t;
+    using typename base_t::dynamic_distribution_storage_t;
+
+    using size_t        = std::array<std::size_t,Dim>;
+    using size_m_t      = std::array<T,Dim>;
+
+    /// called for every bundle leaving the window, before it is discarded
+    using eviction_callback_t = std::function<void(const index_t &, const distribution_bundle_t &)>;
+
+    /**
+     * @brief Map covering a window of size * 2 bundles, which can be moved
+     *        along with the robot. Storage is allocated once, moving the
+     *        window only touches the bundles leaving it.
+     */
+    inline GenericMap(const pose_t  &origin,
+                      const T       &resolution,
+                      const size_t  &size,
+                      const index_t &min_bundle_index) :
+        base_t(origin, resolution,
+               min_bundle_index,
+               (min_bundle_index + cslibs_math::common::cast<int>(size * 2ul) - 1)),
+        size_(size),
+        size_m_(cslibs_math::common::cast<T>(size + 1ul) * resolution)
+    {
+        /// the window may start at an odd bundle index, so every bin spans size + 1 distributions
+        for(std::size_t i=0 ; i<this->bin_count; ++i)
+            this->storage_[i]->template set<cis::option::tags::array_size>(size + 1ul);
+        this->bundle_storage_->template set<cis::option::tags::array_size>(size * 2ul);
+    }
+
+    inline GenericMap(const GenericMap &other) :
+        base_t(other),
+        size_(other.size_),
+        size_m_(other.size_m_),
+        eviction_callback_(other.eviction_callback_)
+    {
+    }
+
+    inline GenericMap(GenericMap &&other) :
+        base_t(std::move(other)),
+        size_(other.size_),
+        size_m_(other.size_m_),
+        eviction_callback_(std::move(other.eviction_callback_))
+    {
+    }
+
+    inline GenericMap(const GenericMap &other,
+                      const tags::snapshot &s) :
+        base_t(other, s),
+        size_(other.size_),
+        size_m_(other.size_m_)
+    {
+    }
+
+    inline void setEvictionCallback(const eviction_callback_t &callback)
+    {
+        eviction_callback_ = callback;
+    }
+
+    /**
+     * @brief Center the window on a point, given in world coordinates.
+     * @param p_w the new center
+     */
+    inline void moveTo(const point_t &p_w)
+    {
+        const index_t bi = this->toBundleIndex(p_w);
+        index_t min_bundle_index;
+        for (std::size_t i=0; i<Dim; ++i)
+            min_bundle_index[i] = bi[i] - static_cast<int>(size_[i]);
+        moveTo(min_bundle_index);
+    }
+
+    /**
+     * @brief Move the window to start at min_bundle_index. Bundles leaving the
+     *        window are handed to the eviction callback and removed, which is
+     *        linear in the number of shifted cells. While snapshots share the
+     *        storages, e.g. under ConcurrentMap, the removals are recorded in
+     *        the copy-on-write overlay, the snapshots keep the old window.
+     * @param min_bundle_index the new minimum bundle index
+     */
+    inline void moveTo(const index_t &min_bundle_index)
+    {
+        if (min_bundle_index == this->min_bundle_index_)
+            return;
+
+        this->compact();
+
+        /// one slab per dimension, later slabs only span the already moved dimensions
+        for (std::size_t d=0; d<Dim; ++d) {
+            const int min = min_bundle_index[d];
+            const int max = min + 2 * static_cast<int>(size_[d]) - 1;
+            if (min == this->min_bundle_index_[d])
+                continue;
+
+            forEachLeaving(this->min_bundle_index_, this->max_bundle_index_, d, min, max,
+                           [this](const index_t &bi) {
+                const distribution_bundle_t *bundle = this->findBundle(bi);
+                if (!bundle)
+                    return;
+                if (eviction_callback_)
+                    eviction_callback_(bi, *bundle);
+                this->removeBundle(bi);
+            });
+
+            for (std::size_t i=0; i<this->bin_count; ++i) {
+                forEachLeaving(toDistributionIndex(i, this->min_bundle_index_),
+                               toDistributionIndex(i, this->max_bundle_index_),
+                               d,
+                               toDistributionIndex(i, d, min),
+                               toDistributionIndex(i, d, max),
+                               [this, i](const index_t &index) {
+                    if (this->findDistribution(i, index))
+                        this->removeDistribution(i, index);
+                });
+            }
+
+            this->min_bundle_index_[d] = min;
+            this->max_bundle_index_[d] = max;
+        }
+    }
+
+    /**
+     * @brief Look up a bundle, the const overloads never allocate, so that
+     *        published maps can be read by several threads.
+     * @return the bundle, nullptr if it is not allocated or outside the window
+     */
+    inline const distribution_bundle_t* getDistributionBundle(const index_t &bi) const
+    {
+        return this->valid(bi) ? this->getBundle(bi) : nullptr;
+    }
+
+    inline distribution_bundle_t* getDistributionBundle(const index_t &bi)
+    {
+        return this->getAllocate(bi);
+    }
+
+    inline const distribution_bundle_t* getDistributionBundle(const point_t &p) const
+    {
+        index_t bi;
+        if (!this->toBundleIndex(p, bi))
+            return nullptr;
+
+        return this->getBundle(bi);
+    }
+
+    inline const distribution_bundle_t* get(const point_t &p) const
+    {
+        index_t bi;
+        if (!this->toBundleIndex(p, bi))
+            return nullptr;
+
+        return this->getBundle(bi);
+    }
+
+    inline const distribution_bundle_t* get(const index_t &bi) const
+    {
+        return this->valid(bi) ? this->getBundle(bi) : nullptr;
+    }
+
+    inline size_m_t getSizeM() const
+    {
+        return size_m_;
+    }
+
+    inline size_t getSize() const
+    {
+        return size_;
+    }
+
+    inline size_t getBundleSize() const
+    {
+        return size_ * 2ul;
     }
 
 protected:
-    virtual inline void updateIndices(const index_t &chunk_index) const override
+    const size_t        size_;
+    const size_m_t      size_m_;
+    eviction_callback_t eviction_callback_;
+
+    /**
+     * @brief Index of the distribution in bin i a bundle index refers to
+     *        along dimension d, see utility::generate_indices.
+     */
+    inline static int toDistributionIndex(const std::size_t i,
+                                          const std::size_t d,
+                                          const int bi)
     {
-        this->min_bundle_index_ = std::min(this->min_bundle_index_, chunk_index);
-        this->max_bundle_index_ = std::max(this->max_bundle_index_, chunk_index);
+        return cslibs_math::common::div(bi, 2) + (((i >> d) & 1ul) ? cslibs_math::common::mod(bi, 2) : 0);
     }
 
-    virtual inline bool valid(const index_t &index) const override
+    inline static index_t toDistributionIndex(const std::size_t i,
+                                              const index_t &bi)
     {
-        return true;
+        index_t index;
+        for (std::size_t d=0; d<Dim; ++d)
+            index[d] = toDistributionIndex(i, d, bi[d]);
+        return index;
     }
 
-    virtual inline bool expandDistribution(const distribution_t* d) const = 0;
+    /**
+     * @brief Visit all indices in [min, max] which are outside of [keep_min, keep_max]
+     *        along dimension d.
+     */
+    template <typename Fn>
+    inline static void forEachLeaving(const index_t &min,
+                                      const index_t &max,
+                                      const std::size_t d,
+                                      const int keep_min,
+                                      const int keep_max,
+                                      const Fn &function)
+    {
+        index_t lower_max = max;
+        lower_max[d] = std::min(max[d], keep_min - 1);
+        base_t::forEach(min, lower_max, function);
+
+        index_t upper_min = min;
+        upper_min[d] = std::max(min[d], keep_max + 1);
+        base_t::forEach(upper_min, max, function);
+    }
 };
+
 }
 }
 
@@ -3,6 +3,7 @@
 
 #include <cslibs_ndt/map/generic_map.hpp>
 #include <cslibs_ndt/common/distribution.hpp>
+#include <cslibs_ndt/common/transform.hpp>
 
 namespace cslibs_ndt {
 namespace map {
@@ -27,6 +28,7 @@ public:
     using typename base_t::point_t;
     using typename base_t::pointcloud_t;
     using typename base_t::index_t;
+    using typename base_t::point_list_t;
     using typename base_t::index_list_t;
     using typename base_t::distribution_t;
     using typename base_t::distribution_storage_t;
@@ -38,9 +40,43 @@ public:
     using typename base_t::distribution_bundle_storage_ptr_t;
     using typename base_t::dynamic_distribution_storage_t;
 
+    /**
+     * @brief The samples one scan added to the map, summed up per bundle.
+     *        Allows to remove the scan again, e.g. to re-insert it under a
+     *        corrected pose after a loop closure.
+     */
+    struct contribution_t {
+        using entry_t = std::pair<index_t, typename distribution_t::distribution_t>;
+        std::vector<entry_t, Eigen::aligned_allocator<entry_t>> occupied;
+
+        inline void clear()
+        {
+            occupied.clear();
+        }
+
+        inline bool empty() const
+        {
+            return occupied.empty();
+        }
+    };
+
     using base_t::GenericMap;
     inline Map(const base_t &other) : base_t(other) { }
-    inline Map(base_t &&other) : base_t(other) { }
+    inline Map(base_t &&other) : base_t(std::move(other)) { }
+
+    /**
+     * @brief Get a read consistent copy of the map, the storages are shared
+     *        copy-on-write, so only bundles changed later on are copied.
+     *        The distributions are finalized first, so that reading the
+     *        snapshot and the map from different threads does not race.
+     * @return the snapshot
+     */
+    inline Ptr snapshot() const
+    {
+        this->finalize();
+        this->compact();
+        return Ptr(new Map(*this, tags::snapshot()));
+    }
 
     inline void insert(const point_t &p)
     {
@@ -49,6 +85,8 @@ public:
             return;
 
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->data().add(p);
     }
@@ -56,21 +94,85 @@ public:
     inline void insert(const typename pointcloud_t::ConstPtr &points,
                        const pose_t &points_origin = pose_t())
     {
-        dynamic_distribution_storage_t storage;
-        for (const auto &p : *points) {
-            const point_t pm = points_origin * p;
-            if (pm.isNormal()) {
-                const index_t &bi = this->toBundleIndex(pm);
-                distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->data().add(pm);
-            }
-        }
+        insertScan(points, points_origin);
+    }
 
-        storage.traverse([this](const index_t& bi, const distribution_t &d) {
-            distribution_bundle_t *bundle = this->getAllocate(bi);
-            const typename distribution_t::distribution_t &dist = d.data();
+    /**
+     * @brief Same as insert, additionally records the samples of the scan, so
+     *        that it can be removed later on.
+     * @param contribution  the samples of the scan, replaced
+     */
+    inline void insertRecorded(const typename pointcloud_t::ConstPtr &points,
+                               const pose_t &points_origin,
+                               contribution_t &contribution)
+    {
+        contribution.clear();
+        insertScan(points, points_origin, &contribution);
+    }
+
+    /**
+     * @brief Subtract a scan recorded by insertRecorded from the map. Only the
+     *        bundles the scan touched are updated, they stay allocated.
+     */
+    inline void remove(const contribution_t &contribution)
+    {
+        for (const auto &o : contribution.occupied) {
+            distribution_bundle_t *bundle = this->getAllocate(o.first);
+            if (!bundle)
+                continue;
             for (std::size_t i=0; i<this->bin_count; ++i)
-                bundle->at(i)->data() += dist;
+                bundle->at(i)->remove(o.second);
+        }
+    }
+
+    /**
+     * @brief Move a recorded scan to a corrected pose, instead of rebuilding
+     *        the map from all scans.
+     * @param points            the scan as it was inserted
+     * @param corrected_origin  the new pose of the scan
+     * @param contribution      the recorded samples, replaced by the new ones
+     */
+    inline void reinsert(const typename pointcloud_t::ConstPtr &points,
+                         const pose_t &corrected_origin,
+                         contribution_t &contribution)
+    {
+        remove(contribution);
+        insertRecorded(points, corrected_origin, contribution);
+    }
+
+    /**
+     * @brief Add the distributions of another map, e.g. of a submap, whose
+     *        world frame has the pose w_T_other in the world frame of this map.
+     * @param other     the map to add, may have another origin and resolution
+     * @param w_T_other pose of the world frame of other
+     * @param pool      optional thread pool to merge with
+     */
+    inline void insert(const Map &other,
+                       const pose_t &w_T_other = pose_t(),
+                       utility::ThreadPool *pool = nullptr)
+    {
+        const Eigen::Matrix<T,Dim,Dim> R = w_T_other.getEigenRotation();
+        const Eigen::Matrix<T,Dim,1>   t = w_T_other.translation().data();
+        auto mean = [](const distribution_t &d, point_t &p) {
+            p = point_t(d.data().getMean());
+            return d.data().getN() > 0;
+        };
+        this->regrid(other, w_T_other, pool, mean, [&R, &t](distribution_t &target, const distribution_t &source) {
+            target.data() += cslibs_ndt::transform(source.data(), R, t);
+        });
+    }
+
+    /**
+     * @brief Undo insert(other) of a map on the same grid, e.g. to take a
+     *        layer out of a composed map. Bundles stay allocated.
+     * @param other     the map to subtract, with the origin and resolution of this map
+     * @param pool      optional thread pool to subtract with
+     */
+    inline void remove(const Map &other,
+                       utility::ThreadPool *pool = nullptr)
+    {
+        this->unmerge(other, pool, [](distribution_t &target, const distribution_t &source) {
+            target.remove(source.data());
         });
     }
 
@@ -85,7 +187,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle  = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle  = this->getBundle(bi);
         auto evaluate = [this, &p, &bundle]() {
             T retval = T();
             for (std::size_t i=0; i<this->bin_count; ++i)
@@ -106,7 +208,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle = this->getBundle(bi);
         auto evaluate = [this, &p, &bundle]() {
             T retval = T();
             for (std::size_t i=0; i<this->bin_count; ++i)
@@ -116,8 +218,43 @@ public:
         return bundle ? evaluate() : T();
     }
 
+    inline void allocatePartiallyAllocatedBundles(utility::ThreadPool *pool = nullptr)
+    {
+        base_t::allocatePartiallyAllocatedBundles(&Map::expandDistribution, pool);
+    }
+
 protected:
-    virtual inline bool expandDistribution(const distribution_t* d) const override
+    /**
+     * @brief Bin the scan into scan-local distributions first, then add them
+     *        once per bundle.
+     * @param contribution  optional, receives the added distributions
+     */
+    inline void insertScan(const typename pointcloud_t::ConstPtr &points,
+                           const pose_t &points_origin,
+                           contribution_t *contribution = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->data().add(points_w[k]);
+        }
+
+        storage.traverse([this, contribution](const index_t& bi, const distribution_t &d) {
+            distribution_bundle_t *bundle = this->getAllocate(bi);
+            if (!bundle)
+                return;
+            const typename distribution_t::distribution_t &dist = d.data();
+            for (std::size_t i=0; i<this->bin_count; ++i)
+                bundle->at(i)->data() += dist;
+            if (contribution)
+                contribution->occupied.emplace_back(bi, dist);
+        });
+    }
+
+    inline static bool expandDistribution(const distribution_t* d)
     {
         return d && d->data().getN() >= 3;
     }
@@ -3,6 +3,7 @@
 
 //#include <cslibs_ndt/map/generic_map.hpp>
 #include <cslibs_ndt/common/occupancy_distribution.hpp>
+#include <cslibs_ndt/common/transform.hpp>
 
 namespace cslibs_ndt {
 namespace map {
@@ -27,6 +28,8 @@ public:
     using typename base_t::point_t;
     using typename base_t::pointcloud_t;
     using typename base_t::index_t;
+    using typename base_t::point_list_t;
+    using typename base_t::ray_table_t;
     using typename base_t::index_list_t;
     using typename base_t::distribution_t;
     using typename base_t::distribution_storage_t;
@@ -40,10 +43,46 @@ public:
 
     using inverse_sensor_model_t = cslibs_gridmaps::utility::InverseModel<T>;
     using default_iterator_t     = typename map::traits<Dim,T>::default_iterator_t;
+    using dda_iterator_t         = typename map::traits<Dim,T>::dda_iterator_t;
+
+    /**
+     * @brief The updates one scan applied to the map, summed up per bundle.
+     *        Allows to remove the scan again, e.g. to re-insert it under a
+     *        corrected pose after a loop closure.
+     */
+    struct contribution_t {
+        std::vector<std::pair<index_t, std::size_t>>                                    free;
+        std::vector<std::pair<index_t, typename distribution_t::distribution_ptr_t>>    occupied;
+
+        inline void clear()
+        {
+            free.clear();
+            occupied.clear();
+        }
+
+        inline bool empty() const
+        {
+            return free.empty() && occupied.empty();
+        }
+    };
 
     using base_t::GenericMap;
     inline Map(const base_t &other) : base_t(other) { }
-    inline Map(base_t &&other) : base_t(other) { }
+    inline Map(base_t &&other) : base_t(std::move(other)) { }
+
+    /**
+     * @brief Get a read consistent copy of the map, the storages are shared
+     *        copy-on-write, so only bundles changed later on are copied.
+     *        The distributions are finalized first, so that reading the
+     *        snapshot and the map from different threads does not race.
+     * @return the snapshot
+     */
+    inline Ptr snapshot() const
+    {
+        this->finalize();
+        this->compact();
+        return Ptr(new Map(*this, tags::snapshot()));
+    }
 
     template <typename line_iterator_t = default_iterator_t>
     inline void insert(const point_t &start_p,
@@ -64,13 +103,12 @@ public:
                        const pose_t &points_origin = pose_t())
     {
         dynamic_distribution_storage_t storage;
-        for (const auto &p : *points) {
-            const point_t pm = points_origin * p;
-            if (pm.isNormal()) {
-                const index_t &bi = this->toBundleIndex(pm);
-                distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->updateOccupied(pm);
-            }
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
         }
 
         const point_t start_p = this->m_T_w_ * points_origin.translation();
@@ -88,6 +126,259 @@ public:
         });
     }
 
+    /**
+     * @brief Same result as insert, but free space is first counted per bundle
+     *        for the whole scan and then written once per bundle, instead of
+     *        once per ray. Saves most map accesses close to the sensor.
+     * @param pool  optional thread pool to cast the rays with
+     */
+    template <typename line_iterator_t = default_iterator_t>
+    inline void insertDeduplicated(const typename pointcloud_t::ConstPtr &points,
+                                   const pose_t &points_origin = pose_t(),
+                                   utility::ThreadPool *pool = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
+        }
+
+        insertStorage<line_iterator_t>(storage, points_origin, pool);
+    }
+
+    /**
+     * @brief Add the free and occupied updates of another map, e.g. of a
+     *        submap, whose world frame has the pose w_T_other in the world
+     *        frame of this map.
+     * @param other     the map to add, may have another origin and resolution
+     * @param w_T_other pose of the world frame of other
+     * @param pool      optional thread pool to merge with
+     */
+    inline void insert(const Map &other,
+                       const pose_t &w_T_other = pose_t(),
+                       utility::ThreadPool *pool = nullptr)
+    {
+        using occupied_t = typename distribution_t::distribution_t;
+        const Eigen::Matrix<T,Dim,Dim> R = w_T_other.getEigenRotation();
+        const Eigen::Matrix<T,Dim,1>   t = w_T_other.translation().data();
+        auto mean = [](const distribution_t &d, point_t &p) {
+            if (!d.getDistribution())
+                return false;
+            p = point_t(d.getDistribution()->getMean());
+            return true;
+        };
+        this->regrid(other, w_T_other, pool, mean, [&R, &t](distribution_t &target, const distribution_t &source) {
+            target.updateFree(source.numFree());
+            if (source.getDistribution())
+                target.updateOccupied(typename distribution_t::distribution_ptr_t(
+                                          new occupied_t(cslibs_ndt::transform(*source.getDistribution(), R, t))));
+        });
+    }
+
+    /**
+     * @brief Undo insert(other) of a map on the same grid, e.g. to take a
+     *        layer out of a composed map. Bundles stay allocated.
+     * @param other     the map to subtract, with the origin and resolution of this map
+     * @param pool      optional thread pool to subtract with
+     */
+    inline void remove(const Map &other,
+                       utility::ThreadPool *pool = nullptr)
+    {
+        this->unmerge(other, pool, [](distribution_t &target, const distribution_t &source) {
+            target.removeFree(source.numFree());
+            target.removeOccupied(source.getDistribution());
+        });
+    }
+
+    /**
+     * @brief Same as insertDeduplicated, additionally records the updates of
+     *        the scan, so that it can be removed later on.
+     * @param contribution  the updates of the scan, replaced
+     */
+    template <typename line_iterator_t = default_iterator_t>
+    inline void insertRecorded(const typename pointcloud_t::ConstPtr &points,
+                               const pose_t &points_origin,
+                               contribution_t &contribution,
+                               utility::ThreadPool *pool = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
+        }
+
+        contribution.clear();
+        insertStorage<line_iterator_t>(storage, points_origin, pool, &contribution);
+    }
+
+    /**
+     * @brief Subtract a scan recorded by insertRecorded from the map. Only the
+     *        bundles the scan touched are updated, they stay allocated.
+     */
+    inline void remove(const contribution_t &contribution)
+    {
+        for (const auto &f : contribution.free) {
+            distribution_bundle_t *bundle = this->getAllocate(f.first);
+            if (!bundle)
+                continue;
+            for (std::size_t i=0; i<this->bin_count; ++i)
+                bundle->at(i)->removeFree(f.second);
+        }
+        for (const auto &o : contribution.occupied) {
+            distribution_bundle_t *bundle = this->getAllocate(o.first);
+            if (!bundle)
+                continue;
+            for (std::size_t i=0; i<this->bin_count; ++i)
+                bundle->at(i)->removeOccupied(o.second);
+        }
+    }
+
+    /**
+     * @brief Move a recorded scan to a corrected pose, instead of rebuilding
+     *        the map from all scans.
+     * @param points            the scan as it was inserted
+     * @param corrected_origin  the new pose of the scan
+     * @param contribution      the recorded updates, replaced by the new ones
+     */
+    template <typename line_iterator_t = default_iterator_t>
+    inline void reinsert(const typename pointcloud_t::ConstPtr &points,
+                         const pose_t &corrected_origin,
+                         contribution_t &contribution,
+                         utility::ThreadPool *pool = nullptr)
+    {
+        remove(contribution);
+        insertRecorded<line_iterator_t>(points, corrected_origin, contribution, pool);
+    }
+
+    /**
+     * @brief Insert a range scan, e.g. a laser scan or an organized range
+     *        image, given as one range per beam of rays. No pointcloud is
+     *        built and neighbouring beams ending in the same bundle share one
+     *        lookup. Free space is carved per ray as in insertDeduplicated,
+     *        the beam order gains nothing there, because rays ending in the
+     *        same bundle are merged before carving anyway.
+     * @param rays          beam directions of the sensor
+     * @param ranges        one range per beam
+     * @param points_origin the pose the scan was taken at
+     * @param range_min     minimum valid range
+     * @param range_max     maximum valid range
+     * @param pool          optional thread pool to cast the rays with
+     */
+    template <typename line_iterator_t = default_iterator_t, typename scalar_t = T>
+    inline void insertRanges(const ray_table_t &rays,
+                             const scalar_t *ranges,
+                             const pose_t &points_origin,
+                             const T range_min,
+                             const T range_max,
+                             utility::ThreadPool *pool = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(rays, ranges, points_origin, range_min, range_max, points_w, indices);
+        distribution_t *d = nullptr;
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            if (k == 0 || indices[k] != indices[k-1]) {
+                d = storage.get(indices[k]);
+                d = d ? d : &storage.insert(indices[k], distribution_t());
+            }
+            d->updateOccupied(points_w[k]);
+        }
+
+        insertStorage<line_iterator_t>(storage, points_origin, pool);
+    }
+
+    /**
+     * @brief Insert a planar laser scan, 2D only. Instead of casting one ray
+     *        per beam, the polygon of the sensor origin and the end points, in
+     *        the order of the scan, is filled once with scanlines at bundle
+     *        resolution. Each bundle with its center inside of the polygon gets
+     *        exactly one free update, bundles containing end points are
+     *        updated as occupied only. Gaps in the scan are closed by the
+     *        edge between the neighbouring end points.
+     */
+    template <std::size_t D = Dim,
+              typename = typename std::enable_if<D == 2>::type>
+    inline void insertPolygon(const typename pointcloud_t::ConstPtr &points,
+                              const pose_t &points_origin = pose_t())
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
+        }
+        if (points_w.empty())
+            return;
+
+        /// polygon vertices in bundle coordinates, the origin closes it
+        std::vector<std::array<T,2>> polygon;
+        polygon.reserve(points_w.size() + 1ul);
+        auto to_bundle_coordinates = [this](const point_t &p_w) {
+            const point_t p_m = this->m_T_w_ * p_w;
+            return std::array<T,2>{{p_m(0) * this->bundle_resolution_inv_,
+                                     p_m(1) * this->bundle_resolution_inv_}};
+        };
+        polygon.emplace_back(to_bundle_coordinates(points_origin.translation()));
+        for (const point_t &p_w : points_w)
+            polygon.emplace_back(to_bundle_coordinates(p_w));
+
+        T min_y = polygon.front()[1], max_y = polygon.front()[1];
+        for (const std::array<T,2> &v : polygon) {
+            min_y = std::min(min_y, v[1]);
+            max_y = std::max(max_y, v[1]);
+        }
+
+        /// crossings of each edge with the centers of the rows it spans
+        const int row_min = static_cast<int>(std::floor(min_y));
+        std::vector<std::vector<T>> rows(static_cast<std::size_t>(static_cast<int>(std::floor(max_y)) - row_min + 1));
+        for (std::size_t k=0; k<polygon.size(); ++k) {
+            const std::array<T,2> &a = polygon[k];
+            const std::array<T,2> &b = polygon[(k + 1) % polygon.size()];
+            if (a[1] == b[1])
+                continue;
+
+            const T   dxdy  = (b[0] - a[0]) / (b[1] - a[1]);
+            const T   lo    = std::min(a[1], b[1]);
+            const T   hi    = std::max(a[1], b[1]);
+            for (int j = static_cast<int>(std::ceil(lo - T(0.5))); j + T(0.5) < hi; ++j)
+                rows[static_cast<std::size_t>(j - row_min)].emplace_back(a[0] + (j + T(0.5) - a[1]) * dxdy);
+        }
+
+        for (std::size_t r=0; r<rows.size(); ++r) {
+            std::vector<T> &xs = rows[r];
+            std::sort(xs.begin(), xs.end());
+            index_t bi{{0, static_cast<int>(r) + row_min}};
+            for (std::size_t k=0; k+1<xs.size(); k+=2) {
+                const int end = static_cast<int>(std::ceil(xs[k+1] - T(0.5)));
+                for (bi[0] = static_cast<int>(std::ceil(xs[k] - T(0.5))); bi[0]<end; ++bi[0])
+                    if (!storage.get(bi))
+                        updateFree(bi);
+            }
+        }
+
+        storage.traverse([this](const index_t& bi, const distribution_t &d) {
+            if (d.getDistribution())
+                updateOccupied(bi, d.getDistribution());
+        });
+    }
+
+    /**
+     * @brief Insert with a visibility check of every ray against the map as
+     *        it was before this scan. The occupancy of neighbouring bundles is
+     *        only read through findDistributions, each bundle at most once per
+     *        scan, so that no bundles are allocated in unobserved space. All updates are applied after
+     *        the scan was evaluated, hence the result is independent of the
+     *        order of the rays.
+     */
     template <typename line_iterator_t = default_iterator_t>
     inline void insertVisible(const typename pointcloud_t::ConstPtr &points,
                               const pose_t &points_origin,
@@ -100,11 +391,18 @@ public:
         }
 
         const index_t start_bi = this->toBundleIndex(points_origin.translation());
-        auto occupancy = [this, &ivm](const index_t &bi) {
-            distribution_bundle_t *bundle = this->getAllocate(bi);
+        const T unknown = distribution_t().getOccupancy(ivm);
+        std::unordered_map<index_t, T, utility::bundle_hash<Dim>> memo;
+        auto occupancy = [this, &ivm, &unknown, &memo](const index_t &bi) {
+            const auto it = memo.find(bi);
+            if (it != memo.end())
+                return it->second;
+
+            const std::array<const distribution_t*, base_t::bin_count> bundle = this->findDistributions(bi);
             T retval = T();
             for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * bundle->at(i)->getOccupancy(ivm);
+                retval += this->div_count * (bundle.at(i) ? bundle.at(i)->getOccupancy(ivm) : unknown);
+            memo.emplace(bi, retval);
             return retval;
         };
         auto current_visibility = [this, &start_bi, &ivm_visibility, &occupancy](const index_t &bi) {
@@ -125,17 +423,18 @@ public:
         };
 
         dynamic_distribution_storage_t storage;
-        for (const auto &p : *points) {
-            const point_t pm = points_origin * p;
-            if (pm.isNormal()) {
-                const index_t &bi = this->toBundleIndex(pm);
-                distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->updateOccupied(pm);
-            }
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
         }
 
         const point_t start_p = this->m_T_w_ * points_origin.translation();
-        storage.traverse([this, &ivm_visibility, &start_p, &current_visibility](const index_t& bi, const distribution_t &d) {
+        std::unordered_map<index_t, std::size_t, utility::bundle_hash<Dim>> free;
+        std::vector<std::pair<index_t, typename distribution_t::distribution_ptr_t>> occupied;
+        storage.traverse([this, &ivm_visibility, &start_p, &current_visibility, &free, &occupied](const index_t& bi, const distribution_t &d) {
             if (!d.getDistribution())
                 return;
 
@@ -149,13 +448,18 @@ public:
                 if ((visibility *= current_visibility(bit)) < ivm_visibility->getProbPrior())
                     return;
 
-                updateFree(bit, n);
+                free[bit] += n;
                 ++ it;
             }
 
             if ((visibility *= current_visibility(bi)) >= ivm_visibility->getProbPrior())
-                updateOccupied(bi, d.getDistribution());
+                occupied.emplace_back(bi, d.getDistribution());
         });
+
+        for (const auto &f : free)
+            updateFree(f.first, f.second);
+        for (const auto &o : occupied)
+            updateOccupied(o.first, o.second);
     }
 
     template <typename line_iterator_t = default_iterator_t>
@@ -178,7 +482,7 @@ public:
         line_iterator_t it(start_index, end_index);
 
         auto occupied = [this, &ivm, &occupied_threshold](const index_t &bi) {
-            distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+            distribution_bundle_t *bundle = this->getBundle(bi);
             auto occupancy = [this, &bundle, &ivm]() {
                 T retval = T();
                 for (std::size_t i=0; i<this->bin_count; ++i)
@@ -221,7 +525,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle = this->getBundle(bi);
 
         auto sample = [&p, &ivm] (const distribution_t *d) {
             auto do_sample = [&p, &ivm, &d]() {
@@ -257,7 +561,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle  = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle  = this->getBundle(bi);
 
         auto sample = [&p, &ivm] (const distribution_t *d) {
             auto do_sample = [&p, &ivm, &d]() {
@@ -277,8 +581,42 @@ public:
         return bundle ? evaluate() : T();
     }
 
+    inline void allocatePartiallyAllocatedBundles(utility::ThreadPool *pool = nullptr)
+    {
+        base_t::allocatePartiallyAllocatedBundles(&Map::expandDistribution, pool);
+    }
+
 protected:
-    virtual inline bool expandDistribution(const distribution_t* d) const override
+    /**
+     * @brief Apply the scan-local occupied distributions of storage and carve
+     *        the free space between points_origin and their means.
+     * @param contribution  optional, receives the applied updates
+     */
+    template <typename line_iterator_t>
+    inline void insertStorage(dynamic_distribution_storage_t &storage,
+                              const pose_t &points_origin,
+                              utility::ThreadPool *pool,
+                              contribution_t *contribution = nullptr) const
+    {
+        std::vector<std::pair<point_t,std::size_t>> rays;
+        storage.traverse([this, &rays, contribution](const index_t& bi, const distribution_t &d) {
+            if (!d.getDistribution())
+                return;
+            updateOccupied(bi, d.getDistribution());
+            rays.emplace_back(this->m_T_w_ * point_t(d.getDistribution()->getMean()), d.numOccupied());
+            if (contribution)
+                contribution->occupied.emplace_back(bi, d.getDistribution());
+        });
+
+        const point_t start_p = this->m_T_w_ * points_origin.translation();
+        base_t::template carve<line_iterator_t>(start_p, rays, pool, [this, contribution](const index_t &bi, const std::size_t n) {
+            updateFree(bi, n);
+            if (contribution)
+                contribution->free.emplace_back(bi, n);
+        });
+    }
+
+    inline static bool expandDistribution(const distribution_t* d)
     {
         return d && d->getDistribution() && d->getDistribution()->getN() >= 3;
     }
@@ -286,6 +624,8 @@ protected:
     inline void updateFree(const index_t &bi) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateFree();
     }
@@ -294,6 +634,8 @@ protected:
                            const std::size_t &n) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateFree(n);
     }
@@ -302,6 +644,8 @@ protected:
                                const point_t &p) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateOccupied(p);
     }
@@ -310,6 +654,8 @@ protected:
                                const typename distribution_t::distribution_ptr_t &d) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateOccupied(d);
     }
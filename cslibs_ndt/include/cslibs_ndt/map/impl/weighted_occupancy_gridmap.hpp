@@ -27,6 +27,8 @@ public:
     using typename base_t::point_t;
     using typename base_t::pointcloud_t;
     using typename base_t::index_t;
+    using typename base_t::point_list_t;
+    using typename base_t::ray_table_t;
     using typename base_t::index_list_t;
     using typename base_t::distribution_t;
     using typename base_t::distribution_storage_t;
@@ -40,10 +42,25 @@ public:
 
     using inverse_sensor_model_t = cslibs_gridmaps::utility::InverseModel<T>;
     using default_iterator_t     = typename map::traits<Dim,T>::default_iterator_t;
+    using dda_iterator_t         = typename map::traits<Dim,T>::dda_iterator_t;
 
     using base_t::GenericMap;
     inline Map(const base_t &other) : base_t(other) { }
-    inline Map(base_t &&other) : base_t(other) { }
+    inline Map(base_t &&other) : base_t(std::move(other)) { }
+
+    /**
+     * @brief Get a read consistent copy of the map, the storages are shared
+     *        copy-on-write, so only bundles changed later on are copied.
+     *        The distributions are finalized first, so that reading the
+     *        snapshot and the map from different threads does not race.
+     * @return the snapshot
+     */
+    inline Ptr snapshot() const
+    {
+        this->finalize();
+        this->compact();
+        return Ptr(new Map(*this, tags::snapshot()));
+    }
 
     template <typename line_iterator_t = default_iterator_t>
     inline void insert(const point_t &start_p,
@@ -64,13 +81,12 @@ public:
                        const pose_t &points_origin = pose_t())
     {
         dynamic_distribution_storage_t storage;
-        for (const auto &p : *points) {
-            const point_t pm = points_origin * p;
-            if (pm.isNormal()) {
-                const index_t &bi = this->toBundleIndex(pm);
-                distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->updateOccupied(pm);
-            }
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
         }
 
         const point_t start_p = this->m_T_w_ * points_origin.translation();
@@ -88,6 +104,71 @@ public:
         });
     }
 
+    /**
+     * @brief Same result as insert, up to rounding of the summed weights, but
+     *        free space is first summed up per bundle for the whole scan and
+     *        then written once per bundle, instead of once per ray.
+     * @param pool  optional thread pool to cast the rays with
+     */
+    template <typename line_iterator_t = default_iterator_t>
+    inline void insertDeduplicated(const typename cslibs_math::linear::Pointcloud<point_t>::ConstPtr &points,
+                                   const pose_t &points_origin = pose_t(),
+                                   utility::ThreadPool *pool = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, points_origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
+        }
+
+        insertStorage<line_iterator_t>(storage, points_origin, pool);
+    }
+
+    /**
+     * @brief Insert a range scan, e.g. a laser scan or an organized range
+     *        image, given as one range per beam of rays. No pointcloud is
+     *        built and neighbouring beams ending in the same bundle share one
+     *        lookup. Free space is carved per ray as in insertDeduplicated,
+     *        the beam order gains nothing there, because rays ending in the
+     *        same bundle are merged before carving anyway.
+     * @param rays          beam directions of the sensor
+     * @param ranges        one range per beam
+     * @param points_origin the pose the scan was taken at
+     * @param range_min     minimum valid range
+     * @param range_max     maximum valid range
+     * @param pool          optional thread pool to cast the rays with
+     */
+    template <typename line_iterator_t = default_iterator_t, typename scalar_t = T>
+    inline void insertRanges(const ray_table_t &rays,
+                             const scalar_t *ranges,
+                             const pose_t &points_origin,
+                             const T range_min,
+                             const T range_max,
+                             utility::ThreadPool *pool = nullptr)
+    {
+        dynamic_distribution_storage_t storage;
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(rays, ranges, points_origin, range_min, range_max, points_w, indices);
+        distribution_t *d = nullptr;
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            if (k == 0 || indices[k] != indices[k-1]) {
+                d = storage.get(indices[k]);
+                d = d ? d : &storage.insert(indices[k], distribution_t());
+            }
+            d->updateOccupied(points_w[k]);
+        }
+
+        insertStorage<line_iterator_t>(storage, points_origin, pool);
+    }
+
+    /**
+     * @brief Insert with a visibility check of every ray against the map as
+     *        it was before this scan, see OccupancyGridmap::insertVisible.
+     */
     template <typename line_iterator_t = default_iterator_t>
     inline void insertVisible(const pose_t &origin,
                               const typename cslibs_math::linear::Pointcloud<point_t>::ConstPtr &points,
@@ -99,12 +180,19 @@ public:
             return insert(points, origin);
         }
 
-        const index_t start_bi = toBundleIndex(origin.translation());
-        auto occupancy = [this, &ivm](const index_t &bi) {
-            distribution_bundle_t *bundle = this->getAllocate(bi);
+        const index_t start_bi = this->toBundleIndex(origin.translation());
+        const T unknown = distribution_t().getOccupancy(ivm);
+        std::unordered_map<index_t, T, utility::bundle_hash<Dim>> memo;
+        auto occupancy = [this, &ivm, &unknown, &memo](const index_t &bi) {
+            const auto it = memo.find(bi);
+            if (it != memo.end())
+                return it->second;
+
+            const std::array<const distribution_t*, base_t::bin_count> bundle = this->findDistributions(bi);
             T retval = T();
             for (std::size_t i=0; i<this->bin_count; ++i)
-                retval += this->div_count * bundle->at(i)->getOccupancy(ivm);
+                retval += this->div_count * (bundle.at(i) ? bundle.at(i)->getOccupancy(ivm) : unknown);
+            memo.emplace(bi, retval);
             return retval;
         };
         auto current_visibility = [this, &start_bi, &ivm_visibility, &occupancy](const index_t &bi) {
@@ -125,17 +213,18 @@ public:
         };
 
         dynamic_distribution_storage_t storage;
-        for (const auto &p : *points) {
-            const point_t pm = origin * p;
-            if (pm.isNormal()) {
-                const index_t &bi = this->toBundleIndex(pm);
-                distribution_t *d = storage.get(bi);
-                (d ? d : &storage.insert(bi, distribution_t()))->updateOccupied(pm);
-            }
+        point_list_t points_w;
+        std::vector<index_t> indices;
+        this->toBundleIndices(*points, origin, points_w, indices);
+        for (std::size_t k=0; k<points_w.size(); ++k) {
+            distribution_t *d = storage.get(indices[k]);
+            (d ? d : &storage.insert(indices[k], distribution_t()))->updateOccupied(points_w[k]);
         }
 
         const point_t start_p = this->m_T_w_ * origin.translation();
-        storage.traverse([this, &ivm_visibility, &start_p, &current_visibility](const index_t& bi, const distribution_t &d) {
+        std::unordered_map<index_t, free_t, utility::bundle_hash<Dim>> free;
+        std::vector<std::pair<index_t, typename distribution_t::distribution_ptr_t>> occupied;
+        storage.traverse([this, &ivm_visibility, &start_p, &current_visibility, &free, &occupied](const index_t& bi, const distribution_t &d) {
             if (!d.getDistribution())
                 return;
 
@@ -149,13 +238,18 @@ public:
                 if ((visibility *= current_visibility(bit)) < ivm_visibility->getProbPrior())
                     return;
 
-                updateFree(bit, 1, ww);  // TODO!
+                free[bit] += free_t{1ul, ww};
                 ++ it;
             }
 
             if ((visibility *= current_visibility(bi)) >= ivm_visibility->getProbPrior())
-                updateOccupied(bi, d.getDistribution());
+                occupied.emplace_back(bi, d.getDistribution());
         });
+
+        for (const auto &f : free)
+            updateFree(f.first, f.second.n, f.second.w);
+        for (const auto &o : occupied)
+            updateOccupied(o.first, o.second);
     }
 
     template <typename line_iterator_t = default_iterator_t>
@@ -178,7 +272,7 @@ public:
         line_iterator_t it(start_index, end_index);
 
         auto occupied = [this, &ivm, &occupied_threshold](const index_t &bi) {
-            distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+            distribution_bundle_t *bundle = this->getBundle(bi);
             auto occupancy = [this, &bundle, &ivm]() {
                 T retval = T();
                 for (std::size_t i=0; i<this->bin_count; ++i)
@@ -221,7 +315,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle = this->getBundle(bi);
 
         auto sample = [&p, &ivm] (const distribution_t *d) {
             auto do_sample = [&p, &ivm, &d]() {
@@ -256,7 +350,7 @@ public:
         if (!this->valid(bi))
             return T();
 
-        distribution_bundle_t *bundle = this->bundle_storage_->get(bi);
+        distribution_bundle_t *bundle = this->getBundle(bi);
 
         auto sample = [&p, &ivm] (const distribution_t *d) {
             auto do_sample = [&p, &ivm, &d]() {
@@ -275,8 +369,52 @@ public:
         return bundle ? evaluate() : T();
     }
 
+    inline void allocatePartiallyAllocatedBundles(utility::ThreadPool *pool = nullptr)
+    {
+        base_t::allocatePartiallyAllocatedBundles(&Map::expandDistribution, pool);
+    }
+
 protected:
-    virtual inline bool expandDistribution(const distribution_t* d) const override
+    /**
+     * @brief Apply the scan-local occupied distributions of storage and carve
+     *        the free space between points_origin and their means.
+     */
+    template <typename line_iterator_t>
+    inline void insertStorage(dynamic_distribution_storage_t &storage,
+                              const pose_t &points_origin,
+                              utility::ThreadPool *pool) const
+    {
+        std::vector<std::pair<point_t,free_t>> rays;
+        storage.traverse([this, &rays](const index_t& bi, const distribution_t &d) {
+            if (!d.getDistribution())
+                return;
+            updateOccupied(bi, d.getDistribution());
+            rays.emplace_back(this->m_T_w_ * point_t(d.getDistribution()->getMean()), free_t{1ul, d.weightOccupied()});
+        });
+
+        const point_t start_p = this->m_T_w_ * points_origin.translation();
+        base_t::template carve<line_iterator_t>(start_p, rays, pool, [this](const index_t &bi, const free_t &f) {
+            updateFree(bi, f.n, f.w);
+        });
+    }
+
+    /// free space of a ray, summed up per bundle in insertDeduplicated
+    struct free_t {
+        std::size_t n;
+        T           w;
+
+        inline free_t() : n(0ul), w(T()) { }
+        inline free_t(const std::size_t n, const T w) : n(n), w(w) { }
+
+        inline free_t& operator += (const free_t &other)
+        {
+            n += other.n;
+            w += other.w;
+            return *this;
+        }
+    };
+
+    inline static bool expandDistribution(const distribution_t* d)
     {
         return d && d->getDistribution() && d->getDistribution()->getSampleCount() > 0;
     }
@@ -284,6 +422,8 @@ protected:
     inline void updateFree(const index_t &bi) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateFree();
     }
@@ -293,6 +433,8 @@ protected:
                            const T           &w) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateFree(n, w);
     }
@@ -302,6 +444,8 @@ protected:
                                const T       &w = cslibs_math::utility::traits<T>::One) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateOccupied(p, w);
     }
@@ -310,6 +454,8 @@ protected:
                                const typename distribution_t::distribution_ptr_t &d) const
     {
         distribution_bundle_t *bundle = this->getAllocate(bi);
+        if (!bundle)
+            return;
         for (std::size_t i=0; i<this->bin_count; ++i)
             bundle->at(i)->updateOccupied(d);
     }
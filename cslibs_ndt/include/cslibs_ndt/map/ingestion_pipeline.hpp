@@ -0,0 +1,368 @@
+#ifndef CSLIBS_NDT_MAP_INGESTION_PIPELINE_HPP
+#define CSLIBS_NDT_MAP_INGESTION_PIPELINE_HPP
+
+#include <cslibs_ndt/utility/binary_indices.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Asynchronous front-end for inserting pointclouds into a map. Any
+ *        number of producers, e.g. sensor callbacks, push (cloud, pose) items
+ *        into a bounded queue and return immediately. Two stages work on the
+ *        queue in a pipeline: the first one downsamples the next cloud to one
+ *        point per voxel while the second one inserts the previous cloud into
+ *        the map, i.e. bins it and carves its rays. Only the second stage
+ *        touches the map, so it is the single writer the maps require.
+ */
+template <typename map_t>
+class IngestionPipeline
+{
+public:
+    using Ptr               = std::shared_ptr<IngestionPipeline<map_t>>;
+    using ConstPtr          = std::shared_ptr<const IngestionPipeline<map_t>>;
+
+    using map_ptr_t         = std::shared_ptr<map_t>;
+    using pose_t            = typename map_t::pose_t;
+    using point_t           = typename map_t::point_t;
+    using pointcloud_t      = typename map_t::pointcloud_t;
+    using index_t           = typename map_t::index_t;
+    using insert_t          = std::function<void(const typename pointcloud_t::ConstPtr &, const pose_t &)>;
+
+    /**
+     * @brief What push does if the queue is full.
+     */
+    enum class Policy {
+        BLOCK,          /// wait until the pipeline made room
+        DROP_NEWEST,    /// discard the pushed item
+        DROP_OLDEST,    /// discard the oldest queued item
+        MERGE           /// append the pushed (cloud, pose) to the newest queued item
+    };
+
+    /// running statistics of a latency, in milliseconds
+    struct latency_t {
+        std::size_t n    = 0ul;
+        double      sum  = 0.0;
+        double      max  = 0.0;
+
+        inline void add(const double ms)
+        {
+            ++ n;
+            sum += ms;
+            max  = std::max(max, ms);
+        }
+
+        inline double mean() const
+        {
+            return n > 0ul ? sum / static_cast<double>(n) : 0.0;
+        }
+    };
+
+    struct metrics_t {
+        std::size_t depth     = 0ul;    /// items currently queued
+        std::size_t max_depth = 0ul;    /// highest queue depth seen
+        std::size_t pushed    = 0ul;    /// items accepted by push
+        std::size_t dropped   = 0ul;    /// items discarded under back-pressure
+        std::size_t merged    = 0ul;    /// items merged into a queued one
+        std::size_t inserted  = 0ul;    /// items inserted into the map
+        std::size_t failed    = 0ul;    /// items the insert function threw for
+        latency_t   wait;               /// from push until downsampling starts
+        latency_t   downsample;
+        latency_t   insert;
+        latency_t   total;              /// from push until inserted
+    };
+
+    /**
+     * @brief Constructor, clouds are inserted with map_t::insertDeduplicated.
+     * @param map           the map to insert into, must not be used by others
+     *                      while the pipeline runs, see also ConcurrentMap
+     * @param capacity      maximum number of queued items
+     * @param policy        what to do if the queue is full
+     * @param voxel_size    edge length of the downsampling voxels in the
+     *                      sensor frame, 0 disables downsampling
+     */
+    inline explicit IngestionPipeline(const map_ptr_t   &map,
+                                      const std::size_t  capacity   = 8ul,
+                                      const Policy       policy     = Policy::DROP_OLDEST,
+                                      const double       voxel_size = 0.0) :
+        IngestionPipeline(map ? insert_t([map](const typename pointcloud_t::ConstPtr &points, const pose_t &origin) {
+                                             map->insertDeduplicated(points, origin);
+                                         })
+                              : insert_t(),
+                          capacity, policy, voxel_size)
+    {
+    }
+
+    /**
+     * @brief Constructor with an arbitrary insert function, e.g. one that
+     *        updates a ConcurrentMap.
+     */
+    inline explicit IngestionPipeline(const insert_t    &insert,
+                                      const std::size_t  capacity   = 8ul,
+                                      const Policy       policy     = Policy::DROP_OLDEST,
+                                      const double       voxel_size = 0.0) :
+        insert_(insert),
+        capacity_(std::max<std::size_t>(capacity, 1ul)),
+        policy_(policy),
+        voxel_size_(voxel_size),
+        stop_(false),
+        busy_(0ul)
+    {
+        if (!insert_)
+            throw std::runtime_error("[IngestionPipeline]: insert function must not be null!");
+        downsampler_ = std::thread([this]() { downsampleLoop(); });
+        inserter_    = std::thread([this]() { insertLoop(); });
+    }
+
+    /**
+     * @brief Inserts everything that is still queued and stops the pipeline.
+     */
+    inline ~IngestionPipeline()
+    {
+        flush();
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            stop_ = true;
+        }
+        queued_.notify_all();
+        staged_.notify_all();
+        unstaged_.notify_all();
+        downsampler_.join();
+        inserter_.join();
+    }
+
+    IngestionPipeline(const IngestionPipeline &) = delete;
+    IngestionPipeline& operator = (const IngestionPipeline &) = delete;
+
+    /**
+     * @brief Queue a cloud for insertion, can be called from any thread.
+     * @param points    the cloud in the sensor frame
+     * @param origin    the pose the cloud was taken at
+     * @return false if the item was dropped
+     */
+    inline bool push(const typename pointcloud_t::ConstPtr &points,
+                     const pose_t &origin)
+    {
+        if (!points)
+            return false;
+
+        std::unique_lock<std::mutex> l(mutex_);
+        if (queue_.size() >= capacity_) {
+            switch (policy_) {
+            case Policy::BLOCK:
+                room_.wait(l, [this]() { return queue_.size() < capacity_; });
+                break;
+            case Policy::DROP_NEWEST:
+                ++ metrics_.dropped;
+                return false;
+            case Policy::DROP_OLDEST:
+                queue_.pop_front();
+                ++ metrics_.dropped;
+                break;
+            case Policy::MERGE:
+                queue_.back().scans.emplace_back(scan_t{points, origin});
+                ++ metrics_.pushed;
+                ++ metrics_.merged;
+                return true;
+            }
+        }
+
+        queue_.emplace_back(item_t{scans_t(1, scan_t{points, origin}), clock_t::now()});
+        ++ metrics_.pushed;
+        metrics_.depth     = queue_.size();
+        metrics_.max_depth = std::max(metrics_.max_depth, queue_.size());
+        l.unlock();
+        queued_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Wait until all items pushed so far are inserted or dropped.
+     */
+    inline void flush()
+    {
+        std::unique_lock<std::mutex> l(mutex_);
+        idle_.wait(l, [this]() { return queue_.empty() && busy_ == 0ul; });
+    }
+
+    inline metrics_t getMetrics() const
+    {
+        std::unique_lock<std::mutex> l(mutex_);
+        return metrics_;
+    }
+
+    /**
+     * @brief Replace each group of points falling into the same voxel by
+     *        their mean, in the order of the first point of each voxel.
+     */
+    inline static typename pointcloud_t::Ptr downsample(const pointcloud_t &points,
+                                                        const double voxel_size)
+    {
+        using voxel_t = std::pair<point_t, std::size_t>;
+
+        const double inv = 1.0 / voxel_size;
+        std::unordered_map<index_t, std::size_t, utility::bundle_hash<Dim>> lookup;
+        std::vector<voxel_t, Eigen::aligned_allocator<voxel_t>> voxels;
+        lookup.reserve(points.size());
+        voxels.reserve(points.size());
+        for (const point_t &p : points) {
+            if (!p.isNormal())
+                continue;
+
+            index_t vi;
+            for (std::size_t i=0; i<Dim; ++i)
+                vi[i] = static_cast<int>(std::floor(static_cast<double>(p(i)) * inv));
+
+            const auto v = lookup.emplace(vi, voxels.size());
+            if (v.second)
+                voxels.emplace_back(p, 1ul);
+            else {
+                voxel_t &voxel = voxels[v.first->second];
+                voxel.first += p;
+                ++ voxel.second;
+            }
+        }
+
+        typename pointcloud_t::Ptr downsampled(new pointcloud_t);
+        for (const voxel_t &v : voxels)
+            downsampled->insert(v.first / static_cast<T>(v.second));
+        return downsampled;
+    }
+
+private:
+    static constexpr std::size_t Dim = std::tuple_size<index_t>::value;
+    using T       = typename std::decay<decltype(std::declval<const point_t&>()(0))>::type;
+    using clock_t = std::chrono::steady_clock;
+
+    struct scan_t {
+        typename pointcloud_t::ConstPtr points;
+        pose_t                          origin;
+    };
+    using scans_t = std::vector<scan_t, Eigen::aligned_allocator<scan_t>>;
+
+    /// merged scans stay separate, each one is carved from its own origin
+    struct item_t {
+        scans_t                         scans;
+        clock_t::time_point             stamp;
+    };
+
+    const insert_t              insert_;
+    const std::size_t           capacity_;
+    const Policy                policy_;
+    const double                voxel_size_;
+
+    mutable std::mutex          mutex_;
+    std::condition_variable     queued_;
+    std::condition_variable     staged_;
+    std::condition_variable     unstaged_;
+    std::condition_variable     room_;
+    std::condition_variable     idle_;
+    std::deque<item_t>          queue_;
+    std::deque<item_t>          stage_;     /// downsampled, at most one item
+    bool                        stop_;
+    std::size_t                 busy_;      /// items taken from the queue, not inserted yet
+    metrics_t                   metrics_;
+
+    std::thread                 downsampler_;
+    std::thread                 inserter_;
+
+    inline static double ms(const clock_t::time_point &start,
+                            const clock_t::time_point &end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    inline void downsampleLoop()
+    {
+        while (true) {
+            item_t item;
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                queued_.wait(l, [this]() { return stop_ || !queue_.empty(); });
+                if (stop_)
+                    return;
+                item = std::move(queue_.front());
+                queue_.pop_front();
+                ++ busy_;
+                metrics_.depth = queue_.size();
+                metrics_.wait.add(ms(item.stamp, clock_t::now()));
+            }
+            room_.notify_one();
+
+            const clock_t::time_point start = clock_t::now();
+            if (voxel_size_ > 0.0)
+                for (scan_t &scan : item.scans)
+                    scan.points = downsample(*scan.points, voxel_size_);
+            const double downsample_ms = ms(start, clock_t::now());
+
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                metrics_.downsample.add(downsample_ms);
+                unstaged_.wait(l, [this]() { return stop_ || stage_.empty(); });
+                if (stop_)
+                    return;
+                stage_.emplace_back(std::move(item));
+            }
+            staged_.notify_one();
+        }
+    }
+
+    inline void insertLoop()
+    {
+        while (true) {
+            item_t item;
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                staged_.wait(l, [this]() { return stop_ || !stage_.empty(); });
+                if (stop_)
+                    return;
+                item = std::move(stage_.front());
+                stage_.pop_front();
+            }
+            unstaged_.notify_one();
+
+            /// a throwing insert function must neither end the thread nor stall flush
+            const clock_t::time_point start = clock_t::now();
+            bool failed = false;
+            for (const scan_t &scan : item.scans) {
+                try {
+                    insert_(scan.points, scan.origin);
+                } catch (const std::exception &e) {
+                    std::cerr << "[IngestionPipeline]: Could not insert a cloud, '" << e.what() << "'." << std::endl;
+                    failed = true;
+                } catch (...) {
+                    std::cerr << "[IngestionPipeline]: Could not insert a cloud." << std::endl;
+                    failed = true;
+                }
+            }
+            const clock_t::time_point end = clock_t::now();
+
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                metrics_.insert.add(ms(start, end));
+                metrics_.total.add(ms(item.stamp, end));
+                ++ (failed ? metrics_.failed : metrics_.inserted);
+                -- busy_;
+            }
+            idle_.notify_all();
+        }
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_INGESTION_PIPELINE_HPP
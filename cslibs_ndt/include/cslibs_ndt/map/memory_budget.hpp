@@ -0,0 +1,538 @@
+#ifndef CSLIBS_NDT_MAP_MEMORY_BUDGET_HPP
+#define CSLIBS_NDT_MAP_MEMORY_BUDGET_HPP
+
+#include <array>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#include <cslibs_ndt/utility/utility.hpp>
+#include <cslibs_ndt/serialization/tile_store.hpp>
+
+#include <cslibs_math/common/div.hpp>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Memory budget of a map. Bundles are grouped into tiles of
+ *        tile_size^Dim bundles, once the budget is exceeded the least recently
+ *        accessed tiles are written to a tile store and loaded again on access.
+ *        The budget is owned by the map, which passes itself to every call, so
+ *        that moving the map moves the budget along. The bookkeeping is
+ *        serialized, the map itself is not.
+ */
+template <typename map_t>
+class MemoryBudget
+{
+public:
+    using index_t                           = typename map_t::index_t;
+    using index_list_t                      = typename map_t::index_list_t;
+    using distribution_t                    = typename map_t::distribution_t;
+    using distribution_bundle_t             = typename map_t::distribution_bundle_t;
+    using distribution_storage_t            = typename map_t::distribution_storage_t;
+    using distribution_storage_array_t      = typename map_t::distribution_storage_array_t;
+    using distribution_bundle_storage_t     = typename map_t::distribution_bundle_storage_t;
+    using distribution_bundle_storage_ptr_t = typename map_t::distribution_bundle_storage_ptr_t;
+
+    static constexpr std::size_t Dim        = std::tuple_size<index_t>::value;
+    static constexpr std::size_t bin_count  = map_t::bin_count;
+
+    using tile_store_t  = serialization::TileStore<distribution_t, Dim, bin_count>;
+    using tile_t        = typename tile_store_t::tile_t;
+
+    /**
+     * @param bytes     the memory budget
+     * @param tile_size the number of bundles per tile and dimension, rounded up
+     *                  to an even number, so that both bundles of a
+     *                  distribution pair are in one tile
+     * @param directory the directory for evicted tiles
+     */
+    inline MemoryBudget(const std::size_t  bytes,
+                        const std::size_t  tile_size,
+                        const std::string &directory) :
+        bytes_(bytes),
+        tile_size_(static_cast<int>(tile_size + tile_size % 2ul)),
+        bytes_per_bundle_(sizeof(distribution_bundle_t) + sizeof(distribution_t) + 2 * sizeof(index_t)),
+        bundles_(0),
+        calibration_(0),
+        clock_(0),
+        store_(directory)
+    {
+    }
+
+    inline bool hasEvictedTiles() const
+    {
+        return !evicted_.empty();
+    }
+
+    inline std::vector<index_t> getEvictedTiles() const
+    {
+        return std::vector<index_t>(evicted_.begin(), evicted_.end());
+    }
+
+    /**
+     * @brief Check if a tile holds bundles in the box [min, max].
+     */
+    inline bool overlaps(const index_t &tile,
+                         const index_t &min,
+                         const index_t &max) const
+    {
+        for (std::size_t i=0; i<Dim; ++i)
+            if ((tile[i] + 1) * tile_size_ <= min[i] || tile[i] * tile_size_ > max[i])
+                return false;
+        return true;
+    }
+
+    /**
+     * @brief Count the bundles of map in memory, all tiles count as accessed now.
+     */
+    inline void track(const map_t &map)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        resident_.clear();
+        bundles_ = 0;
+        map.traverseResident([this](const index_t &bi, const distribution_bundle_t &) {
+            tile_info_t &t = resident_[toTileIndex(bi)];
+            t.last_access = clock_;
+            ++ t.bundles;
+            ++ bundles_;
+        });
+    }
+
+    inline void access(const map_t &map,
+                       const index_t &bi)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        const index_t tile = toTileIndex(bi);
+        if (!evicted_.empty() && evicted_.count(tile) > 0)
+            loadTile(map, tile);
+
+        auto it = resident_.find(tile);
+        if (it != resident_.end())
+            it->second.last_access = ++ clock_;
+    }
+
+    /**
+     * @brief Load the upper neighbour tiles of a bundle, which may own some of
+     *        its distributions.
+     */
+    inline void loadNeighbourTiles(const map_t &map,
+                                   const index_t &bi)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        if (evicted_.empty())
+            return;
+
+        for (std::size_t c=1; c<bin_count; ++c) {
+            index_t n = bi;
+            for (std::size_t i=0; i<Dim; ++i)
+                n[i] += static_cast<int>((c >> i) & 1ul);
+            const index_t tile = toTileIndex(n);
+            if (evicted_.count(tile) > 0)
+                loadTile(map, tile);
+        }
+    }
+
+    /**
+     * @brief Load everything a lookup of bundle bi refers to.
+     */
+    inline void load(const map_t &map,
+                     const index_t &bi)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        access(map, bi);
+        loadNeighbourTiles(map, bi);
+    }
+
+    /**
+     * @brief Prepare the allocation of a bundle, everything it refers to is
+     *        loaded and tiles are evicted if the budget would be exceeded.
+     */
+    inline void reserve(const map_t &map,
+                        const index_t &bi)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        access(map, bi);
+        if (map.findBundle(bi))
+            return;
+
+        loadNeighbourTiles(map, bi);
+
+        /// distributions grow after allocation, measuring once the map grew by an eighth is amortized O(1)
+        if (bundles_ >= calibration_)
+            calibrate(map);
+        if ((bundles_ + 1) * bytes_per_bundle_ > bytes_ / 7 * 4)
+            evict(map, bi);
+
+        tile_info_t &t = resident_[toTileIndex(bi)];
+        t.last_access = ++ clock_;
+        ++ t.bundles;
+        ++ bundles_;
+    }
+
+    /**
+     * @brief Load all evicted tiles into the storages of map, which have to be
+     *        exclusively owned, e.g. of a copy. Throws before changing the
+     *        storages if a tile can not be read.
+     */
+    inline void restore(const map_t &map) const
+    {
+        std::vector<tile_t> tiles(evicted_.size());
+        std::size_t n = 0;
+        for (const index_t &tile : evicted_)
+            if (!store_.read(tile, tiles[n++]))
+                throw std::runtime_error("[MemoryBudget]: Could not restore an evicted tile.");
+
+        /// all distributions first, bundles may refer to distributions of other tiles
+        for (const tile_t &t : tiles)
+            insertDistributions(map, t);
+        for (const tile_t &t : tiles)
+            insertBundles(map, t, [](const std::size_t, const index_t &) -> const distribution_t* { return nullptr; });
+    }
+
+    /**
+     * @brief Load all evicted tiles back into map, the map this budget belongs
+     *        to, and remove their files.
+     */
+    inline void restoreEvictedTiles(const map_t &map)
+    {
+        std::lock_guard<std::recursive_mutex> l(mutex_);
+        if (evicted_.empty())
+            return;
+
+        map.detach();
+        restore(map);
+        for (const index_t &tile : evicted_)
+            store_.remove(tile);
+        evicted_.clear();
+        track(map);
+    }
+
+    /**
+     * @brief Visit the bundles of all evicted tiles accepted by filter, see
+     *        traverseTile.
+     */
+    template <typename Fn, typename filter_t>
+    inline void traverseEvicted(const map_t &map,
+                                const Fn &function,
+                                const filter_t &filter) const
+    {
+        for (const index_t &tile : getEvictedTiles())
+            if (filter(tile))
+                traverseTile(map, tile, function);
+    }
+
+    /**
+     * @brief Visit the bundles of an evicted tile without loading it into the
+     *        map. Distributions are taken from memory, the tile or the evicted
+     *        neighbour owning them, so at most bin_count tiles are read.
+     */
+    template <typename Fn>
+    inline void traverseTile(const map_t &map,
+                             const index_t &tile,
+                             const Fn &function) const
+    {
+        tile_t t;
+        readTile(tile, t);
+
+        std::map<index_t, tile_t> neighbours;
+        auto lookup = [this, &map, &tile, &t, &neighbours](const std::size_t i, const index_t &index) -> distribution_t* {
+            distribution_t *d = map.findDistribution(i, index);
+            if (d)
+                return d;
+
+            const index_t owner = toOwnerTileIndex(index);
+            if (owner != tile && evicted_.count(owner) > 0) {
+                auto n = neighbours.find(owner);
+                if (n == neighbours.end()) {
+                    n = neighbours.emplace(owner, tile_t()).first;
+                    readTile(owner, n->second);
+                }
+                auto it = n->second.distributions[i].find(index);
+                if (it != n->second.distributions[i].end())
+                    return &(it->second);
+            }
+            /// the same as loadTile, distributions never written are empty
+            return &(t.distributions[i][index]);
+        };
+
+        for (const index_t &bi : t.bundles) {
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            distribution_bundle_t b;
+            for (std::size_t i=0; i<bin_count; ++i)
+                b[i] = lookup(i, indices[i]);
+            function(bi, b);
+        }
+    }
+
+    /**
+     * @brief Visit the evicted distributions of bin i which are not in memory.
+     *        Every distribution is written to the file of its owner tile only.
+     */
+    template <typename Fn>
+    inline void traverseEvictedDistributions(const map_t &map,
+                                             const std::size_t i,
+                                             const Fn &function) const
+    {
+        for (const index_t &tile : getEvictedTiles()) {
+            tile_t t;
+            readTile(tile, t);
+            for (const auto &d : t.distributions[i])
+                if (!map.findDistribution(i, d.first))
+                    function(d.first, d.second);
+        }
+    }
+
+private:
+    struct tile_info_t {
+        std::size_t last_access = 0;
+        std::size_t bundles     = 0;
+    };
+
+    const std::size_t               bytes_;
+    const int                       tile_size_;
+    std::size_t                     bytes_per_bundle_;
+    std::size_t                     bundles_;
+    std::size_t                     calibration_;
+    std::size_t                     clock_;
+    std::map<index_t, tile_info_t>  resident_;
+    std::set<index_t>               evicted_;
+    tile_store_t                    store_;
+    std::recursive_mutex            mutex_;
+
+    inline index_t toTileIndex(const index_t &bi) const
+    {
+        index_t tile;
+        for (std::size_t i=0; i<Dim; ++i)
+            tile[i] = cslibs_math::common::div(bi[i], tile_size_);
+        return tile;
+    }
+
+    /**
+     * @brief Tile owning a distribution, the one holding bundle 2 * index which
+     *        always refers to it.
+     */
+    inline index_t toOwnerTileIndex(const index_t &index) const
+    {
+        index_t bi;
+        for (std::size_t i=0; i<Dim; ++i)
+            bi[i] = 2 * index[i];
+        return toTileIndex(bi);
+    }
+
+    inline void readTile(const index_t &tile,
+                         tile_t &t) const
+    {
+        if (!store_.read(tile, t))
+            throw std::runtime_error("[MemoryBudget]: Could not read an evicted tile.");
+    }
+
+    /**
+     * @brief Evict least recently used tiles down to three quarters of the
+     *        4/7 of the budget the map may use, so the rebuild of the storages
+     *        is amortized and the kept copy fits into the remaining 3/7. Tiles
+     *        bi refers to are kept.
+     */
+    inline void evict(const map_t &map,
+                      const index_t &bi)
+    {
+        std::set<index_t> keep;
+        for (std::size_t c=0; c<bin_count; ++c) {
+            index_t n = bi;
+            for (std::size_t i=0; i<Dim; ++i)
+                n[i] += static_cast<int>((c >> i) & 1ul);
+            keep.insert(toTileIndex(n));
+        }
+
+        std::vector<std::pair<std::size_t, index_t>> lru;
+        for (const auto &t : resident_)
+            if (keep.count(t.first) == 0)
+                lru.emplace_back(t.second.last_access, t.first);
+        std::sort(lru.begin(), lru.end());
+
+        const std::size_t target = (bytes_ / 7 * 3) / bytes_per_bundle_;
+        std::size_t bundles = bundles_;
+        std::set<index_t> tiles;
+        for (const auto &t : lru) {
+            if (bundles <= target)
+                break;
+            tiles.insert(t.second);
+            bundles -= resident_[t.second].bundles;
+        }
+        if (!tiles.empty())
+            evictTiles(map, tiles);
+    }
+
+    inline void evictTiles(const map_t &map,
+                           const std::set<index_t> &tiles)
+    {
+        map.detach();
+
+        std::map<index_t, std::vector<index_t>> evicted_bundles;
+        std::map<index_t, typename tile_store_t::distribution_records_t> evicted_distributions;
+
+        distribution_bundle_storage_ptr_t bundles(new distribution_bundle_storage_t);
+        map.bundle_storage_->traverse([this, &tiles, &bundles, &evicted_bundles](const index_t &bi, const distribution_bundle_t &b) {
+            const index_t tile = toTileIndex(bi);
+            if (tiles.count(tile) > 0)
+                evicted_bundles[tile].emplace_back(bi);
+            else
+                bundles->insert(bi, b);
+        });
+
+        /// distributions stay while a bundle in memory or their owner tile needs them
+        auto referenced = [&bundles](const std::size_t i, const index_t &index) {
+            for (std::size_t c=0; c<bin_count; ++c) {
+                index_t bi;
+                for (std::size_t j=0; j<Dim; ++j) {
+                    const bool upper = ((i >> j) & 1ul) != 0ul;
+                    const bool first = ((c >> j) & 1ul) == 0ul;
+                    bi[j] = 2 * index[j] + (upper ? (first ? -1 : 0) : (first ? 0 : 1));
+                }
+                if (bundles->get(bi))
+                    return true;
+            }
+            return false;
+        };
+
+        distribution_storage_array_t storage = utility::create<distribution_storage_t,bin_count>();
+        for (std::size_t i=0; i<bin_count; ++i) {
+            map.storage_[i]->traverse([this, i, &tiles, &storage, &referenced, &evicted_distributions](const index_t &index, const distribution_t &d) {
+                const index_t owner = toOwnerTileIndex(index);
+                const bool owner_resident = resident_.count(owner) > 0 && tiles.count(owner) == 0;
+                if (owner_resident || referenced(i, index))
+                    storage[i]->insert(index, d);
+                else
+                    evicted_distributions[owner][i].emplace_back(index, &d);
+            });
+        }
+
+        std::set<index_t> written;
+        for (const auto &t : evicted_bundles)
+            written.insert(t.first);
+        for (const auto &t : evicted_distributions)
+            written.insert(t.first);
+        for (const index_t &tile : written) {
+            if (!store_.append(tile, evicted_bundles[tile], evicted_distributions[tile])) {
+                /// records appended to tiles evicted before are newer, so harmless
+                for (const index_t &t : written)
+                    if (evicted_.count(t) == 0)
+                        store_.remove(t);
+                throw std::runtime_error("[MemoryBudget]: Could not evict tiles, the memory budget is exceeded.");
+            }
+        }
+
+        map.storage_        = storage;
+        map.bundle_storage_ = bundles;
+        map_t::rebind(map.storage_, *map.bundle_storage_);
+
+        evicted_.insert(written.begin(), written.end());
+        for (const index_t &tile : tiles) {
+            bundles_ -= resident_[tile].bundles;
+            resident_.erase(tile);
+        }
+        calibrate(map);
+    }
+
+    inline void calibrate(const map_t &map)
+    {
+        if (bundles_ > 0)
+            bytes_per_bundle_ = std::max(1ul, map.getByteSize() / bundles_);
+        calibration_ = bundles_ + bundles_ / 8ul + 1ul;
+    }
+
+    /**
+     * @brief Load an evicted tile, throws if it or a neighbour it needs can not
+     *        be read, the map and the files stay unchanged then.
+     */
+    inline void loadTile(const map_t &map,
+                         const index_t &tile)
+    {
+        map.detach();
+
+        tile_t t;
+        if (!store_.read(tile, t))
+            throw std::runtime_error("[MemoryBudget]: Could not load an evicted tile.");
+
+        /// distributions owned by evicted neighbours are looked up in their files
+        std::map<index_t, tile_t> neighbours;
+        for (const index_t &bi : t.bundles) {
+            if (map.bundle_storage_->get(bi))
+                continue;
+
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            for (std::size_t i=0; i<bin_count; ++i) {
+                if (map.storage_[i]->get(indices[i]) || t.distributions[i].count(indices[i]) > 0)
+                    continue;
+
+                const index_t owner = toOwnerTileIndex(indices[i]);
+                if (owner == tile || evicted_.count(owner) == 0 || neighbours.count(owner) > 0)
+                    continue;
+                if (!store_.read(owner, neighbours[owner]))
+                    throw std::runtime_error("[MemoryBudget]: Could not load a tile neighbouring an evicted tile.");
+            }
+        }
+        auto lookup = [this, &neighbours](const std::size_t i, const index_t &index) -> const distribution_t* {
+            auto it = neighbours.find(toOwnerTileIndex(index));
+            if (it == neighbours.end())
+                return nullptr;
+            auto d = it->second.distributions[i].find(index);
+            return d != it->second.distributions[i].end() ? &(d->second) : nullptr;
+        };
+
+        store_.remove(tile);
+        evicted_.erase(tile);
+
+        insertDistributions(map, t);
+        const std::size_t bundles = insertBundles(map, t, lookup);
+
+        tile_info_t &info = resident_[tile];
+        info.last_access = ++ clock_;
+        info.bundles    += bundles;
+        bundles_        += bundles;
+    }
+
+    /// distributions in memory are newer than the ones on disk
+    inline static void insertDistributions(const map_t &map,
+                                           const tile_t &t)
+    {
+        for (std::size_t i=0; i<bin_count; ++i)
+            for (const auto &d : t.distributions[i])
+                if (!map.storage_[i]->get(d.first))
+                    map.storage_[i]->insert(d.first, d.second);
+    }
+
+    template <typename lookup_t>
+    inline static std::size_t insertBundles(const map_t &map,
+                                            const tile_t &t,
+                                            const lookup_t &lookup)
+    {
+        std::size_t inserted = 0;
+        for (const index_t &bi : t.bundles) {
+            if (map.bundle_storage_->get(bi))
+                continue;
+
+            const index_list_t indices = utility::generate_indices<index_list_t,Dim>(bi);
+            distribution_bundle_t b;
+            for (std::size_t i=0; i<bin_count; ++i) {
+                distribution_t *d = map.storage_[i]->get(indices[i]);
+                if (!d) {
+                    const distribution_t *l = lookup(i, indices[i]);
+                    d = &(map.storage_[i]->insert(indices[i], l ? *l : distribution_t()));
+                }
+                b[i] = d;
+            }
+            map.bundle_storage_->insert(bi, b);
+            ++ inserted;
+        }
+        return inserted;
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_MEMORY_BUDGET_HPP
@@ -0,0 +1,35 @@
+#ifndef CSLIBS_NDT_MAP_MERGE_MAPS_HPP
+#define CSLIBS_NDT_MAP_MERGE_MAPS_HPP
+
+#include <cslibs_ndt/utility/thread_pool.hpp>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Fuse two maps, e.g. of several robots or sessions, without their raw
+ *        data. The result is a copy-on-write snapshot of b to which the
+ *        statistics of a are added, bundle by bundle in parallel with a pool.
+ *        Maps with identical origin and resolution are merged directly,
+ *        otherwise a is moved by b_T_a and regridded onto b.
+ *        Supports the maps providing insert(const map_t &, const pose_t &,
+ *        utility::ThreadPool *), i.e. Gridmap and OccupancyGridmap.
+ * @param a     the map to add
+ * @param b     the map defining frame and grid of the result
+ * @param b_T_a pose of the world frame of a in the world frame of b
+ * @param pool  optional thread pool to merge with
+ * @return the merged map
+ */
+template <typename map_t>
+inline typename map_t::Ptr mergeMaps(const map_t &a,
+                                     const map_t &b,
+                                     const typename map_t::pose_t &b_T_a = typename map_t::pose_t(),
+                                     utility::ThreadPool *pool = nullptr)
+{
+    typename map_t::Ptr merged = b.snapshot();
+    merged->insert(a, b_T_a, pool);
+    return merged;
+}
+}
+}
+
+#endif // CSLIBS_NDT_MAP_MERGE_MAPS_HPP
@@ -0,0 +1,181 @@
+#ifndef CSLIBS_NDT_MAP_SUBMAP_MANAGER_HPP
+#define CSLIBS_NDT_MAP_SUBMAP_MANAGER_HPP
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace map {
+/**
+ * @brief Mapping with local submaps, e.g. for a pose graph backend. Scans
+ *        are inserted into the active submap, a new one is started every
+ *        scans_per_submap scans. Each submap is anchored at the pose of its
+ *        first scan and stores everything relative to it, so correcting the
+ *        pose of a submap only replaces its anchor. The global map is
+ *        composed on demand and cached: finished submaps are regridded into
+ *        a layer in the global frame once and merged into a base map, the
+ *        active submap is added to a copy-on-write snapshot of it. A change
+ *        of anchors regrids only the layers of the re-anchored submaps, their
+ *        stale layers are subtracted from the base and the regridded ones
+ *        merged into it. Layers take about as much memory as the finished
+ *        submaps.
+ *        Supports the maps providing insert(const map_t &, const pose_t &),
+ *        i.e. Gridmap and OccupancyGridmap. Not thread-safe.
+ */
+template <typename map_t>
+class SubmapManager
+{
+public:
+    using Ptr               = std::shared_ptr<SubmapManager<map_t>>;
+    using ConstPtr          = std::shared_ptr<const SubmapManager<map_t>>;
+
+    using map_ptr_t         = std::shared_ptr<map_t>;
+    using map_const_ptr_t   = std::shared_ptr<const map_t>;
+    using pose_t            = typename map_t::pose_t;
+    using point_t           = typename map_t::point_t;
+    using pointcloud_t      = typename map_t::pointcloud_t;
+
+    /**
+     * @brief Constructor.
+     * @param resolution        resolution of the submaps and the global map
+     * @param scans_per_submap  number of scans after which a new submap is started
+     */
+    template <typename T>
+    inline explicit SubmapManager(const T            resolution,
+                                  const std::size_t  scans_per_submap = 20ul) :
+        scans_per_submap_(std::max<std::size_t>(scans_per_submap, 1ul)),
+        scans_(0ul),
+        composed_(0ul),
+        create_([resolution]() { return map_ptr_t(new map_t(resolution)); }),
+        base_(create_())
+    {
+    }
+
+    /**
+     * @brief Insert a scan into the active submap.
+     * @param points    the scan in the sensor frame
+     * @param origin    the pose of the sensor in the global frame
+     * @return the id of the submap the scan was inserted into
+     */
+    template <typename... args_t>
+    inline std::size_t insert(const typename pointcloud_t::ConstPtr &points,
+                              const pose_t &origin,
+                              args_t&&... args)
+    {
+        if (submaps_.empty() || scans_ >= scans_per_submap_) {
+            submaps_.emplace_back(submap_t{create_(), origin, nullptr});
+            scans_ = 0ul;
+        }
+
+        submap_t &s = submaps_.back();
+        s.map->insert(points, s.anchor.inverse() * origin, std::forward<args_t>(args)...);
+        ++ scans_;
+        view_.reset();
+        return submaps_.size() - 1ul;
+    }
+
+    inline std::size_t size() const
+    {
+        return submaps_.size();
+    }
+
+    inline map_const_ptr_t getSubmap(const std::size_t id) const
+    {
+        return submaps_.at(id).map;
+    }
+
+    inline const pose_t& getAnchor(const std::size_t id) const
+    {
+        return submaps_.at(id).anchor;
+    }
+
+    /**
+     * @brief Re-anchor a submap, e.g. after pose graph optimization. Takes
+     *        constant time, on the next request the layer of the submap is
+     *        subtracted from the base, regridded and merged again.
+     */
+    inline void setAnchor(const std::size_t id,
+                          const pose_t &anchor)
+    {
+        submap_t &s = submaps_.at(id);
+        s.anchor = anchor;
+        if (id < composed_)
+            reanchored_.insert(id);
+        view_.reset();
+    }
+
+    /**
+     * @brief The global map, to sample, match or convert. The result is cached
+     *        until the next insert or re-anchoring and must not be modified.
+     */
+    inline map_const_ptr_t getMap() const
+    {
+        if (view_)
+            return view_;
+        if (submaps_.empty())
+            return base_;
+
+        /// stale layers are taken out of the base, bundles only they covered stay empty
+        for (const std::size_t id : reanchored_) {
+            const submap_t &s = submaps_[id];
+            base_->remove(*s.layer);
+            s.layer = create_();
+            s.layer->insert(*s.map, s.anchor);
+            base_->insert(*s.layer);
+        }
+        reanchored_.clear();
+
+        /// finished submaps are regridded once, layers are merged without re-binning
+        const std::size_t finished = submaps_.size() - 1ul;
+        for (; composed_ < finished; ++ composed_) {
+            const submap_t &s = submaps_[composed_];
+            if (!s.layer) {
+                s.layer = create_();
+                s.layer->insert(*s.map, s.anchor);
+            }
+            base_->insert(*s.layer);
+        }
+
+        map_ptr_t view = base_->snapshot();
+        view->insert(*submaps_.back().map, submaps_.back().anchor);
+        view_ = view;
+        return view_;
+    }
+
+    /**
+     * @brief Sample the global map, e.g. sample(p) or sample(p, ivm).
+     */
+    template <typename... args_t>
+    inline auto sample(const point_t &p,
+                       args_t&&... args) const -> decltype(std::declval<const map_t&>().sample(p, std::forward<args_t>(args)...))
+    {
+        return getMap()->sample(p, std::forward<args_t>(args)...);
+    }
+
+private:
+    struct submap_t {
+        map_ptr_t           map;
+        pose_t              anchor;
+        mutable map_ptr_t   layer;  /// map in the global frame, empty until composed
+    };
+    using submap_list_t = std::vector<submap_t, Eigen::aligned_allocator<submap_t>>;
+
+    const std::size_t                   scans_per_submap_;
+    std::size_t                         scans_;
+    submap_list_t                       submaps_;
+
+    mutable std::size_t                 composed_;  /// number of submaps contained in base_
+    mutable std::set<std::size_t>       reanchored_;  /// composed submaps whose layer in base_ is stale
+    const std::function<map_ptr_t()>    create_;
+    mutable map_ptr_t                   base_;
+    mutable map_const_ptr_t             view_;
+};
+}
+}
+
+#endif // CSLIBS_NDT_MAP_SUBMAP_MANAGER_HPP
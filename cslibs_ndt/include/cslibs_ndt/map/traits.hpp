@@ -10,13 +10,20 @@
 #include <cslibs_math_3d/algorithms/simple_iterator.hpp>
 
 #include <cslibs_indexed_storage/backends.hpp>
+#include <cslibs_ndt/backend/ring.hpp>
+#include <cslibs_ndt/backend/paged.hpp>
+#include <cslibs_ndt/backend/morton.hpp>
+#include <cslibs_ndt/utility/dda_iterator.hpp>
 namespace cis = cslibs_indexed_storage;
 
 namespace cslibs_ndt {
 namespace map {
 
 namespace tags {
-enum option { static_map, dynamic_map };
+enum option { static_map, dynamic_map, rolling_map };
+
+/// selects the copy-on-write snapshot constructor of a map
+struct snapshot {};
 
 template <option o>
 struct default_types;
@@ -36,6 +43,14 @@ struct default_types<option::dynamic_map> {
     template<typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
     using default_dynamic_backend_t = cis::backend::kdtree::KDTree<data_interface_t_, index_interface_t_, options_ts_...>;
 };
+
+template <>
+struct default_types<option::rolling_map> {
+    template<typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+    using default_backend_t         = cslibs_ndt::backend::Ring<data_interface_t_, index_interface_t_, options_ts_...>;
+    template<typename data_interface_t_, typename index_interface_t_, typename... options_ts_>
+    using default_dynamic_backend_t = cis::backend::kdtree::KDTree<data_interface_t_, index_interface_t_, options_ts_...>;
+};
 }
 
 template <std::size_t Dim, typename T>
@@ -50,6 +65,7 @@ struct traits<2,T>
     using point_t               = cslibs_math_2d::Point2<T>;
     using pointcloud_t          = cslibs_math_2d::Pointcloud2<T>;
     using default_iterator_t    = cslibs_math_2d::algorithms::SimpleIterator<T>;
+    using dda_iterator_t        = cslibs_ndt::utility::DDAIterator<T,2>;
 };
 
 template <typename T>
@@ -61,6 +77,7 @@ struct traits<3,T>
     using point_t               = cslibs_math_3d::Point3<T>;
     using pointcloud_t          = cslibs_math_3d::Pointcloud3<T>;
     using default_iterator_t    = cslibs_math_3d::algorithms::SimpleIterator<T>;
+    using dda_iterator_t        = cslibs_ndt::utility::DDAIterator<T,3>;
 };
 
 }
@@ -35,6 +35,11 @@ auto match(const iterator_t& points_begin,
     std::transform(points_begin, points_end, std::back_inserter(points_prime),
                    [&](const point_t& point) { return initial_transform * point; });
 
+    // scratch space for the points and bundle indices of an iteration
+    std::vector<point_t> points;
+    std::vector<typename ndt_t::index_t> indices;
+    points.reserve(points_prime.size());
+
     // initialize result
     double max_score        = std::numeric_limits<double>::lowest();
     std::size_t iteration   = 0;
@@ -91,11 +96,13 @@ auto match(const iterator_t& points_begin,
 
         double score = 0.0;
         // todo: reimplement parallelization
+        points.clear();
         for (const point_t& point_prime : points_prime)
-        {
-            const point_t point = t * point_prime;
-            traits_t::computeGradient(map, point, J, H, param, score, g, h);
-        }
+            points.emplace_back(t * point_prime);
+        map.toBundleIndices(points.begin(), points.end(), indices);
+
+        for (std::size_t i = 0; i < points.size(); ++i)
+            traits_t::computeGradient(map, points[i], indices[i], J, H, param, score, g, h);
 
         if (score < max_score)
         {
@@ -21,6 +21,7 @@ Required Interface:
 
     using point_t       = void;
     using transform_t   = void;
+    using index_t       = typename MapT::index_t;
 
     static transform_t makeTransform(const Eigen::Matrix<double, LINEAR_DIMS, 1>& linear,
                                      const Eigen::Matrix<double, ANGULAR_DIMS, 1>& angular);
@@ -32,6 +33,16 @@ Required Interface:
                                 double& score,
                                 gradient_t& g,
                                 hessian_t& h);
+
+    // bi is the bundle index of point, computed in batches by match()
+    static void computeGradient(const MapT& map,
+                                const point_t& point,
+                                const index_t& bi,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h);
 };
 */
 }
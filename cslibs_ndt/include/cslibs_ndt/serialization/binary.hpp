@@ -0,0 +1,74 @@
+#ifndef CSLIBS_NDT_SERIALIZATION_BINARY_HPP
+#define CSLIBS_NDT_SERIALIZATION_BINARY_HPP
+
+#include <cslibs_ndt/common/distribution.hpp>
+#include <cslibs_ndt/common/occupancy_distribution.hpp>
+#include <cslibs_ndt/common/weighted_occupancy_distribution.hpp>
+
+#include <cslibs_math/serialization/distribution.hpp>
+#include <cslibs_math/serialization/weighted_distribution.hpp>
+
+#include <fstream>
+
+namespace cslibs_ndt {
+template <typename Tp, template <typename,std::size_t> class T, std::size_t Size>
+void write(const T<Tp,Size> &d, std::ofstream &out)
+{
+    cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(d.data(), out);
+}
+
+template <typename Tp, template <typename,std::size_t> class T, std::size_t Size>
+std::size_t read(std::ifstream &in, T<Tp,Size> &d)
+{
+    return cslibs_math::serialization::distribution::binary<Tp,Size,3>::read(in, d.data());
+}
+
+template<typename Tp, std::size_t Size>
+void write(const OccupancyDistribution<Tp,Size> &d, std::ofstream &out)
+{
+    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
+    if (!d.getDistribution())
+        cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(out);
+    else
+        cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(*(d.getDistribution()), out);
+}
+
+template<typename Tp, std::size_t Size>
+std::size_t read(std::ifstream &in, OccupancyDistribution<Tp,Size> &d)
+{
+    std::size_t f = cslibs_math::serialization::io<std::size_t>::read(in);
+    d = OccupancyDistribution<Tp,Size>(f);
+    typename OccupancyDistribution<Tp,Size>::distribution_t tmp;
+    std::size_t r = cslibs_math::serialization::distribution::binary<Tp,Size,3>::read(in,tmp);
+    if (tmp.getN() != 0)
+        d.getDistribution().reset(new typename OccupancyDistribution<Tp,Size>::distribution_t(tmp));
+    return sizeof(std::size_t) + r;
+}
+
+template<typename Tp, std::size_t Size>
+void write(const WeightedOccupancyDistribution<Tp,Size> &d, std::ofstream &out)
+{
+    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
+    cslibs_math::serialization::io<Tp>::write(d.weightFree(), out);
+    if (!d.getDistribution())
+        cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::write(out);
+    else
+        cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::write(*(d.getDistribution()), out);
+}
+
+template<typename Tp, std::size_t Size>
+std::size_t read(std::ifstream &in, WeightedOccupancyDistribution<Tp,Size> &d)
+{
+    std::size_t n = cslibs_math::serialization::io<std::size_t>::read(in);
+    Tp f = cslibs_math::serialization::io<Tp>::read(in);
+    using distr_t = typename cslibs_math::statistics::WeightedDistribution<Tp,Size,3>;
+    distr_t tmp;
+    std::size_t r = cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::read(in,tmp);
+    d = WeightedOccupancyDistribution<Tp,Size>(n, f);
+    if (tmp.getSampleCount() > 0)
+        d.getDistribution().reset(new distr_t(tmp));
+    return sizeof(std::size_t) + sizeof(Tp) + r;
+}
+}
+
+#endif // CSLIBS_NDT_SERIALIZATION_BINARY_HPP
@@ -0,0 +1,145 @@
+#ifndef CSLIBS_NDT_SERIALIZATION_BUNDLE_INDICES_HPP
+#define CSLIBS_NDT_SERIALIZATION_BUNDLE_INDICES_HPP
+
+#include <cslibs_ndt/utility/morton.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace serialization {
+/**
+ * @brief Compact binary encoding of bundle indices. The indices are sorted by
+ *        their Morton code and the differences of consecutive codes are stored
+ *        as LEB128 varints, preceded by the number of indices. Neighbouring
+ *        bundles mostly take one or two bytes.
+ */
+template <std::size_t Dim>
+struct bundle_indices {
+    using index_t = std::array<int, Dim>;
+
+    /// indices outside of the range of the Morton code can not be encoded
+    inline static bool encodable(const index_t &index)
+    {
+        constexpr int64_t bias = static_cast<int64_t>(1ll) << (utility::morton<Dim>::bits - 1ul);
+        for (std::size_t i=0; i<Dim; ++i)
+            if (index[i] < -bias || index[i] >= bias)
+                return false;
+        return true;
+    }
+
+    inline static bool encode(const std::vector<index_t> &indices,
+                              std::vector<char> &data)
+    {
+        std::vector<uint64_t> codes;
+        codes.reserve(indices.size());
+        for (const index_t &index : indices) {
+            if (!encodable(index))
+                return false;
+            codes.emplace_back(utility::morton_code<Dim>(index));
+        }
+        std::sort(codes.begin(), codes.end());
+
+        data.clear();
+        data.reserve(2ul * codes.size() + 10ul);
+        write(codes.size(), data);
+        uint64_t last = 0ull;
+        for (const uint64_t code : codes) {
+            write(code - last, data);
+            last = code;
+        }
+        return true;
+    }
+
+    inline static bool decode(const char *data,
+                              const std::size_t size,
+                              std::vector<index_t> &indices)
+    {
+        std::size_t pos = 0;
+        uint64_t count;
+        if (!read(data, size, pos, count) || count > size)
+            return false;
+
+        indices.clear();
+        indices.reserve(count);
+        uint64_t code = 0ull;
+        for (uint64_t i=0; i<count; ++i) {
+            uint64_t delta;
+            if (!read(data, size, pos, delta))
+                return false;
+            code += delta;
+            indices.emplace_back(utility::morton_index<Dim>(code));
+        }
+        return pos == size;
+    }
+
+    inline static bool save(const std::vector<index_t> &indices,
+                            const boost::filesystem::path &path)
+    {
+        std::vector<char> data;
+        if (!encode(indices, data))
+            return false;
+
+        std::ofstream out(path.string(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Could not open '" << path.string() << std::endl;
+            return false;
+        }
+        out.write(data.data(), data.size());
+        return out.good();
+    }
+
+    inline static bool load(const boost::filesystem::path &path,
+                            std::vector<index_t> &indices)
+    {
+        std::ifstream in(path.string(), std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "Could not open '" << path.string() << std::endl;
+            return false;
+        }
+
+        const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!decode(data.data(), data.size(), indices)) {
+            std::cerr << "Corrupt bundle indices in '" << path.string() << "'" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    inline static void write(uint64_t v,
+                             std::vector<char> &data)
+    {
+        while (v >= 0x80ull) {
+            data.push_back(static_cast<char>((v & 0x7full) | 0x80ull));
+            v >>= 7;
+        }
+        data.push_back(static_cast<char>(v));
+    }
+
+    inline static bool read(const char *data,
+                            const std::size_t size,
+                            std::size_t &pos,
+                            uint64_t &v)
+    {
+        v = 0ull;
+        for (std::size_t shift=0; shift<64ul && pos<size; shift+=7) {
+            const uint64_t byte = static_cast<unsigned char>(data[pos++]);
+            v |= (byte & 0x7full) << shift;
+            if (!(byte & 0x80ull))
+                return true;
+        }
+        return false;
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_SERIALIZATION_BUNDLE_INDICES_HPP
@@ -0,0 +1,281 @@
+#ifndef CSLIBS_NDT_SERIALIZATION_CONTAINER_HPP
+#define CSLIBS_NDT_SERIALIZATION_CONTAINER_HPP
+
+#include <cslibs_ndt/common/distribution.hpp>
+#include <cslibs_ndt/common/occupancy_distribution.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cslibs_ndt {
+namespace serialization {
+/**
+ * @brief Single file map container, the layout is
+ *          header | section table | padding | section | padding | section ...
+ *        with every section starting at a multiple of page_size, so that each
+ *        can be mapped and read in place. There is one meta section (yaml),
+ *        one section of bundle indices and per bin an index and a data section,
+ *        the k-th record of the data section belongs to the k-th index, all
+ *        records have the same size. Values are stored in host byte order.
+ */
+namespace container {
+const char          magic[8]    = {'C','S','N','D','T','M','A','P'};
+const std::uint32_t version     = 1;
+const std::uint32_t page_size   = 4096;
+
+enum class section_type : std::uint32_t { META = 0, BUNDLES = 1, INDEX = 2, DATA = 3 };
+
+struct header_t {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t dim;
+    std::uint32_t bin_count;
+    std::uint32_t scalar_size;
+    std::uint32_t record_size;
+    std::uint32_t page_size;
+    std::uint32_t section_count;
+    std::uint32_t reserved;
+};
+
+struct section_t {
+    section_type  type;
+    std::uint32_t id;
+    std::uint64_t offset;
+    std::uint64_t size;
+    std::uint64_t count;
+};
+
+inline std::uint64_t align(const std::uint64_t offset)
+{
+    return (offset + page_size - 1) / page_size * page_size;
+}
+
+/**
+ * @brief Fixed size binary record of a distribution.
+ */
+template <typename data_t>
+struct record {};
+
+template <typename T, std::size_t Dim>
+struct record<cslibs_ndt::Distribution<T,Dim>> {
+    using data_t         = cslibs_ndt::Distribution<T,Dim>;
+    using distribution_t = typename data_t::distribution_t;
+    static const std::size_t size = sizeof(std::uint64_t) + (Dim + Dim * Dim) * sizeof(T);
+
+    inline static void write(const distribution_t &d, char *out)
+    {
+        const std::uint64_t n = d.getN();
+        const typename distribution_t::sample_t     mean = d.getMean();
+        const typename distribution_t::covariance_t corr = d.getCorrelated();
+        std::memcpy(out, &n, sizeof(n));
+        std::memcpy(out + sizeof(n), mean.data(), Dim * sizeof(T));
+        std::memcpy(out + sizeof(n) + Dim * sizeof(T), corr.data(), Dim * Dim * sizeof(T));
+    }
+
+    inline static distribution_t read(const char *in)
+    {
+        std::uint64_t n;
+        typename distribution_t::sample_t     mean;
+        typename distribution_t::covariance_t corr;
+        std::memcpy(&n, in, sizeof(n));
+        std::memcpy(mean.data(), in + sizeof(n), Dim * sizeof(T));
+        std::memcpy(corr.data(), in + sizeof(n) + Dim * sizeof(T), Dim * Dim * sizeof(T));
+        return n == 0 ? distribution_t() : distribution_t(n, mean, corr);
+    }
+
+    inline static void write(const data_t &d, char *out)
+    {
+        write(d.data(), out);
+    }
+
+    inline static void read(const char *in, data_t &d)
+    {
+        d.data() = read(in);
+    }
+};
+
+template <typename T, std::size_t Dim>
+struct record<cslibs_ndt::OccupancyDistribution<T,Dim>> {
+    using data_t         = cslibs_ndt::OccupancyDistribution<T,Dim>;
+    using distribution_t = record<cslibs_ndt::Distribution<T,Dim>>;
+    static const std::size_t size = sizeof(std::uint64_t) + distribution_t::size;
+
+    inline static void write(const data_t &d, char *out)
+    {
+        const std::uint64_t f = d.numFree();
+        std::memcpy(out, &f, sizeof(f));
+        distribution_t::write(d.getDistribution() ? *d.getDistribution() : typename data_t::distribution_t(),
+                              out + sizeof(f));
+    }
+
+    inline static void read(const char *in, data_t &d)
+    {
+        std::uint64_t f;
+        std::memcpy(&f, in, sizeof(f));
+        const typename data_t::distribution_t occupied = distribution_t::read(in + sizeof(f));
+        d = occupied.getN() == 0 ? data_t(f) : data_t(f, occupied);
+    }
+};
+
+/**
+ * @brief Collects the sections of a container and writes them in one go.
+ */
+class Writer
+{
+public:
+    inline void add(const section_type type,
+                    const std::uint32_t id,
+                    std::vector<char> &&data,
+                    const std::uint64_t count)
+    {
+        sections_.emplace_back(section_t{type, id, 0, data.size(), count});
+        data_.emplace_back(std::move(data));
+    }
+
+    inline bool write(const std::string &path,
+                      header_t header)
+    {
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version       = version;
+        header.page_size     = page_size;
+        header.section_count = static_cast<std::uint32_t>(sections_.size());
+
+        std::uint64_t offset = align(sizeof(header_t) + sections_.size() * sizeof(section_t));
+        for (section_t &s : sections_) {
+            s.offset = offset;
+            offset   = align(offset + s.size);
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "[Container]: Could not open '" << path << "'." << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header_t));
+        out.write(reinterpret_cast<const char*>(sections_.data()), sections_.size() * sizeof(section_t));
+        for (std::size_t i = 0 ; i < sections_.size() ; ++i) {
+            out.seekp(static_cast<std::streamoff>(sections_[i].offset));
+            out.write(data_[i].data(), data_[i].size());
+        }
+        /// the last section is padded as well, so every section can be mapped by pages
+        out.seekp(static_cast<std::streamoff>(offset - 1));
+        out.put(0);
+        return out.good();
+    }
+
+private:
+    std::vector<section_t>          sections_;
+    std::vector<std::vector<char>>  data_;
+};
+
+/**
+ * @brief Read only memory mapping of a container, sections are accessed in
+ *        place without copies.
+ */
+class Reader
+{
+public:
+    inline Reader() :
+        data_(nullptr),
+        size_(0)
+    {
+    }
+
+    inline ~Reader()
+    {
+        if (data_)
+            ::munmap(data_, size_);
+    }
+
+    Reader(const Reader &other) = delete;
+    Reader& operator = (const Reader &other) = delete;
+
+    inline bool open(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "[Container]: Could not open '" << path << "'." << std::endl;
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(header_t)) {
+            std::cerr << "[Container]: '" << path << "' is no map container." << std::endl;
+            ::close(fd);
+            return false;
+        }
+
+        size_ = static_cast<std::size_t>(st.st_size);
+        void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "[Container]: Could not map '" << path << "'." << std::endl;
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<char*>(data);
+        ::madvise(data_, size_, MADV_WILLNEED);
+
+        const header_t &h = header();
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version ||
+                h.section_count > (size_ - sizeof(header_t)) / sizeof(section_t)) {
+            std::cerr << "[Container]: '" << path << "' is no map container of version " << version << "." << std::endl;
+            return false;
+        }
+        for (std::size_t i = 0 ; i < h.section_count ; ++i) {
+            const section_t &s = sections()[i];
+            if (s.offset > size_ || s.size > size_ - s.offset) {
+                std::cerr << "[Container]: '" << path << "' is truncated." << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline const header_t& header() const
+    {
+        return *reinterpret_cast<const header_t*>(data_);
+    }
+
+    inline const section_t* sections() const
+    {
+        return reinterpret_cast<const section_t*>(data_ + sizeof(header_t));
+    }
+
+    /**
+     * @brief Get a section by type and id.
+     * @return the section or nullptr if the container does not have it
+     */
+    inline const section_t* find(const section_type type,
+                                 const std::uint32_t id = 0) const
+    {
+        for (std::size_t i = 0 ; i < header().section_count ; ++i)
+            if (sections()[i].type == type && sections()[i].id == id)
+                return &sections()[i];
+        return nullptr;
+    }
+
+    inline const char* data(const section_t &s) const
+    {
+        return data_ + s.offset;
+    }
+
+private:
+    char        *data_;
+    std::size_t  size_;
+};
+}
+}
+}
+
+#endif // CSLIBS_NDT_SERIALIZATION_CONTAINER_HPP
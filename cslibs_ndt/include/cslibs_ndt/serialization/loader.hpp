@@ -55,6 +55,39 @@ struct loader<cslibs_ndt::map::tags::static_map,Dim,data_t,T,backend_t,dynamic_b
         return binary_t::load(path, storage, size_ + off, offset);
     }
 
+    /// empty storage with the extent load() uses
+    inline void allocate(const std::size_t i, storage_t &storage) const
+    {
+        const std::size_t off = (i > 1ul) ? 1ul : 0ul;
+        index_t offset;
+        for (std::size_t i=0; i<Dim; ++i)
+            offset[i] = cslibs_math::common::div<int>(min_index_[i], 2);
+        storage.reset(new typename storage_t::element_type);
+        storage->template set<cis::option::tags::array_size>(size_ + off);
+        storage->template set<cis::option::tags::array_offset>(offset);
+    }
+
+    /// whether index lies within the extent allocate() gives storage i
+    inline bool contains(const std::size_t i, const index_t &index) const
+    {
+        const std::size_t off = (i > 1ul) ? 1ul : 0ul;
+        for (std::size_t j = 0 ; j < Dim ; ++j) {
+            const int offset = cslibs_math::common::div<int>(min_index_[j], 2);
+            if (index[j] < offset || index[j] >= offset + static_cast<int>(size_[j] + off))
+                return false;
+        }
+        return true;
+    }
+
+    /// whether bi lies within the extent allocateBundles() gives the bundle storage
+    inline bool containsBundle(const index_t &bi) const
+    {
+        for (std::size_t j = 0 ; j < Dim ; ++j)
+            if (bi[j] < min_index_[j] || bi[j] >= min_index_[j] + static_cast<int>(size_[j] * 2ul))
+                return false;
+        return true;
+    }
+
     inline void allocateBundles(const std::shared_ptr<bundle_storage_t>& bundles,
                                 const storages_t& storages) const
     {
@@ -121,6 +154,21 @@ struct loader<cslibs_ndt::map::tags::dynamic_map,Dim,data_t,T,backend_t,dynamic_
         return binary_t::load(path, storage);
     }
 
+    inline void allocate(const std::size_t, storage_t &storage) const
+    {
+        storage.reset(new typename storage_t::element_type);
+    }
+
+    inline bool contains(const std::size_t, const index_t &) const
+    {
+        return true;
+    }
+
+    inline bool containsBundle(const index_t &) const
+    {
+        return true;
+    }
+
     inline void allocateBundles(const std::shared_ptr<bundle_storage_t>& bundles,
                                 const storages_t& storages) const
     {
@@ -175,23 +223,25 @@ struct header<cslibs_ndt::map::tags::static_map,Dim,data_t,T,backend_t,dynamic_b
     using size_t   = typename map_t::size_t;
     using loader_t = loader<cslibs_ndt::map::tags::static_map,Dim,data_t,T,backend_t,dynamic_backend_t>;
 
+    /// scalar meta data only, bundle indices are stored by the caller
     static inline void write(const typename map_t::Ptr &map, YAML::Node &n)
     {
-        std::vector<index_t> indices;
-        map->getBundleIndices(indices);
         n["origin"]     = map->getInitialOrigin();
         n["resolution"] = map->getResolution();
         n["size"]       = map->getSize();
         n["min_index"]  = map->getMinBundleIndex();
-        n["bundles"]    = indices;
     }
 
     static inline loader_t load(const YAML::Node& n) {
+        return load(n, n["bundles"].as<std::vector<index_t>>());
+    }
+
+    /// bundle indices stored elsewhere, e.g. in a binary container
+    static inline loader_t load(const YAML::Node& n, const std::vector<index_t> &indices) {
         const pose_t               origin     = n["origin"].as<pose_t>();
         const T                    resolution = n["resolution"].as<T>();
         const size_t               size       = n["size"].as<size_t>();
         const index_t              min_index  = n["min_index"].as<index_t>();
-        const std::vector<index_t> indices    = n["bundles"].as<std::vector<index_t>>();
 
         return loader_t(origin,resolution,size,min_index,indices);
     }
@@ -208,23 +258,25 @@ struct header<cslibs_ndt::map::tags::dynamic_map,Dim,data_t,T,backend_t,dynamic_
     using pose_t   = typename map_t::pose_t;
     using loader_t = loader<cslibs_ndt::map::tags::dynamic_map,Dim,data_t,T,backend_t,dynamic_backend_t>;
 
+    /// scalar meta data only, bundle indices are stored by the caller
     static inline void write(const typename map_t::Ptr &map, YAML::Node &n)
     {
-        std::vector<index_t> indices;
-        map->getBundleIndices(indices);
         n["origin"]     = map->getInitialOrigin();
         n["resolution"] = map->getResolution();
         n["min_index"]  = map->getMinBundleIndex();
         n["max_index"]  = map->getMaxBundleIndex();
-        n["bundles"]    = indices;
     }
 
     static inline loader_t load(const YAML::Node& n) {
+        return load(n, n["bundles"].as<std::vector<index_t>>());
+    }
+
+    /// bundle indices stored elsewhere, e.g. in a binary container
+    static inline loader_t load(const YAML::Node& n, const std::vector<index_t> &indices) {
         const pose_t               origin     = n["origin"].as<pose_t>();
         const T                    resolution = n["resolution"].as<T>();
         const index_t              min_index  = n["min_index"].as<index_t>();
         const index_t              max_index  = n["max_index"].as<index_t>();
-        const std::vector<index_t> indices    = n["bundles"].as<std::vector<index_t>>();
 
         return loader_t(origin,resolution,min_index,max_index,indices);
     }
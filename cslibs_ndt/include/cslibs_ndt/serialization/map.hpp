@@ -6,6 +6,8 @@
 
 #include <cslibs_ndt/serialization/filesystem.hpp>
 #include <cslibs_ndt/serialization/storage.hpp>
+#include <cslibs_ndt/serialization/container.hpp>
+#include <cslibs_ndt/serialization/bundle_indices.hpp>
 
 #include <cslibs_math_2d/serialization/transform.hpp>
 #include <cslibs_math_3d/serialization/transform.hpp>
@@ -33,7 +35,7 @@ inline bool saveBinary(const typename cslibs_ndt::map::Map<option_t,Dim,data_t,T
     using map_t      = cslibs_ndt::map::Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>;
     using paths_t    = std::array<path_t, map_t::bin_count>;
     using binary_t   = cslibs_ndt::binary<data_t, T, Dim, Dim, backend_t>;
-    using storages_t = typename map_t::distribution_storage_array_t;
+    using write_t    = typename binary_t::write_t;
 
     /// step one: check if the root diretory exists
     path_t path_root(path);
@@ -46,24 +48,31 @@ inline bool saveBinary(const typename cslibs_ndt::map::Map<option_t,Dim,data_t,T
         paths[i] = path_root / path_t("store_" + std::to_string(i) + ".bin");
 
     /// step three: we have our filesystem, now we write out the distributions file by file
-    /// meta file
+    /// meta file, bundle indices go to a binary file unless they are out of its range
     const path_t path_file = path_t("map.yaml");
     {
-        std::ofstream out((path_root / path_file).string(), std::fstream::trunc);
-        YAML::Emitter yaml(out);
+        std::vector<typename map_t::index_t> indices;
+        map->getBundleIndices(indices);
+
         YAML::Node n;
         header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::write(map,n);
+        if (!bundle_indices<Dim>::save(indices, path_root / path_t("bundles.bin")))
+            n["bundles"] = indices;
+
+        std::ofstream out((path_root / path_file).string(), std::fstream::trunc);
+        YAML::Emitter yaml(out);
         yaml << n;
     }
 
-    /// step four: write out the storages
-    storages_t storages = map->getStorages();
-
+    /// step four: write out the storages, evicted tiles of a memory budget are streamed
     std::array<std::thread, map_t::bin_count> threads;
     std::atomic_bool success(true);
     for (std::size_t i = 0 ; i < map_t::bin_count; ++i)
-        threads[i] = std::thread([&storages, &paths, i, &success](){
-            success = success && binary_t::save(storages[i], paths[i]);
+        threads[i] = std::thread([&map, &paths, i, &success](){
+            auto traverse = [&map, i](const write_t &write) {
+                map->traverseDistributions(i, write);
+            };
+            success = success && binary_t::save(traverse, paths[i]);
         });
     for (std::size_t i = 0 ; i < map_t::bin_count; ++i)
         if (threads[i].joinable())
@@ -108,9 +117,14 @@ inline bool loadBinary(const std::string &path,
     std::shared_ptr<bundle_storage_t> bundles(new bundle_storage_t);
     storages_t storages;
 
+    /// maps saved before bundles.bin list their bundles in the yaml file
     YAML::Node n = YAML::LoadFile((path_root / path_file).string());
-    const loader<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> l =
-            header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::load(n);
+    std::vector<typename map_t::index_t> indices;
+    if (!n["bundles"] && !bundle_indices<Dim>::load(path_root / path_t("bundles.bin"), indices))
+        return false;
+    const loader<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> l = n["bundles"] ?
+            header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::load(n) :
+            header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::load(n, indices);
 
     std::array<std::thread, map_t::bin_count> threads;
     std::atomic_bool success(true);
@@ -131,6 +145,178 @@ inline bool loadBinary(const std::string &path,
     return true;
 }
 
+/**
+ * @brief Save a map into a single container file, see container.hpp. Meta
+ *        data is kept as yaml, bundle indices and distributions are stored as
+ *        fixed size binary records.
+ */
+template <map::tags::option option_t,
+          std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class backend_t = map::tags::default_types<option_t>::template default_backend_t,
+          template <typename, typename, typename...> class dynamic_backend_t = map::tags::default_types<option_t>::template default_dynamic_backend_t>
+inline bool saveContainer(const typename cslibs_ndt::map::Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::Ptr &map,
+                          const std::string &path)
+{
+    using map_t      = cslibs_ndt::map::Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>;
+    using index_t    = typename map_t::index_t;
+    using record_t   = container::record<data_t<T,Dim>>;
+    using type_t     = container::section_type;
+
+    container::Writer writer;
+    {
+        YAML::Emitter yaml;
+        YAML::Node n;
+        header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::write(map,n);
+        yaml << n;
+        writer.add(type_t::META, 0, std::vector<char>(yaml.c_str(), yaml.c_str() + yaml.size()), 1);
+    }
+    {
+        std::vector<index_t> indices;
+        map->getBundleIndices(indices);
+        std::vector<char> data(indices.size() * sizeof(index_t));
+        if (!indices.empty())
+            std::memcpy(data.data(), indices.data(), data.size());
+        writer.add(type_t::BUNDLES, 0, std::move(data), indices.size());
+    }
+
+    /// encode the storages in parallel, evicted tiles of a memory budget are streamed
+    std::array<std::vector<char>, map_t::bin_count> indices;
+    std::array<std::vector<char>, map_t::bin_count> records;
+    std::array<std::size_t, map_t::bin_count>       counts;
+    std::array<std::thread, map_t::bin_count> threads;
+    for (std::size_t i = 0 ; i < map_t::bin_count; ++i)
+        threads[i] = std::thread([&map, &indices, &records, &counts, i](){
+            std::size_t k = 0;
+            map->traverseDistributions(i, [&indices, &records, i, &k](const index_t &index, const data_t<T,Dim> &data) {
+                indices[i].resize((k + 1) * sizeof(index_t));
+                records[i].resize((k + 1) * record_t::size);
+                std::memcpy(indices[i].data() + k * sizeof(index_t), index.data(), sizeof(index_t));
+                record_t::write(data, records[i].data() + k * record_t::size);
+                ++ k;
+            });
+            counts[i] = k;
+        });
+    for (std::size_t i = 0 ; i < map_t::bin_count; ++i)
+        threads[i].join();
+
+    for (std::size_t i = 0 ; i < map_t::bin_count; ++i) {
+        writer.add(type_t::INDEX, static_cast<std::uint32_t>(i), std::move(indices[i]), counts[i]);
+        writer.add(type_t::DATA,  static_cast<std::uint32_t>(i), std::move(records[i]), counts[i]);
+    }
+
+    container::header_t h;
+    h.dim         = Dim;
+    h.bin_count   = map_t::bin_count;
+    h.scalar_size = sizeof(T);
+    h.record_size = record_t::size;
+    h.reserved    = 0;
+    return writer.write(path, h);
+}
+
+/**
+ * @brief Load a map from a single container file. The file is memory mapped,
+ *        the storages are filled in parallel directly from the mapped records
+ *        without parsing.
+ */
+template <map::tags::option option_t,
+          std::size_t Dim,
+          template <typename,std::size_t> class data_t,
+          typename T,
+          template <typename, typename, typename...> class backend_t = map::tags::default_types<option_t>::template default_backend_t,
+          template <typename, typename, typename...> class dynamic_backend_t = map::tags::default_types<option_t>::template default_dynamic_backend_t>
+inline bool loadContainer(const std::string &path,
+                          typename cslibs_ndt::map::Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::Ptr &map)
+{
+    using map_t             = cslibs_ndt::map::Map<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>;
+    using index_t           = typename map_t::index_t;
+    using record_t          = container::record<data_t<T,Dim>>;
+    using bundle_storage_t  = typename map_t::distribution_bundle_storage_t;
+    using storages_t        = typename map_t::distribution_storage_array_t;
+    using type_t            = container::section_type;
+
+    container::Reader reader;
+    if (!reader.open(path))
+        return false;
+
+    const container::header_t &h = reader.header();
+    if (h.dim != Dim || h.bin_count != map_t::bin_count || h.scalar_size != sizeof(T) || h.record_size != record_t::size) {
+        std::cerr << "[Container]: '" << path << "' holds a different map type." << std::endl;
+        return false;
+    }
+
+    const container::section_t *meta    = reader.find(type_t::META);
+    const container::section_t *bundles = reader.find(type_t::BUNDLES);
+    std::array<const container::section_t*, map_t::bin_count> index_sections;
+    std::array<const container::section_t*, map_t::bin_count> data_sections;
+    /// count records of record_size, without overflowing on corrupted counts
+    auto holds = [](const container::section_t *s, const std::uint64_t count, const std::size_t record_size) {
+        return s && s->size % record_size == 0 && s->size / record_size == count;
+    };
+    bool complete = meta && holds(bundles, bundles ? bundles->count : 0, sizeof(index_t));
+    for (std::size_t i = 0 ; i < map_t::bin_count ; ++i) {
+        index_sections[i] = reader.find(type_t::INDEX, static_cast<std::uint32_t>(i));
+        data_sections[i]  = reader.find(type_t::DATA,  static_cast<std::uint32_t>(i));
+        complete = complete && index_sections[i] &&
+                   holds(index_sections[i], index_sections[i]->count, sizeof(index_t)) &&
+                   holds(data_sections[i],  index_sections[i]->count, record_t::size);
+    }
+    if (!complete) {
+        std::cerr << "[Container]: '" << path << "' is missing sections." << std::endl;
+        return false;
+    }
+
+    std::vector<index_t> indices(bundles->count);
+    if (!indices.empty())
+        std::memcpy(indices.data(), reader.data(*bundles), bundles->size);
+
+    const YAML::Node n = YAML::Load(std::string(reader.data(*meta), meta->size));
+    const loader<option_t,Dim,data_t,T,backend_t,dynamic_backend_t> l =
+            header<option_t,Dim,data_t,T,backend_t,dynamic_backend_t>::load(n, indices);
+
+    for (const index_t &bi : indices) {
+        if (!l.containsBundle(bi)) {
+            std::cerr << "[Container]: '" << path << "' holds bundles outside of its extent." << std::endl;
+            return false;
+        }
+    }
+
+    /// an insert outside of the storage extent would throw inside the thread
+    storages_t storages;
+    std::atomic<bool> valid(true);
+    std::array<std::thread, map_t::bin_count> threads;
+    for (std::size_t i = 0 ; i < map_t::bin_count ; ++i) {
+        threads[i] = std::thread([&l, &reader, &storages, &index_sections, &data_sections, &valid, i](){
+            l.allocate(i, storages[i]);
+            const char *index_data  = reader.data(*index_sections[i]);
+            const char *record_data = reader.data(*data_sections[i]);
+            for (std::size_t k = 0 ; k < index_sections[i]->count ; ++k) {
+                index_t index;
+                data_t<T,Dim> data;
+                std::memcpy(index.data(), index_data + k * sizeof(index_t), sizeof(index_t));
+                if (!l.contains(i, index)) {
+                    valid = false;
+                    return;
+                }
+                record_t::read(record_data + k * record_t::size, data);
+                storages[i]->insert(index, data);
+            }
+        });
+    }
+    for (std::size_t i = 0 ; i < map_t::bin_count ; ++i)
+        threads[i].join();
+    if (!valid) {
+        std::cerr << "[Container]: '" << path << "' holds distributions outside of its extent." << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<bundle_storage_t> bundle_storage(new bundle_storage_t);
+    l.allocateBundles(bundle_storage, storages);
+    l.setMap(map, bundle_storage, storages);
+    return true;
+}
+
 }
 }
 
@@ -5,90 +5,42 @@
 #include <cslibs_indexed_storage/backend/kdtree/kdtree.hpp>
 #include <cslibs_indexed_storage/backend/array/array.hpp>
 
-#include <cslibs_ndt/common/distribution.hpp>
-#include <cslibs_ndt/common/occupancy_distribution.hpp>
-#include <cslibs_ndt/common/weighted_occupancy_distribution.hpp>
+#include <cslibs_ndt/serialization/binary.hpp>
 #include <cslibs_ndt/serialization/filesystem.hpp>
+#include <cslibs_ndt/backend/storage.hpp>
 
 #include <cslibs_math/serialization/array.hpp>
-#include <cslibs_math/serialization/distribution.hpp>
-#include <cslibs_math/serialization/weighted_distribution.hpp>
 
 #include <fstream>
+#include <functional>
 #include <yaml-cpp/yaml.h>
 
 namespace cis = cslibs_indexed_storage;
 
 namespace cslibs_ndt {
-template <typename Tp, template <typename,std::size_t> class T, std::size_t Size>
-void write(const T<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(d.data(), out);
-}
-
-template <typename Tp, template <typename,std::size_t> class T, std::size_t Size>
-std::size_t read(std::ifstream &in, T<Tp,Size> &d)
-{
-    return cslibs_math::serialization::distribution::binary<Tp,Size,3>::read(in, d.data());
-}
-
-template<typename Tp, std::size_t Size>
-void write(const OccupancyDistribution<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
-    if (!d.getDistribution())
-        cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(out);
-    else
-        cslibs_math::serialization::distribution::binary<Tp,Size,3>::write(*(d.getDistribution()), out);
-}
-
-template<typename Tp, std::size_t Size>
-std::size_t read(std::ifstream &in, OccupancyDistribution<Tp,Size> &d)
-{
-    std::size_t f = cslibs_math::serialization::io<std::size_t>::read(in);
-    d = OccupancyDistribution<Tp,Size>(f);
-    typename OccupancyDistribution<Tp,Size>::distribution_t tmp;
-    std::size_t r = cslibs_math::serialization::distribution::binary<Tp,Size,3>::read(in,tmp);
-    if (tmp.getN() != 0)
-        d.getDistribution().reset(new typename OccupancyDistribution<Tp,Size>::distribution_t(tmp));
-    return sizeof(std::size_t) + r;
-}
-
-template<typename Tp, std::size_t Size>
-void write(const WeightedOccupancyDistribution<Tp,Size> &d, std::ofstream &out)
-{
-    cslibs_math::serialization::io<std::size_t>::write(d.numFree(), out);
-    cslibs_math::serialization::io<Tp>::write(d.weightFree(), out);
-    if (!d.getDistribution())
-        cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::write(out);
-    else
-        cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::write(*(d.getDistribution()), out);
-}
-
-template<typename Tp, std::size_t Size>
-std::size_t read(std::ifstream &in, WeightedOccupancyDistribution<Tp,Size> &d)
-{
-    std::size_t n = cslibs_math::serialization::io<std::size_t>::read(in);
-    Tp f = cslibs_math::serialization::io<Tp>::read(in);
-    using distr_t = typename cslibs_math::statistics::WeightedDistribution<Tp,Size,3>;
-    distr_t tmp;
-    std::size_t r = cslibs_math::serialization::weighted_distribution::binary<Tp,Size,3>::read(in,tmp);
-    d = WeightedOccupancyDistribution<Tp,Size>(n, f);
-    if (tmp.getSampleCount() > 0)
-        d.getDistribution().reset(new distr_t(tmp));
-    return sizeof(std::size_t) + sizeof(Tp) + r;
-}
-
 template <template <typename,std::size_t> class T, typename Tp, std::size_t Size, std::size_t Dim,
           template <typename, typename, typename...> class backend_t>
 struct binary {
     using index_t   = std::array<int, Dim>;
     using size_t    = std::array<std::size_t, Dim>;
     using data_t    = T<Tp,Size>;
-    using storage_t = cis::Storage<data_t, index_t, backend_t>;
+    using storage_t = typename cslibs_ndt::backend::storage<data_t, index_t, backend_t>::type;
+
+    using write_t   = std::function<void(const index_t &, const data_t &)>;
 
     inline static bool save(const std::shared_ptr<storage_t> &storage,
                             const boost::filesystem::path        &path)
+    {
+        return save([&storage](const write_t &write) { storage->traverse(write); }, path);
+    }
+
+    /**
+     * @brief Save the distributions traverse(write) hands to write, e.g. the
+     *        ones of a map with evicted tiles, see AbstractMap::traverseDistributions.
+     */
+    template <typename traverse_t>
+    inline static bool save(const traverse_t                &traverse,
+                            const boost::filesystem::path   &path)
     {
         std::ofstream out(path.string(), std::ios::binary | std::ios::trunc);
         if (!out.is_open()) {
@@ -96,11 +48,11 @@ struct binary {
             return false;
         }
 
-        auto write = [&out] (const index_t &index, const data_t &data) {
+        const write_t write = [&out] (const index_t &index, const data_t &data) {
             cslibs_math::serialization::array::binary<int, Dim>::write(index, out);
             cslibs_ndt::write(data, out);
         };
-        storage->traverse(write);
+        traverse(write);
         out.close();
         return true;
     }
@@ -0,0 +1,129 @@
+#ifndef CSLIBS_NDT_SERIALIZATION_TILE_STORE_HPP
+#define CSLIBS_NDT_SERIALIZATION_TILE_STORE_HPP
+
+#include <array>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <cslibs_ndt/serialization/binary.hpp>
+
+#include <cslibs_math/serialization/array.hpp>
+
+namespace cslibs_ndt {
+namespace serialization {
+/**
+ * @brief On-disk store for map tiles, one file per tile. Files are append only,
+ *        every record is a storage id (bin or bundle), an index and for bins
+ *        the distribution in the binary encoding of serialization/storage.hpp.
+ *        Later records overwrite earlier ones when a tile is read.
+ */
+template <typename data_t, std::size_t Dim, std::size_t bin_count>
+class TileStore
+{
+public:
+    using index_t                   = std::array<int, Dim>;
+    using distribution_records_t    = std::array<std::vector<std::pair<index_t, const data_t*>>, bin_count>;
+
+    struct tile_t {
+        std::vector<index_t>                            bundles;
+        std::array<std::map<index_t, data_t>, bin_count> distributions;
+    };
+
+    inline explicit TileStore(const std::string &directory) :
+        directory_(directory)
+    {
+    }
+
+    inline ~TileStore()
+    {
+        for (const index_t &tile : written_)
+            std::remove(path(tile).c_str());
+    }
+
+    TileStore(const TileStore &other) = delete;
+    TileStore& operator = (const TileStore &other) = delete;
+
+    inline bool append(const index_t                &tile,
+                       const std::vector<index_t>   &bundles,
+                       const distribution_records_t &distributions)
+    {
+        std::ofstream out(path(tile), std::ios::binary | std::ios::app);
+        if (!out.is_open()) {
+            std::cerr << "[TileStore]: Could not open '" << path(tile) << "'." << std::endl;
+            return false;
+        }
+        written_.insert(tile);
+
+        for (const index_t &bi : bundles) {
+            cslibs_math::serialization::io<std::size_t>::write(bin_count, out);
+            cslibs_math::serialization::array::binary<int, Dim>::write(bi, out);
+        }
+        for (std::size_t i=0; i<bin_count; ++i) {
+            for (const auto &record : distributions[i]) {
+                cslibs_math::serialization::io<std::size_t>::write(i, out);
+                cslibs_math::serialization::array::binary<int, Dim>::write(record.first, out);
+                cslibs_ndt::write(*record.second, out);
+            }
+        }
+        return out.good();
+    }
+
+    inline bool read(const index_t &tile,
+                     tile_t        &t) const
+    {
+        std::ifstream in(path(tile), std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        try {
+            in.seekg (0, std::ios::end);
+            const std::size_t size = in.tellg();
+            in.seekg (0, std::ios::beg);
+            std::size_t read = 0;
+            while (read < size) {
+                const std::size_t id = cslibs_math::serialization::io<std::size_t>::read(in);
+                index_t index;
+                read += sizeof(std::size_t);
+                read += cslibs_math::serialization::array::binary<int, Dim>::read(in, index);
+                if (id == bin_count) {
+                    t.bundles.emplace_back(index);
+                } else {
+                    data_t data;
+                    read += cslibs_ndt::read(in, data);
+                    t.distributions[id][index] = data;
+                }
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "[TileStore]: Failed reading file '" << e.what() << "'." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    inline void remove(const index_t &tile)
+    {
+        std::remove(path(tile).c_str());
+        written_.erase(tile);
+    }
+
+private:
+    const std::string directory_;
+    std::set<index_t> written_;
+
+    inline std::string path(const index_t &tile) const
+    {
+        std::string p = directory_ + "/tile";
+        for (std::size_t i=0; i<Dim; ++i)
+            p += "_" + std::to_string(tile[i]);
+        return p + ".bin";
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_SERIALIZATION_TILE_STORE_HPP
@@ -3,6 +3,10 @@
 
 #include <cslibs_ndt/utility/integer_sequence.hpp>
 
+#include <array>
+#include <cstdint>
+#include <functional>
+
 #include <cslibs_math/common/div.hpp>
 #include <cslibs_math/common/mod.hpp>
 
@@ -51,6 +55,48 @@ inline constexpr list_t generate_indices(const index_t &bi)
     return generate_indices_helper<list_t,index_t>(bi,integers{});
 }
 
+/**
+ * @brief Deterministic id of a bundle, its index packed into 64 / Dim bits per
+ *        dimension. Ids are unique while indices stay within +-2^(64 / Dim - 1),
+ *        i.e. +-2^20 bundles per dimension in 3D.
+ */
+template <std::size_t Dim>
+inline uint64_t bundle_id(const std::array<int,Dim> &bi)
+{
+    constexpr std::size_t bits = 64ul / Dim;
+    constexpr uint64_t    mask = bits >= 64ul ? ~0ull : ((1ull << (bits % 64ul)) - 1ull);
+
+    uint64_t id = 0ull;
+    for (std::size_t i=0; i<Dim; ++i)
+        id |= (static_cast<uint64_t>(static_cast<int64_t>(bi[i])) & mask) << (bits * i);
+    return id;
+}
+
+/**
+ * @brief Hash of a bundle index for unordered containers, based on bundle_id.
+ */
+template <std::size_t Dim>
+struct bundle_hash {
+    inline std::size_t operator () (const std::array<int,Dim> &bi) const
+    {
+        return std::hash<uint64_t>()(bundle_id<Dim>(bi));
+    }
+};
+
+/**
+ * @brief Partition of the distribution with the given index in bin. A
+ *        distribution always falls into the same partition, the Fibonacci
+ *        hash mixes all dimensions, so also maps one bundle wide are spread.
+ */
+template <std::size_t Dim>
+inline std::size_t distribution_partition(const std::array<int,Dim> &index,
+                                          const std::size_t bin,
+                                          const std::size_t partitions)
+{
+    const uint64_t h = bundle_id<Dim>(index) * 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>((h >> 32) + bin) % partitions;
+}
+
 }
 }
 
@@ -0,0 +1,150 @@
+#ifndef CSLIBS_NDT_UTILITY_DDA_ITERATOR_HPP
+#define CSLIBS_NDT_UTILITY_DDA_ITERATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Amanatides-Woo traversal of all grid cells a line segment passes,
+ *        from the cell of the start point up to, but excluding, the cell of
+ *        the end point. Can be used as line_iterator_t of the occupancy maps
+ *        instead of the SimpleIterator of cslibs_math. Stepping only uses
+ *        integer operations. Consecutive cells are face neighbours and the
+ *        number of steps is fixed on construction, so rounding can neither
+ *        skip the end nor loop forever.
+ */
+template <typename T, std::size_t Dim>
+class DDAIterator
+{
+public:
+    using index_t = std::array<int,Dim>;
+    using coord_t = std::array<T,Dim>;
+
+    /**
+     * @brief Traverse between two points given in the map frame.
+     */
+    template <typename point_t>
+    inline DDAIterator(const point_t &start_p,
+                       const point_t &end_p,
+                       const T resolution)
+    {
+        const T resolution_inv = static_cast<T>(1) / resolution;
+        coord_t s, e;
+        for (std::size_t i=0; i<Dim; ++i) {
+            s[i] = start_p(i) * resolution_inv;
+            e[i] = end_p(i) * resolution_inv;
+        }
+        init(s, e);
+    }
+
+    /**
+     * @brief Traverse between the centers of two cells.
+     */
+    inline DDAIterator(const index_t &start_index,
+                       const index_t &end_index)
+    {
+        coord_t s, e;
+        for (std::size_t i=0; i<Dim; ++i) {
+            s[i] = static_cast<T>(start_index[i]) + static_cast<T>(0.5);
+            e[i] = static_cast<T>(end_index[i]) + static_cast<T>(0.5);
+        }
+        init(s, e);
+    }
+
+    /**
+     * @brief Traverse between two points given in cell coordinates, i.e.
+     *        divided by the resolution already.
+     */
+    inline DDAIterator(const coord_t &s,
+                       const coord_t &e)
+    {
+        init(s, e);
+    }
+
+    inline const index_t& operator () () const
+    {
+        return index_;
+    }
+
+    inline bool done() const
+    {
+        return remaining_ == 0;
+    }
+
+    /**
+     * @brief Number of cells left, including the current one.
+     */
+    inline int remaining() const
+    {
+        return remaining_;
+    }
+
+    inline DDAIterator& operator ++ ()
+    {
+        std::size_t axis = 0;
+        for (std::size_t i=1; i<Dim; ++i)
+            axis = t_max_[i] < t_max_[axis] ? i : axis;
+
+        index_[axis] += step_[axis];
+        t_max_[axis]  = (-- left_[axis] > 0) ? t_max_[axis] + t_delta_[axis] : inf();
+        -- remaining_;
+        return *this;
+    }
+
+private:
+    using fixed_t = std::array<int64_t,Dim>;
+
+    index_t index_;
+    index_t step_;
+    index_t left_;
+    fixed_t t_max_;
+    fixed_t t_delta_;
+    int     remaining_;
+
+    /// ray parameters in [0, 1] are kept in fixed point
+    inline static constexpr T one()
+    {
+        return static_cast<T>(1ll << 40);
+    }
+
+    inline static constexpr int64_t inf()
+    {
+        return std::numeric_limits<int64_t>::max();
+    }
+
+    /// clamped, so that t_max_ + t_delta_ cannot overflow for short rays
+    inline static int64_t fixed(const T t)
+    {
+        return static_cast<int64_t>(std::min(t, static_cast<T>(1ll << 61)));
+    }
+
+    inline void init(const coord_t &s,
+                     const coord_t &e)
+    {
+        remaining_ = 0;
+        for (std::size_t i=0; i<Dim; ++i) {
+            index_[i] = static_cast<int>(std::floor(s[i]));
+            const int end = static_cast<int>(std::floor(e[i]));
+            const T   d   = e[i] - s[i];
+
+            step_[i]    = d < T() ? -1 : 1;
+            left_[i]    = std::abs(end - index_[i]);
+            remaining_ += left_[i];
+
+            const T boundary = d < T() ? s[i] - static_cast<T>(index_[i])
+                                       : static_cast<T>(index_[i] + 1) - s[i];
+            t_delta_[i] = left_[i] > 0 ? fixed(one() / std::abs(d)) : inf();
+            t_max_[i]   = left_[i] > 0 ? fixed(one() * boundary / std::abs(d)) : inf();
+        }
+    }
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_DDA_ITERATOR_HPP
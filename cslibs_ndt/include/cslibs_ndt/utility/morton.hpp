@@ -0,0 +1,124 @@
+#ifndef CSLIBS_NDT_UTILITY_MORTON_HPP
+#define CSLIBS_NDT_UTILITY_MORTON_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Bit interleaving for Z-order (Morton) codes, spread inserts Dim - 1
+ *        zero bits after each of the 64 / Dim lowest bits, compact reverts it.
+ */
+template <std::size_t Dim>
+struct morton
+{
+    static constexpr std::size_t bits = 64ul / Dim;
+
+    inline static uint64_t spread(const uint64_t v)
+    {
+        uint64_t r = 0ull;
+        for (std::size_t b=0; b<bits; ++b)
+            r |= ((v >> b) & 1ull) << (b * Dim);
+        return r;
+    }
+
+    inline static uint64_t compact(const uint64_t v)
+    {
+        uint64_t r = 0ull;
+        for (std::size_t b=0; b<bits; ++b)
+            r |= ((v >> (b * Dim)) & 1ull) << b;
+        return r;
+    }
+};
+
+template <>
+struct morton<2>
+{
+    static constexpr std::size_t bits = 32ul;
+
+    inline static uint64_t spread(uint64_t v)
+    {
+        v &= 0x00000000ffffffffull;
+        v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+        v = (v | (v <<  8)) & 0x00ff00ff00ff00ffull;
+        v = (v | (v <<  4)) & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v <<  2)) & 0x3333333333333333ull;
+        v = (v | (v <<  1)) & 0x5555555555555555ull;
+        return v;
+    }
+
+    inline static uint64_t compact(uint64_t v)
+    {
+        v &= 0x5555555555555555ull;
+        v = (v | (v >>  1)) & 0x3333333333333333ull;
+        v = (v | (v >>  2)) & 0x0f0f0f0f0f0f0f0full;
+        v = (v | (v >>  4)) & 0x00ff00ff00ff00ffull;
+        v = (v | (v >>  8)) & 0x0000ffff0000ffffull;
+        v = (v | (v >> 16)) & 0x00000000ffffffffull;
+        return v;
+    }
+};
+
+template <>
+struct morton<3>
+{
+    static constexpr std::size_t bits = 21ul;
+
+    inline static uint64_t spread(uint64_t v)
+    {
+        v &= 0x00000000001fffffull;
+        v = (v | (v << 32)) & 0x001f00000000ffffull;
+        v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+        v = (v | (v <<  8)) & 0x100f00f00f00f00full;
+        v = (v | (v <<  4)) & 0x10c30c30c30c30c3ull;
+        v = (v | (v <<  2)) & 0x1249249249249249ull;
+        return v;
+    }
+
+    inline static uint64_t compact(uint64_t v)
+    {
+        v &= 0x1249249249249249ull;
+        v = (v | (v >>  2)) & 0x10c30c30c30c30c3ull;
+        v = (v | (v >>  4)) & 0x100f00f00f00f00full;
+        v = (v | (v >>  8)) & 0x001f0000ff0000ffull;
+        v = (v | (v >> 16)) & 0x001f00000000ffffull;
+        v = (v | (v >> 32)) & 0x00000000001fffffull;
+        return v;
+    }
+};
+
+/**
+ * @brief Z-order (Morton) code of an index, the bits of all dimensions are
+ *        interleaved starting with the first dimension in the lowest bit.
+ *        Indices are biased by 2^(64 / Dim - 1), so the order of negative and
+ *        positive indices is kept for indices within +-2^(64 / Dim - 1).
+ */
+template <std::size_t Dim>
+inline uint64_t morton_code(const std::array<int,Dim> &index)
+{
+    constexpr int64_t bias = static_cast<int64_t>(1ll) << (morton<Dim>::bits - 1ul);
+
+    uint64_t code = 0ull;
+    for (std::size_t i=0; i<Dim; ++i)
+        code |= morton<Dim>::spread(static_cast<uint64_t>(static_cast<int64_t>(index[i]) + bias)) << i;
+    return code;
+}
+
+/**
+ * @brief Inverse of morton_code.
+ */
+template <std::size_t Dim>
+inline std::array<int,Dim> morton_index(const uint64_t code)
+{
+    constexpr int64_t bias = static_cast<int64_t>(1ll) << (morton<Dim>::bits - 1ul);
+
+    std::array<int,Dim> index;
+    for (std::size_t i=0; i<Dim; ++i)
+        index[i] = static_cast<int>(static_cast<int64_t>(morton<Dim>::compact(code >> i)) - bias);
+    return index;
+}
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_MORTON_HPP
@@ -0,0 +1,221 @@
+#ifndef CSLIBS_NDT_UTILITY_THREAD_POOL_HPP
+#define CSLIBS_NDT_UTILITY_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cslibs_ndt {
+namespace utility {
+/**
+ * @brief Fixed set of worker threads running batches of tasks. The calling
+ *        thread takes part in each batch, so a pool of size n spawns n - 1
+ *        threads. Batches must not be started from inside a task.
+ */
+class ThreadPool
+{
+public:
+    inline explicit ThreadPool(const std::size_t size = std::thread::hardware_concurrency()) :
+        size_(size > 0ul ? size : 1ul),
+        generation_(0ul),
+        running_(0ul),
+        stop_(false),
+        tasks_(0ul),
+        next_(0ul)
+    {
+        for (std::size_t i=0; i<size_-1ul; ++i)
+            workers_.emplace_back([this, i]() { work(i); });
+    }
+
+    inline ~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread &w : workers_)
+            w.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator = (const ThreadPool &) = delete;
+
+    /**
+     * @brief Number of threads working on a batch, including the caller.
+     */
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+    /**
+     * @brief Index of the calling thread within the pool, the caller of run
+     *        has index size() - 1. Can be used to address per-thread data.
+     */
+    inline static std::size_t index()
+    {
+        return thread_index();
+    }
+
+    /**
+     * @brief Call function(task) for all tasks in [0, tasks) and wait until
+     *        all of them are done. The first exception thrown by a task is
+     *        rethrown here after the batch has finished.
+     */
+    template <typename Fn>
+    inline void run(const std::size_t tasks,
+                    const Fn &function)
+    {
+        if (tasks == 0ul)
+            return;
+
+        {
+            std::unique_lock<std::mutex> l(mutex_);
+            function_ = [&function](const std::size_t task) { function(task); };
+            tasks_    = tasks;
+            next_     = 0ul;
+            error_    = nullptr;
+            running_  = workers_.size();
+            ++ generation_;
+        }
+        wake_.notify_all();
+
+        const std::size_t caller = thread_index();
+        thread_index() = size_ - 1ul;
+        process();
+        thread_index() = caller;
+
+        std::unique_lock<std::mutex> l(mutex_);
+        done_.wait(l, [this]() { return running_ == 0ul; });
+        function_ = nullptr;
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+
+private:
+    const std::size_t                       size_;
+    std::vector<std::thread>                workers_;
+
+    std::mutex                              mutex_;
+    std::condition_variable                 wake_;
+    std::condition_variable                 done_;
+    std::size_t                             generation_;
+    std::size_t                             running_;
+    bool                                    stop_;
+
+    std::function<void(std::size_t)>        function_;
+    std::size_t                             tasks_;
+    std::atomic<std::size_t>                next_;
+    std::exception_ptr                      error_;
+
+    inline static std::size_t& thread_index()
+    {
+        static thread_local std::size_t index = 0ul;
+        return index;
+    }
+
+    inline void work(const std::size_t index)
+    {
+        thread_index() = index;
+
+        std::size_t generation = 0ul;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> l(mutex_);
+                wake_.wait(l, [this, &generation]() { return stop_ || generation_ != generation; });
+                if (stop_)
+                    return;
+                generation = generation_;
+            }
+
+            process();
+
+            std::unique_lock<std::mutex> l(mutex_);
+            if (-- running_ == 0ul)
+                done_.notify_one();
+        }
+    }
+
+    inline void process()
+    {
+        for (std::size_t task = next_++; task < tasks_; task = next_++) {
+            try {
+                function_(task);
+            } catch (...) {
+                std::unique_lock<std::mutex> l(mutex_);
+                if (!error_)
+                    error_ = std::current_exception();
+            }
+        }
+    }
+};
+
+/**
+ * @brief Per-thread accumulator for reductions in ThreadPool batches, e.g.
+ *        in AbstractMap::parallelTraverse. Each thread of the pool gets its own
+ *        copy of the initial value, which are combined after the batch.
+ *        Without a pool there is a single value for serial use.
+ */
+template <typename T>
+class ThreadLocal
+{
+public:
+    inline explicit ThreadLocal(const ThreadPool *pool,
+                                const T &initial = T()) :
+        slots_(pool ? pool->size() : 1ul, slot_t{initial, {}})
+    {
+    }
+
+    inline explicit ThreadLocal(const ThreadPool &pool,
+                                const T &initial = T()) :
+        ThreadLocal(&pool, initial)
+    {
+    }
+
+    /**
+     * @brief The value of the calling thread.
+     */
+    inline T& local()
+    {
+        return slots_.size() > 1ul ? slots_[ThreadPool::index()].value : slots_.front().value;
+    }
+
+    /**
+     * @brief Visit the values of all threads, in the order of their index.
+     */
+    template <typename Fn>
+    inline void traverse(const Fn &function)
+    {
+        for (slot_t &s : slots_)
+            function(s.value);
+    }
+
+    /**
+     * @brief Fold all values into init with function(init, value).
+     */
+    template <typename R, typename Fn>
+    inline R combine(R init, const Fn &function) const
+    {
+        for (const slot_t &s : slots_)
+            init = function(init, s.value);
+        return init;
+    }
+
+private:
+    /// padded to keep the values of different threads apart in memory
+    struct slot_t {
+        T    value;
+        char padding[64];
+    };
+
+    std::vector<slot_t> slots_;
+};
+}
+}
+
+#endif // CSLIBS_NDT_UTILITY_THREAD_POOL_HPP
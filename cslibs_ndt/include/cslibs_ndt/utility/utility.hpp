@@ -6,5 +6,8 @@
 #include <cslibs_ndt/utility/merge.hpp>
 #include <cslibs_ndt/utility/create.hpp>
 #include <cslibs_ndt/utility/for_each.hpp>
+#include <cslibs_ndt/utility/morton.hpp>
+#include <cslibs_ndt/utility/thread_pool.hpp>
+#include <cslibs_ndt/utility/dda_iterator.hpp>
 
 #endif // CSLIBS_NDT_UTILITY_HPP
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/serialization/bundle_indices.hpp>
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+
+const std::size_t NUM_SAMPLES = 10000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+template <std::size_t Dim>
+void testRoundTrip(const int range)
+{
+    using codec_t = cslibs_ndt::serialization::bundle_indices<Dim>;
+    using index_t = typename codec_t::index_t;
+
+    rng_t rng(-range, range);
+    std::set<index_t> unique;
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        index_t index;
+        for (std::size_t j=0; j<Dim; ++j)
+            index[j] = static_cast<int>(rng.get());
+        unique.insert(index);
+    }
+    const std::vector<index_t> indices(unique.begin(), unique.end());
+
+    std::vector<char> data;
+    EXPECT_TRUE(codec_t::encode(indices, data));
+
+    std::vector<index_t> decoded;
+    EXPECT_TRUE(codec_t::decode(data.data(), data.size(), decoded));
+    ASSERT_EQ(indices.size(), decoded.size());
+    EXPECT_EQ(unique, std::set<index_t>(decoded.begin(), decoded.end()));
+}
+
+TEST(Test_cslibs_ndt, testBundleIndicesRoundTrip)
+{
+    testRoundTrip<2>(100);
+    testRoundTrip<2>(1000000);
+    testRoundTrip<3>(50);
+    testRoundTrip<3>(1000000);
+}
+
+TEST(Test_cslibs_ndt, testBundleIndicesCompact)
+{
+    using codec_t = cslibs_ndt::serialization::bundle_indices<3>;
+    using index_t = typename codec_t::index_t;
+
+    /// a dense block takes about one byte per index
+    std::vector<index_t> indices;
+    for (int x=-16; x<16; ++x)
+        for (int y=-16; y<16; ++y)
+            for (int z=-4; z<4; ++z)
+                indices.emplace_back(index_t{{x, y, z}});
+
+    std::vector<char> data;
+    EXPECT_TRUE(codec_t::encode(indices, data));
+    EXPECT_LT(data.size(), 2ul * indices.size());
+
+    std::vector<index_t> decoded;
+    EXPECT_TRUE(codec_t::decode(data.data(), data.size(), decoded));
+    EXPECT_EQ(indices.size(), decoded.size());
+
+    /// empty lists, out of range indices and truncated data
+    EXPECT_TRUE(codec_t::encode(std::vector<index_t>(), data));
+    EXPECT_TRUE(codec_t::decode(data.data(), data.size(), decoded));
+    EXPECT_TRUE(decoded.empty());
+
+    EXPECT_FALSE(codec_t::encode(std::vector<index_t>(1, index_t{{1 << 20, 0, 0}}), data));
+
+    EXPECT_TRUE(codec_t::encode(indices, data));
+    EXPECT_FALSE(codec_t::decode(data.data(), data.size() - 1, decoded));
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt/utility/utility.hpp>
+#include <cslibs_math/random/random.hpp>
+#include <cslibs_math_3d/linear/pose.hpp>
+
+#include <set>
+
+const std::size_t NUM_SAMPLES = 1000;
+using rng_t = cslibs_math::random::Uniform<double,1>;
+
+using index_t   = std::array<int,3>;
+using point_t   = cslibs_math_3d::Point3d;
+using dda_t     = cslibs_ndt::utility::DDAIterator<double,3>;
+
+/// slab test of the segment against the cell
+bool intersects(const point_t &s, const point_t &e, const index_t &c, const double resolution)
+{
+    double t0 = 0.0, t1 = 1.0;
+    for (std::size_t i=0; i<3; ++i) {
+        const double lo = c[i] * resolution - 1e-9, hi = (c[i] + 1) * resolution + 1e-9;
+        const double d  = e(i) - s(i);
+        if (d == 0.0) {
+            if (s(i) < lo || s(i) > hi)
+                return false;
+            continue;
+        }
+        const double ta = (lo - s(i)) / d, tb = (hi - s(i)) / d;
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+    }
+    return t0 <= t1;
+}
+
+index_t toIndex(const point_t &p, const double resolution)
+{
+    return index_t{{static_cast<int>(std::floor(p(0) / resolution)),
+                    static_cast<int>(std::floor(p(1) / resolution)),
+                    static_cast<int>(std::floor(p(2) / resolution))}};
+}
+
+TEST(Test_cslibs_ndt, testDDAIterator)
+{
+    const double resolution = 0.5;
+    rng_t rng(-10.0, 10.0);
+    for (std::size_t k=0; k<NUM_SAMPLES; ++k) {
+        const point_t s(rng.get(), rng.get(), rng.get());
+        const point_t e(rng.get(), rng.get(), rng.get());
+        const index_t end_index = toIndex(e, resolution);
+
+        std::set<index_t> cells;
+        index_t last = toIndex(s, resolution);
+        dda_t it(s, e, resolution);
+        EXPECT_EQ(last, it());
+        for (; !it.done(); ++ it) {
+            EXPECT_TRUE(intersects(s, e, it(), resolution));
+            EXPECT_TRUE(cells.insert(it()).second);
+            last = it();
+        }
+        /// stops in the end cell, reached by a face neighbour
+        EXPECT_EQ(end_index, it());
+        EXPECT_EQ(0ul, cells.count(end_index));
+        if (!cells.empty()) {
+            int steps = 0;
+            for (std::size_t i=0; i<3; ++i)
+                steps += std::abs(end_index[i] - last[i]);
+            EXPECT_EQ(1, steps);
+        }
+
+        /// all cells a dense sampling of the segment hits are visited
+        for (std::size_t j=0; j<=100; ++j) {
+            const point_t p = s + (e - s) * (static_cast<double>(j) / 100.0);
+            const index_t c = toIndex(p, resolution);
+            if (c != end_index) {
+                EXPECT_EQ(1ul, cells.count(c));
+            }
+        }
+    }
+
+    /// index constructor, and no cells for the same start and end
+    dda_t it(index_t{{0, 0, 0}}, index_t{{3, -2, 0}});
+    EXPECT_EQ(5, it.remaining());
+    EXPECT_TRUE(dda_t(index_t{{1, 1, 1}}, index_t{{1, 1, 1}}).done());
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -3,6 +3,8 @@
 #include <cslibs_ndt/utility/utility.hpp>
 #include <cslibs_math/random/random.hpp>
 
+#include <set>
+
 const std::size_t NUM_SAMPLES = 1000;
 using rng_t = cslibs_math::random::Uniform<double,1>;
 
@@ -66,6 +68,103 @@ TEST(Test_cslibs_ndt, testGenerateIndices3d)
     }
 }
 
+TEST(Test_cslibs_ndt, testBundleId)
+{
+    using index_t = std::array<int,3>;
+
+    std::set<uint64_t> ids;
+    for (int x=-5; x<5; ++x)
+        for (int y=-5; y<5; ++y)
+            for (int z=-5; z<5; ++z)
+                EXPECT_TRUE(ids.insert(cslibs_ndt::utility::bundle_id<3>(index_t{{x, y, z}})).second);
+
+    const index_t extreme{{-(1 << 20), (1 << 20) - 1, -1}};
+    EXPECT_NE(cslibs_ndt::utility::bundle_id<3>(extreme), cslibs_ndt::utility::bundle_id<3>(index_t{{-(1 << 20), (1 << 20) - 1, 0}}));
+    EXPECT_EQ(cslibs_ndt::utility::bundle_id<3>(extreme), cslibs_ndt::utility::bundle_id<3>(extreme));
+    EXPECT_NE(cslibs_ndt::utility::bundle_id<2>(std::array<int,2>{{-1, 0}}),
+              cslibs_ndt::utility::bundle_id<2>(std::array<int,2>{{0, -1}}));
+}
+
+TEST(Test_cslibs_ndt, testMortonCode)
+{
+    using index_t = std::array<int,3>;
+
+    rng_t rng(-1000.0, +1000.0);
+    for (std::size_t i=0; i<NUM_SAMPLES; ++i) {
+        const index_t bi = {static_cast<int>(rng.get()), static_cast<int>(rng.get()), static_cast<int>(rng.get())};
+        EXPECT_EQ(bi, cslibs_ndt::utility::morton_index<3>(cslibs_ndt::utility::morton_code<3>(bi)));
+
+        const std::array<int,2> bi_2d{{bi[0], bi[1]}};
+        EXPECT_EQ(bi_2d, cslibs_ndt::utility::morton_index<2>(cslibs_ndt::utility::morton_code<2>(bi_2d)));
+    }
+
+    /// spread and compact agree with the generic bit loop
+    for (uint64_t v=0; v<(1ull << 12); v+=7) {
+        EXPECT_EQ(v, cslibs_ndt::utility::morton<5>::compact(cslibs_ndt::utility::morton<5>::spread(v)));
+        uint64_t spread_2d = 0ull, spread_3d = 0ull;
+        for (std::size_t b=0; b<12; ++b) {
+            spread_2d |= ((v >> b) & 1ull) << (2 * b);
+            spread_3d |= ((v >> b) & 1ull) << (3 * b);
+        }
+        EXPECT_EQ(spread_2d, cslibs_ndt::utility::morton<2>::spread(v));
+        EXPECT_EQ(spread_3d, cslibs_ndt::utility::morton<3>::spread(v));
+    }
+
+    /// the 2x2x2 blocks of the Z-curve are contiguous, also across zero
+    std::set<uint64_t> block;
+    for (int x=-2; x<0; ++x)
+        for (int y=0; y<2; ++y)
+            for (int z=-2; z<0; ++z)
+                block.insert(cslibs_ndt::utility::morton_code<3>(index_t{{x, y, z}}));
+    EXPECT_EQ(*block.rbegin() - *block.begin(), 7ull);
+    EXPECT_LT(cslibs_ndt::utility::morton_code<3>(index_t{{-1, -1, -1}}),
+              cslibs_ndt::utility::morton_code<3>(index_t{{0, 0, 0}}));
+}
+
+template <std::size_t Dim>
+void testPartitionBalance(const std::array<int,Dim> &min,
+                          const std::array<int,Dim> &max)
+{
+    using index_t = std::array<int,Dim>;
+    using index_list_t = std::array<index_t,1 << Dim>;
+
+    /// every distribution referred to by the bundles in [min, max)
+    std::set<std::pair<std::size_t,index_t>> distributions;
+    index_t bi = min;
+    while (bi[Dim - 1] < max[Dim - 1]) {
+        const index_list_t indices = cslibs_ndt::utility::generate_indices<index_list_t,Dim>(bi);
+        for (std::size_t i=0; i<indices.size(); ++i)
+            distributions.emplace(i, indices[i]);
+        for (std::size_t j=0; j<Dim; ++j) {
+            if (++bi[j] < max[j] || j == Dim - 1)
+                break;
+            bi[j] = min[j];
+        }
+    }
+
+    for (std::size_t partitions : {2ul, 3ul, 4ul, 8ul}) {
+        std::vector<std::size_t> counts(partitions, 0ul);
+        for (const auto &d : distributions)
+            ++counts[cslibs_ndt::utility::distribution_partition<Dim>(d.second, d.first, partitions)];
+
+        const double expected = static_cast<double>(distributions.size()) / partitions;
+        for (const std::size_t c : counts) {
+            EXPECT_GT(c, 0.8 * expected);
+            EXPECT_LT(c, 1.2 * expected);
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt, testDistributionPartition)
+{
+    testPartitionBalance<2>({{-32, -32}}, {{32, 32}});
+    testPartitionBalance<3>({{-16, -16, -4}}, {{16, 16, 4}});
+
+    /// corridors only one bundle wide
+    testPartitionBalance<2>({{0, -512}}, {{1, 512}});
+    testPartitionBalance<3>({{0, 0, -256}}, {{1, 1, 256}});
+}
+
 int main(int argc, char *argv[])
 {
     testing::InitGoogleTest(&argc, argv);
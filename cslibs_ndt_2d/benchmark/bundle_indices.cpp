@@ -0,0 +1,48 @@
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_POINTS = 1000000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using point_t       = typename map_t::point_t;
+
+/// bundle indices computed point by point and in a batch
+int main()
+{
+    const map_t map(cslibs_math_2d::Transform2d(1.5, -2.0, 0.3), 0.5);
+
+    rng_t<1> rng_coord(-50.0, 50.0);
+    typename map_t::point_list_t points;
+    for (std::size_t i = 0 ; i < NUM_POINTS ; ++ i)
+        points.emplace_back(rng_coord.get(), rng_coord.get());
+
+    const cslibs_math_2d::Transform2d m_T_w = map.getInitialOrigin().inverse();
+    const double inv = 1.0 / map.getBundleResolution();
+    std::vector<index_t> single(NUM_POINTS);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0 ; i < NUM_POINTS ; ++ i) {
+        const point_t p_m = m_T_w * points[i];
+        single[i] = index_t{{static_cast<int>(std::floor(p_m(0) * inv)),
+                             static_cast<int>(std::floor(p_m(1) * inv))}};
+    }
+    const double single_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_POINTS;
+
+    std::vector<index_t> batch(NUM_POINTS);
+    start = std::chrono::steady_clock::now();
+    map.toBundleIndices(points.begin(), points.end(), batch);
+    const double batch_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_POINTS;
+
+    std::cout << "[BundleIndices]: per point " << single_ns << "ns/point, batch " << batch_ns << "ns/point"
+              << (single == batch ? "" : ", results differ") << std::endl;
+    return 0;
+}
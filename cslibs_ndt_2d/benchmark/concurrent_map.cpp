@@ -0,0 +1,81 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/concurrent_map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 200;
+const std::size_t NUM_SCAN_POINTS   = 100;
+const std::size_t NUM_READERS       = 4;
+const std::size_t NUM_PROBES        = 50;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t             = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using concurrent_map_t  = cslibs_ndt::map::ConcurrentMap<map_t>;
+using pointcloud_t      = typename map_t::pointcloud_t;
+using ivm_t             = typename map_t::inverse_sensor_model_t;
+
+/// latency of readers sampling published versions while a writer inserts scans
+int main()
+{
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(cslibs_math_2d::Point2d(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    std::vector<cslibs_math_2d::Point2d> probes;
+    for (std::size_t i = 0 ; i < NUM_PROBES ; ++ i)
+        probes.emplace_back(rng_coord.get(), rng_coord.get());
+
+    concurrent_map_t map(typename map_t::Ptr(new map_t(1.0)));
+
+    std::atomic<bool> done(false);
+    std::vector<std::vector<double>> latencies(NUM_READERS);
+    auto read = [&](const std::size_t id) {
+        double sum = 0.0;
+        while (!done) {
+            const auto start = std::chrono::steady_clock::now();
+            const typename map_t::ConstPtr snapshot = map.get();
+            for (const auto &p : probes)
+                sum += snapshot->sample(p, ivm);
+            const auto stop = std::chrono::steady_clock::now();
+            latencies[id].emplace_back(std::chrono::duration<double, std::micro>(stop - start).count());
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0 ; i < NUM_READERS ; ++ i)
+        readers.emplace_back(read, i);
+    for (const auto &scan : scans)
+        map.insert(scan);
+    done = true;
+    for (auto &r : readers)
+        r.join();
+
+    std::vector<double> all;
+    for (const std::vector<double> &l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    if (all.empty())
+        return 0;
+
+    std::sort(all.begin(), all.end());
+    std::cout << "[ConcurrentMap]: " << all.size() << " reads of " << NUM_PROBES << " samples, "
+              << "median " << all[all.size() / 2] << "us, "
+              << "p99 "    << all[(all.size() * 99) / 100] << "us, "
+              << "max "    << all.back() << "us" << std::endl;
+    return 0;
+}
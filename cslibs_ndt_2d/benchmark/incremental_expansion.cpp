@@ -0,0 +1,56 @@
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_POINTS        = 100000;
+const std::size_t NUM_UPDATE_POINTS = 100;
+const std::size_t NUM_THREADS       = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using point_t       = typename map_t::point_t;
+
+void insert(map_t &map, const std::size_t n, const double min, const double max)
+{
+    rng_t<1> rng_coord(min, max);
+    for (std::size_t i = 0 ; i < n ; ++ i)
+        map.insert(point_t(rng_coord.get(), rng_coord.get()));
+}
+
+std::size_t bundles(const map_t &map)
+{
+    std::size_t n = 0;
+    map.traverse([&n](const index_t &, const typename map_t::distribution_bundle_t &) {
+        ++ n;
+    });
+    return n;
+}
+
+/// expanding the whole map against expanding only around a few written bundles
+int main()
+{
+    map_t map(0.5);
+    insert(map, NUM_POINTS, -50.0, 50.0);
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    auto start = std::chrono::steady_clock::now();
+    map.allocatePartiallyAllocatedBundles(&pool);
+    const double full_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const std::size_t size = bundles(map);
+    insert(map, NUM_UPDATE_POINTS, -5.0, 5.0);
+    start = std::chrono::steady_clock::now();
+    map.allocatePartiallyAllocatedBundles(&pool);
+    const double incremental_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[IncrementalExpansion]: " << size << " bundles, "
+              << "full " << full_ms << "ms, "
+              << "after " << NUM_UPDATE_POINTS << " points " << incremental_ms << "ms" << std::endl;
+    return 0;
+}
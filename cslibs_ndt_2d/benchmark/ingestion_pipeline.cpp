@@ -0,0 +1,52 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/ingestion_pipeline.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 60;
+const std::size_t NUM_SCAN_POINTS   = 200;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using pipeline_t    = cslibs_ndt::map::IngestionPipeline<map_t>;
+using policy_t      = typename pipeline_t::Policy;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+/// push latency and the latencies of the pipeline stages
+int main()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+
+    typename map_t::Ptr map(new map_t(0.5));
+    pipeline_t pipeline(map, 4ul, policy_t::BLOCK, 0.2);
+    const auto start = std::chrono::steady_clock::now();
+    double push_ms = 0.0;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        const auto push_start = std::chrono::steady_clock::now();
+        pipeline.push(scans[i], cslibs_math_2d::Transform2d(0.1 * i, -0.05 * i, 0.02 * i));
+        push_ms = std::max(push_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - push_start).count());
+    }
+    pipeline.flush();
+    const double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const typename pipeline_t::metrics_t metrics = pipeline.getMetrics();
+    std::cout << "[IngestionPipeline]: " << metrics.inserted << " scans in " << total_ms << "ms, max push " << push_ms << "ms, "
+              << "wait " << metrics.wait.mean() << "ms, downsample " << metrics.downsample.mean() << "ms, "
+              << "insert " << metrics.insert.mean() << "ms, total " << metrics.total.mean() << "ms" << std::endl;
+    return 0;
+}
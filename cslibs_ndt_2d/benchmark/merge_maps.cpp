@@ -0,0 +1,61 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/merge_maps.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_BEAMS = 360;
+const std::size_t NUM_SCANS = 40;
+
+using occupancy_map_t   = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using pointcloud_t      = typename occupancy_map_t::pointcloud_t;
+using point_t           = typename occupancy_map_t::point_t;
+using transform_t       = cslibs_math_2d::Transform2d;
+
+transform_t origin(const std::size_t i)
+{
+    return transform_t(0.2 * i, -0.1 * i, 0.05 * i);
+}
+
+/// merging two sessions against inserting all of their scans again
+int main()
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    occupancy_map_t a(0.5), b(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        if (i % 2)
+            a.insert(scans[i], origin(i));
+        else
+            b.insert(scans[i], origin(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    occupancy_map_t reinserted(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        reinserted.insert(scans[i], origin(i));
+    const double reinsert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    cslibs_ndt::map::mergeMaps(a, b);
+    const double aligned_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    cslibs_ndt::utility::ThreadPool pool(4);
+    start = std::chrono::steady_clock::now();
+    cslibs_ndt::map::mergeMaps(a, b, transform_t(), &pool);
+    const double parallel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    cslibs_ndt::map::mergeMaps(a, b, transform_t(0.3, 0.1, 0.2), &pool);
+    const double transformed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[MergeMaps]: " << NUM_SCANS << " scans, reinsert " << reinsert_ms << "ms, "
+              << "merge " << aligned_ms << "ms, parallel merge " << parallel_ms << "ms, "
+              << "transformed merge " << transformed_ms << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/conversion/probability_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_POINTS    = 100000;
+const std::size_t NUM_THREADS   = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using point_t       = typename map_t::point_t;
+using gridmap_t     = cslibs_gridmaps::static_maps::ProbabilityGridmap<double,double>;
+
+typename map_t::Ptr generateMap()
+{
+    rng_t<1> rng_coord(-50.0, 50.0);
+
+    typename map_t::Ptr map(new map_t(0.5));
+    for (std::size_t i = 0 ; i < NUM_POINTS ; ++ i)
+        map->insert(point_t(rng_coord.get(), rng_coord.get()));
+    return map;
+}
+
+/// serial against parallel conversion to a probability gridmap
+int main()
+{
+    const typename map_t::Ptr serial_map   = generateMap();
+    const typename map_t::Ptr parallel_map = generateMap();
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    typename gridmap_t::Ptr serial, parallel;
+    auto start = std::chrono::steady_clock::now();
+    cslibs_ndt_2d::conversion::from<double>(serial_map, serial, 0.05);
+    const double serial_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    cslibs_ndt_2d::conversion::from<double>(parallel_map, parallel, 0.05, true, &pool);
+    const double parallel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[ParallelTraverse]: probability gridmap conversion serial " << serial_ms << "ms, "
+              << NUM_THREADS << " threads " << parallel_ms << "ms" << std::endl;
+    return 0;
+}
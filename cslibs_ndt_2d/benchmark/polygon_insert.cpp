@@ -0,0 +1,50 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+const std::size_t NUM_BEAMS = 1080;
+const std::size_t NUM_SCANS = 20;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+/// per-beam, deduplicated and polygon scan insertion
+int main()
+{
+    map_t insert_map(0.5), deduplicated_map(0.5), polygon_map(0.5);
+    std::vector<typename pointcloud_t::Ptr> scans;
+    std::vector<cslibs_math_2d::Transform2d> origins;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        scans.emplace_back(generateScan(NUM_BEAMS));
+        origins.emplace_back(0.1 * i, 0.05 * i, 0.01 * i);
+    }
+
+    auto measure = [&scans, &origins](const std::function<void(const typename pointcloud_t::Ptr &, const cslibs_math_2d::Transform2d &)> &insert) {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+            insert(scans[i], origins[i]);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_SCANS;
+    };
+    const double insert_ms = measure([&insert_map](const typename pointcloud_t::Ptr &s, const cslibs_math_2d::Transform2d &o) {
+        insert_map.insert(s, o);
+    });
+    const double deduplicated_ms = measure([&deduplicated_map](const typename pointcloud_t::Ptr &s, const cslibs_math_2d::Transform2d &o) {
+        deduplicated_map.insertDeduplicated(s, o);
+    });
+    const double polygon_ms = measure([&polygon_map](const typename pointcloud_t::Ptr &s, const cslibs_math_2d::Transform2d &o) {
+        polygon_map.insertPolygon(s, o);
+    });
+
+    std::vector<index_t> indices;
+    polygon_map.getBundleIndices(indices);
+    std::cout << "[PolygonInsert]: " << NUM_BEAMS << " beams, " << indices.size() << " bundles, insert " << insert_ms << "ms/scan, "
+              << "deduplicated " << deduplicated_ms << "ms/scan, "
+              << "polygon " << polygon_ms << "ms/scan" << std::endl;
+    return 0;
+}
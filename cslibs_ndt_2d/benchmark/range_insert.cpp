@@ -0,0 +1,67 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+const std::size_t NUM_BEAMS = 1080;
+const std::size_t NUM_SCANS = 20;
+const double ANGLE_MIN      = -0.75 * M_PI;
+const double ANGLE_INC      = 1.5 * M_PI / (NUM_BEAMS - 1);
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using ray_table_t   = typename map_t::ray_table_t;
+
+/// ranges of a wavy room, with a few invalid beams
+std::vector<float> generateRanges()
+{
+    const std::vector<double> room = generateScanRanges(NUM_BEAMS);
+    std::vector<float> ranges(room.begin(), room.end());
+    ranges[10]  = std::numeric_limits<float>::quiet_NaN();
+    ranges[20]  = 0.01f;
+    ranges[30]  = 100.0f;
+    return ranges;
+}
+
+/// what the conversion to a pointcloud does for each scan
+typename pointcloud_t::Ptr toPointcloud(const std::vector<float> &ranges)
+{
+    typename pointcloud_t::Ptr cloud(new pointcloud_t);
+    for (std::size_t i = 0 ; i < ranges.size() ; ++ i) {
+        const double r = static_cast<double>(ranges[i]);
+        if (!std::isfinite(r) || r < 0.1 || r > 30.0)
+            continue;
+        const double angle = ANGLE_MIN + static_cast<double>(i) * ANGLE_INC;
+        cloud->insert(point_t(r * std::cos(angle), r * std::sin(angle)));
+    }
+    return cloud;
+}
+
+/// range insertion against converting every scan to a pointcloud first
+int main()
+{
+    std::vector<std::vector<float>> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        scans.emplace_back(generateRanges());
+    const cslibs_math_2d::Transform2d origin(1.0, 2.0, 0.3);
+
+    map_t cloud_map(0.5), range_map(0.5);
+    auto start = std::chrono::steady_clock::now();
+    for (const std::vector<float> &ranges : scans)
+        cloud_map.insertDeduplicated(toPointcloud(ranges), origin);
+    const double cloud_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_SCANS;
+
+    start = std::chrono::steady_clock::now();
+    const ray_table_t rays(ANGLE_MIN, ANGLE_INC, NUM_BEAMS);
+    for (const std::vector<float> &ranges : scans)
+        range_map.insertRanges(rays, ranges.data(), origin, 0.1, 30.0);
+    const double range_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_SCANS;
+
+    std::cout << "[RangeInsert]: " << NUM_BEAMS << " beams, pointcloud " << cloud_ms << "ms/scan, "
+              << "ranges " << range_ms << "ms/scan" << std::endl;
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_BEAMS     = 720;
+const std::size_t NUM_SCANS     = 40;
+const std::size_t NUM_CORRECTED = 4;
+
+using map_t          = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using pointcloud_t   = typename map_t::pointcloud_t;
+using point_t        = typename map_t::point_t;
+using contribution_t = typename map_t::contribution_t;
+
+cslibs_math_2d::Transform2d origin(const std::size_t i)
+{
+    return cslibs_math_2d::Transform2d(0.2 * i, 0.1 * i, 0.03 * i);
+}
+
+/// rebuilding the map after a loop closure against reinserting the corrected scans
+int main()
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    std::vector<cslibs_math_2d::Transform2d> corrected;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        scans.emplace_back(generateScan(NUM_BEAMS));
+        corrected.emplace_back(origin(i));
+    }
+
+    map_t map(0.5);
+    std::vector<contribution_t> contributions(NUM_SCANS);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insertRecorded(scans[i], origin(i), contributions[i]);
+
+    for (std::size_t i = NUM_SCANS - NUM_CORRECTED ; i < NUM_SCANS ; ++ i)
+        corrected[i] = cslibs_math_2d::Transform2d(0.05, 0.05, 0.01) * origin(i);
+
+    auto start = std::chrono::steady_clock::now();
+    map_t rebuilt(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        rebuilt.insertDeduplicated(scans[i], corrected[i]);
+    const double rebuild_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = NUM_SCANS - NUM_CORRECTED ; i < NUM_SCANS ; ++ i)
+        map.reinsert(scans[i], corrected[i], contributions[i]);
+    const double reinsert_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t bytes = 0;
+    for (const contribution_t &c : contributions)
+        bytes += c.free.size() * sizeof(c.free.front()) +
+                 c.occupied.size() * (sizeof(c.occupied.front()) + sizeof(typename map_t::distribution_t::distribution_t));
+    std::cout << "[ReinsertScan]: " << NUM_CORRECTED << " of " << NUM_SCANS << " scans corrected, "
+              << "rebuild " << rebuild_ms << "ms, reinsert " << reinsert_ms << "ms, "
+              << bytes / NUM_SCANS << " bytes recorded per scan" << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/static_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_POINTS    = 100000;
+const std::size_t NUM_PROBES    = 1000000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using static_map_t  = cslibs_ndt_2d::static_maps::Gridmap<double>;
+using dynamic_map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename static_map_t::index_t;
+using point_t       = typename static_map_t::point_t;
+
+std::vector<point_t> generatePoints(const std::size_t n, const double range)
+{
+    rng_t<1> rng_coord(-range, range);
+
+    std::vector<point_t> points;
+    for (std::size_t i = 0 ; i < n ; ++ i)
+        points.emplace_back(rng_coord.get(), rng_coord.get());
+    return points;
+}
+
+template <typename Fn>
+double measure(const std::size_t n, const Fn &function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+}
+
+template <typename map_t>
+void benchmark(map_t &map, const std::string &name)
+{
+    const std::vector<point_t> points = generatePoints(NUM_POINTS, 10.0);
+    const double insert_ns = measure(NUM_POINTS, [&map, &points]() {
+        for (const point_t &p : points)
+            map.insert(p);
+    });
+
+    /// a quarter of the probes is outside of the static map
+    const std::vector<point_t> probes = generatePoints(NUM_PROBES, 20.0);
+    double sum = 0.0;
+    const double sample_ns = measure(NUM_PROBES, [&map, &probes, &sum]() {
+        for (const point_t &p : probes) {
+            const double s = map.sample(p);
+            sum += std::isnormal(s) ? s : 0.0;
+        }
+    });
+
+    std::size_t found = 0;
+    const double get_ns = measure(NUM_PROBES, [&map, &probes, &found]() {
+        for (const point_t &p : probes)
+            found += map.get(p) ? 1ul : 0ul;
+    });
+
+    std::cout << "[" << name << "]: insert " << insert_ns << "ns/point, "
+              << "sample " << sample_ns << "ns/probe, "
+              << "get " << get_ns << "ns/probe, "
+              << found << " found, checksum " << sum << std::endl;
+}
+
+/// insert, sample and lookup throughput of the static and the dynamic gridmap
+int main()
+{
+    static_map_t static_map(cslibs_math_2d::Transform2d(), 1.0,
+                            typename static_map_t::size_t{{10ul, 10ul}},
+                            index_t{{-10, -10}});
+    benchmark(static_map, "StaticGridmap");
+
+    dynamic_map_t dynamic_map(1.0);
+    benchmark(dynamic_map, "DynamicGridmap");
+    return 0;
+}
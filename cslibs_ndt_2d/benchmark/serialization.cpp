@@ -0,0 +1,43 @@
+#include <cslibs_ndt_2d/serialization/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+
+/// loading a large map from the binary directory layout against a single container file
+int main()
+{
+    rng_t<1> rng_coord(-200.0, 200.0);
+    rng_t<1> rng_range(-5.0, 5.0);
+    typename map_t::Ptr map(new map_t(cslibs_math_2d::Transform2d(), 0.5));
+    for (int i = 0 ; i < 10000 ; ++ i) {
+        const cslibs_math_2d::Point2d p(rng_coord.get(), rng_coord.get());
+        map->insert(p, p + cslibs_math_2d::Point2d(rng_range.get(), rng_range.get()));
+    }
+
+    cslibs_ndt_2d::dynamic_maps::saveBinary<double>(map, "/tmp/large_occ_map_binary_2d");
+    cslibs_ndt_2d::dynamic_maps::saveContainer<double>(map, "/tmp/large_occ_map_2d.ndt");
+
+    typename map_t::Ptr from_binary, from_container;
+    auto start = std::chrono::steady_clock::now();
+    if (!cslibs_ndt_2d::dynamic_maps::loadBinary<double>("/tmp/large_occ_map_binary_2d", from_binary))
+        return 1;
+    const double binary_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    if (!cslibs_ndt_2d::dynamic_maps::loadContainer<double>("/tmp/large_occ_map_2d.ndt", from_container))
+        return 1;
+    const double container_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<typename map_t::index_t> indices;
+    map->getBundleIndices(indices);
+    std::cout << "[Container]: " << indices.size() << " bundles, "
+              << "loadBinary " << binary_ms << "ms, loadContainer " << container_ms << "ms" << std::endl;
+    return 0;
+}
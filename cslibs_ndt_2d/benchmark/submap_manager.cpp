@@ -0,0 +1,61 @@
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt/map/submap_manager.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_BEAMS     = 360;
+const std::size_t NUM_SCANS     = 60;
+const std::size_t NUM_PER_MAP   = 10;
+
+using gridmap_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using pointcloud_t      = typename gridmap_t::pointcloud_t;
+using point_t           = typename gridmap_t::point_t;
+using transform_t       = cslibs_math_2d::Transform2d;
+
+transform_t origin(const std::size_t i)
+{
+    return transform_t(static_cast<double>(i % 7), -static_cast<double>(i % 5), 0.0);
+}
+
+/// re-anchoring all submaps and composing them against rebuilding the map from the scans
+int main()
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    cslibs_ndt::map::SubmapManager<gridmap_t> submaps(1.0, NUM_PER_MAP);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        submaps.insert(scans[i], origin(i));
+    submaps.getMap();
+
+    const transform_t correction(0.1, 0.05, 0.02);
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t id = 0 ; id < submaps.size() ; ++ id)
+        submaps.setAnchor(id, correction * submaps.getAnchor(id));
+    const double anchor_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    submaps.getMap();
+    const double compose_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    gridmap_t rebuilt(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        rebuilt.insert(scans[i], correction * origin(i));
+    const double rebuild_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    /// only the active submap is added again after another scan
+    submaps.insert(scans.front(), origin(NUM_SCANS));
+    start = std::chrono::steady_clock::now();
+    submaps.getMap();
+    const double incremental_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[SubmapManager]: " << NUM_SCANS << " scans in " << submaps.size() << " submaps, "
+              << "re-anchoring " << anchor_ms << "ms, compose " << compose_ms << "ms, "
+              << "rebuild " << rebuild_ms << "ms, incremental compose " << incremental_ms << "ms" << std::endl;
+    return 0;
+}
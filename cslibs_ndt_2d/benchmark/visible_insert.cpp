@@ -0,0 +1,42 @@
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "../test/scan.hpp"
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_BEAMS = 1080;
+const std::size_t NUM_SCANS = 10;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using ivm_t         = typename map_t::inverse_sensor_model_t;
+
+/// visibility-checked insertion of scans from moving origins
+int main()
+{
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    const typename ivm_t::Ptr ivm_visibility(new ivm_t(0.1, 0.1, 1.0));
+
+    std::vector<typename pointcloud_t::Ptr> scans;
+    std::vector<cslibs_math_2d::Transform2d> origins;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        scans.emplace_back(generateScan(NUM_BEAMS));
+        origins.emplace_back(0.2 * i, 0.1 * i, 0.05 * i);
+    }
+
+    map_t map(0.5);
+    map.insert(scans.front(), origins.front());
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insertVisible(scans[i], origins[i], ivm, ivm_visibility);
+    const double visible_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_SCANS;
+
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    std::cout << "[VisibleInsert]: " << NUM_BEAMS << " beams, " << visible_ms << "ms/scan, "
+              << indices.size() << " bundles, " << map.getByteSize() << " bytes" << std::endl;
+    return 0;
+}
@@ -17,11 +17,13 @@ inline void from(
         const typename cslibs_ndt_2d::dynamic_maps::Gridmap<T>::Ptr &src,
         typename cslibs_gridmaps::static_maps::BinaryGridmap<T>::Ptr &dst,
         const T &sampling_resolution,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::BinaryGridmap<T>;
@@ -57,7 +59,7 @@ inline void from(
                             cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
             }
         }
-    });
+    }, pool);
 }
 
 template <typename T>
@@ -66,11 +68,13 @@ inline void from(
         typename cslibs_gridmaps::static_maps::BinaryGridmap<T>::Ptr &dst,
         const T &sampling_resolution,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &inverse_model,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src || !inverse_model)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::BinaryGridmap<T>;
@@ -114,7 +118,7 @@ inline void from(
                             cslibs_gridmaps::static_maps::BinaryGridmap::FREE;
             }
         }
-    });
+    }, pool);
 }
 }
 }
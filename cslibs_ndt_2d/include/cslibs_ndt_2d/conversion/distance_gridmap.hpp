@@ -18,11 +18,13 @@ inline void from(
         typename cslibs_gridmaps::static_maps::DistanceGridmap<T,T>::Ptr &dst,
         const T &sampling_resolution,
         const T &maximum_distance = 2.0,
-        const T &threshold        = 0.169)
+        const T &threshold        = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::DistanceGridmap<T,T>;
@@ -56,7 +58,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 
     std::vector<T> occ = dst->getData();
     cslibs_gridmaps::static_maps::algorithms::DistanceTransform<T,T,T> distance_transform(
@@ -71,11 +73,13 @@ inline void from(
         const T &sampling_resolution,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &inverse_model,
         const T &maximum_distance = 2.0,
-        const T &threshold        = 0.169)
+        const T &threshold        = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src || !inverse_model)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::DistanceGridmap<T,T>;
@@ -117,7 +121,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 
     std::vector<T> occ = dst->getData();
     cslibs_gridmaps::static_maps::algorithms::DistanceTransform<T,T,T> distance_transform(
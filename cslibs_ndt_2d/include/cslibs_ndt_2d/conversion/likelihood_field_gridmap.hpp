@@ -12,17 +12,20 @@
 
 namespace cslibs_ndt_2d {
 namespace conversion {
+template <typename T>
 inline void from(
         const typename cslibs_ndt_2d::dynamic_maps::Gridmap<T>::Ptr &src,
         typename cslibs_gridmaps::static_maps::LikelihoodFieldGridmap<T,T>::Ptr &dst,
         const T &sampling_resolution,
         const T &maximum_distance = 2.0,
         const T &sigma_hit        = 0.5,
-        const T &threshold        = 0.169)
+        const T &threshold        = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     assert(threshold <= 1.0);
     assert(threshold >= 0.0);
@@ -60,7 +63,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 
     std::vector<T> occ = dst->getData();
     cslibs_gridmaps::static_maps::algorithms::DistanceTransform<T,T,T> distance_transform(
@@ -80,11 +83,13 @@ inline void from(
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &inverse_model,
         const T &maximum_distance = 2.0,
         const T &sigma_hit        = 0.5,
-        const T &threshold        = 0.169)
+        const T &threshold        = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src || !inverse_model)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     assert(threshold <= 1.0);
     assert(threshold >= 0.0);
@@ -130,7 +135,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 
     std::vector<T> occ = dst->getData();
     cslibs_gridmaps::static_maps::algorithms::DistanceTransform<T,T,T> distance_transform(
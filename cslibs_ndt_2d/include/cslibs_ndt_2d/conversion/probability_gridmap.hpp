@@ -26,12 +26,14 @@ inline void from(
         const typename cslibs_ndt_2d::dynamic_maps::Gridmap<T>::Ptr &src,
         typename cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>::Ptr &dst,
         const T sampling_resolution,
-        const bool allocate_all = true)
+        const bool allocate_all = true,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
     if (allocate_all)
-        src->allocatePartiallyAllocatedBundles();
+        src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>;
@@ -65,7 +67,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 }
 
 template <typename T>
@@ -116,12 +118,14 @@ inline void from(
         typename cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>::Ptr &dst,
         const T sampling_resolution,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &inverse_model,
-        const bool allocate_all = true)
+        const bool allocate_all = true,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src || !inverse_model)
         return;
     if (allocate_all)
-        src->allocatePartiallyAllocatedBundles();
+        src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>;
@@ -163,7 +167,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 }
 
 template <typename T>
@@ -172,12 +176,14 @@ inline void from(
         typename cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>::Ptr &dst,
         const T sampling_resolution,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &inverse_model,
-        const bool allocate_all = true)
+        const bool allocate_all = true,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src || !inverse_model)
         return;
     if (allocate_all)
-        src->allocatePartiallyAllocatedBundles();
+        src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_2d::dynamic_maps::WeightedOccupancyGridmap<T>;
     using dst_map_t = cslibs_gridmaps::static_maps::ProbabilityGridmap<T,T>;
@@ -219,7 +225,7 @@ inline void from(
                 dst->at(u,v) = sample(p, b);
             }
         }
-    });
+    }, pool);
 }
 }
 }
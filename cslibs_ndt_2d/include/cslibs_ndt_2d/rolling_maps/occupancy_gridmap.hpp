@@ -0,0 +1,15 @@
+#ifndef CSLIBS_NDT_2D_ROLLING_MAPS_OCCUPANCY_GRIDMAP_HPP
+#define CSLIBS_NDT_2D_ROLLING_MAPS_OCCUPANCY_GRIDMAP_HPP
+
+#include <cslibs_ndt/map/map.hpp>
+
+namespace cslibs_ndt_2d {
+namespace rolling_maps {
+
+template <typename T>
+using OccupancyGridmap = cslibs_ndt::map::Map<cslibs_ndt::map::tags::rolling_map,2,cslibs_ndt::OccupancyDistribution,T>;
+
+}
+}
+
+#endif // CSLIBS_NDT_2D_ROLLING_MAPS_OCCUPANCY_GRIDMAP_HPP
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cmath>
+#include <vector>
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+index_t expectedIndex(const map_t &map, const point_t &p_w)
+{
+    const point_t p_m = map.getInitialOrigin().inverse() * p_w;
+    return index_t{{static_cast<int>(std::floor(p_m(0) / map.getBundleResolution())),
+                    static_cast<int>(std::floor(p_m(1) / map.getBundleResolution()))}};
+}
+
+TEST(Test_cslibs_ndt_2d, testBundleIndices)
+{
+    const map_t map(cslibs_math_2d::Transform2d(1.5, -2.0, 0.3), 0.5);
+
+    rng_t<1> rng_coord(-50.0, 50.0);
+    typename map_t::point_list_t points;
+    for (std::size_t i = 0 ; i < 10000 ; ++ i)
+        points.emplace_back(rng_coord.get(), rng_coord.get());
+    /// exactly on bundle borders and negative zero
+    points.emplace_back(-0.0, 0.0);
+    points.emplace_back(cslibs_math_2d::Transform2d(1.5, -2.0, 0.3) * point_t(-1.0, 0.25));
+
+    std::vector<index_t> indices;
+    map.toBundleIndices(points.begin(), points.end(), indices);
+    ASSERT_EQ(indices.size(), points.size());
+    for (std::size_t i = 0 ; i < points.size() ; ++ i)
+        EXPECT_EQ(expectedIndex(map, points[i]), indices[i]);
+
+    /// strided buffers, e.g. x, y, intensity
+    std::vector<float> buffer;
+    for (const point_t &p : points) {
+        buffer.emplace_back(static_cast<float>(p(0)));
+        buffer.emplace_back(static_cast<float>(p(1)));
+        buffer.emplace_back(1.0f);
+    }
+    std::vector<index_t> buffer_indices;
+    map.toBundleIndices(buffer.data(), points.size(), 3, buffer_indices);
+    ASSERT_EQ(buffer_indices.size(), points.size());
+    for (std::size_t i = 0 ; i < points.size() ; ++ i)
+        EXPECT_EQ(expectedIndex(map, point_t(buffer[3 * i], buffer[3 * i + 1])), buffer_indices[i]);
+
+    /// non-finite points of a cloud are skipped
+    typename pointcloud_t::Ptr cloud(new pointcloud_t);
+    cloud->insert(point_t(1.0, 2.0));
+    cloud->insert(point_t(std::numeric_limits<double>::quiet_NaN(), 2.0));
+    cloud->insert(point_t(-3.0, 0.5));
+    const cslibs_math_2d::Transform2d origin(0.5, 0.5, -0.1);
+    typename map_t::point_list_t points_w;
+    map.toBundleIndices(*cloud, origin, points_w, indices);
+    ASSERT_EQ(points_w.size(), 2ul);
+    ASSERT_EQ(indices.size(), 2ul);
+    EXPECT_EQ(expectedIndex(map, origin * point_t(-3.0, 0.5)), indices[1]);
+}
+
+TEST(Test_cslibs_ndt_2d, testBatchInsert)
+{
+    using occupancy_map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+
+    rng_t<1> rng_coord(-10.0, 10.0);
+    typename pointcloud_t::Ptr cloud(new pointcloud_t);
+    for (std::size_t i = 0 ; i < 1000 ; ++ i)
+        cloud->insert(point_t(rng_coord.get(), rng_coord.get()));
+    const cslibs_math_2d::Transform2d origin(1.0, 2.0, 0.5);
+
+    /// inserting a cloud is the same as inserting its points one by one
+    map_t batch(0.5), single(0.5);
+    batch.insert(cloud, origin);
+    for (const point_t &p : *cloud)
+        single.insert(origin * p);
+
+    std::size_t bundles = 0;
+    single.traverse([&batch, &bundles](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *bb = batch.get(bi);
+        ASSERT_NE(bb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            EXPECT_EQ(b.at(i)->data().getN(), bb->at(i)->data().getN());
+    });
+    EXPECT_GT(bundles, 0ul);
+
+    occupancy_map_t occupancy(0.5);
+    occupancy.insert(cloud, origin);
+    for (const point_t &p : *cloud) {
+        const typename occupancy_map_t::distribution_bundle_t *b = occupancy.get(origin * p);
+        ASSERT_NE(b, nullptr);
+        for (std::size_t i = 0 ; i < occupancy_map_t::bin_count ; ++ i)
+            EXPECT_GT(b->at(i)->numOccupied(), 0ul);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/concurrent_map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <thread>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 200;
+const std::size_t NUM_SCAN_POINTS   = 100;
+const std::size_t NUM_READERS       = 4;
+const std::size_t NUM_PROBES        = 50;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t             = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using concurrent_map_t  = cslibs_ndt::map::ConcurrentMap<map_t>;
+using pointcloud_t      = typename map_t::pointcloud_t;
+using ivm_t             = typename map_t::inverse_sensor_model_t;
+
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(cslibs_math_2d::Point2d(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+std::vector<cslibs_math_2d::Point2d> generateProbes()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    std::vector<cslibs_math_2d::Point2d> probes;
+    for (std::size_t i = 0 ; i < NUM_PROBES ; ++ i)
+        probes.emplace_back(rng_coord.get(), rng_coord.get());
+    return probes;
+}
+
+TEST(Test_cslibs_ndt_2d, testCopyIsIndependent)
+{
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const std::vector<cslibs_math_2d::Point2d> probes = generateProbes();
+
+    map_t map(1.0);
+    map.insert(scans.front());
+
+    std::vector<double> before;
+    for (const auto &p : probes)
+        before.emplace_back(map.sample(p, ivm));
+
+    map_t copy(map);
+    for (const auto &scan : scans)
+        copy.insert(scan);
+
+    for (std::size_t i = 0 ; i < probes.size() ; ++ i)
+        EXPECT_EQ(before[i], map.sample(probes[i], ivm));
+
+    map.traverse([&copy](const typename map_t::index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        const typename map_t::distribution_bundle_t *bc = copy.get(bi);
+        ASSERT_NE(bc, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            EXPECT_NE(b.at(i), bc->at(i));
+    });
+}
+
+TEST(Test_cslibs_ndt_2d, testConcurrentReadWrite)
+{
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const std::vector<cslibs_math_2d::Point2d> probes = generateProbes();
+
+    concurrent_map_t map(typename map_t::Ptr(new map_t(1.0)));
+
+    std::atomic<bool> done(false);
+    std::vector<std::size_t> unstable(NUM_READERS, 0ul);
+
+    auto read = [&](const std::size_t id) {
+        std::size_t last_version = 0;
+        while (!done) {
+            const std::size_t version = map.getVersion();
+            EXPECT_GE(version, last_version);
+            last_version = version;
+
+            const typename map_t::ConstPtr snapshot = map.get();
+            const std::size_t size = snapshot->getByteSize();
+            std::vector<double> values;
+            std::vector<const typename map_t::distribution_bundle_t*> bundles;
+            for (const auto &p : probes) {
+                values.emplace_back(snapshot->sample(p, ivm));
+                bundles.emplace_back(snapshot->getDistributionBundle(p));
+            }
+
+            /// a published version must not change while the writer continues
+            std::this_thread::yield();
+            for (std::size_t i = 0 ; i < probes.size() ; ++ i) {
+                if (values[i] != snapshot->sample(probes[i], ivm))
+                    ++ unstable[id];
+                if (bundles[i] != snapshot->getDistributionBundle(probes[i]))
+                    ++ unstable[id];
+            }
+
+            /// nor may readers allocate in it, bundles far off the scans are not there
+            const typename map_t::index_t far{{1000, 1000}};
+            if (snapshot->getDistributionBundle(far) != nullptr ||
+                    snapshot->getByteSize() != size)
+                ++ unstable[id];
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0 ; i < NUM_READERS ; ++ i)
+        readers.emplace_back(read, i);
+
+    for (const auto &scan : scans)
+        map.insert(scan);
+
+    done = true;
+    for (auto &r : readers)
+        r.join();
+
+    /// final version matches a sequentially built map
+    map_t reference(1.0);
+    for (const auto &scan : scans)
+        reference.insert(scan);
+
+    const typename map_t::ConstPtr published = map.get();
+    EXPECT_EQ(map.getVersion(), NUM_SCANS + 1);
+    for (const auto &p : probes)
+        EXPECT_NEAR(reference.sample(p, ivm), published->sample(p, ivm), 1e-9);
+
+    for (std::size_t i = 0 ; i < NUM_READERS ; ++ i)
+        EXPECT_EQ(unstable[i], 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+
+const std::size_t NUM_THREADS = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using point_t       = typename map_t::point_t;
+using bundle_t      = typename map_t::distribution_bundle_t;
+
+void insert(map_t &map, const std::size_t n, const double min, const double max)
+{
+    rng_t<1> rng_coord(min, max);
+    for (std::size_t i = 0 ; i < n ; ++ i)
+        map.insert(point_t(rng_coord.get(), rng_coord.get()));
+}
+
+std::set<index_t> bundles(const map_t &map)
+{
+    std::set<index_t> bis;
+    map.traverse([&bis](const index_t &bi, const bundle_t &) {
+        bis.insert(bi);
+    });
+    return bis;
+}
+
+bool expandable(const bundle_t &b)
+{
+    for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+        if (b.at(i) && b.at(i)->data().getN() >= 3)
+            return true;
+    return false;
+}
+
+std::set<index_t> neighborhood(const index_t &bi)
+{
+    std::set<index_t> bis;
+    for (int dx = -1 ; dx <= 1 ; ++ dx)
+        for (int dy = -1 ; dy <= 1 ; ++ dy)
+            bis.insert(index_t{{bi[0] + dx, bi[1] + dy}});
+    return bis;
+}
+
+TEST(Test_cslibs_ndt_2d, testIncrementalExpansion)
+{
+    map_t map(0.5);
+    insert(map, 10000, -10.0, 10.0);
+    map.allocatePartiallyAllocatedBundles();
+    const std::set<index_t> expanded = bundles(map);
+
+    /// nothing written, nothing to expand
+    map.allocatePartiallyAllocatedBundles();
+    EXPECT_EQ(expanded, bundles(map));
+
+    /// only the neighbourhood of written bundles is expanded
+    rng_t<1> rng_coord(5.0, 15.0);
+    typename map_t::point_list_t points;
+    for (std::size_t i = 0 ; i < 500 ; ++ i)
+        points.emplace_back(rng_coord.get(), rng_coord.get());
+    for (const point_t &p : points)
+        map.insert(p);
+
+    std::vector<index_t> indices;
+    map.toBundleIndices(points.begin(), points.end(), indices);
+    std::set<index_t> written;
+    for (const index_t &bi : indices) {
+        const std::set<index_t> n = neighborhood(bi);
+        written.insert(n.begin(), n.end());
+    }
+    std::set<index_t> expected = bundles(map);
+    for (const index_t &bi : written) {
+        const bundle_t *b = map.get(bi);
+        if (b && expandable(*b)) {
+            const std::set<index_t> n = neighborhood(bi);
+            expected.insert(n.begin(), n.end());
+        }
+    }
+
+    /// copies keep track of written bundles
+    map_t copy(map);
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+    map.allocatePartiallyAllocatedBundles(&pool);
+    copy.allocatePartiallyAllocatedBundles();
+    EXPECT_EQ(expected, bundles(map));
+    EXPECT_EQ(expected, bundles(copy));
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/ingestion_pipeline.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 60;
+const std::size_t NUM_SCAN_POINTS   = 200;
+const std::size_t NUM_PRODUCERS     = 3;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using pipeline_t    = cslibs_ndt::map::IngestionPipeline<map_t>;
+using policy_t      = typename pipeline_t::Policy;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+cslibs_math_2d::Transform2d origin(const std::size_t i)
+{
+    return cslibs_math_2d::Transform2d(0.1 * i, -0.05 * i, 0.02 * i);
+}
+
+/// an insert function that is slower than the producers
+pipeline_t::insert_t slowInsert(std::atomic<std::size_t> &points)
+{
+    return [&points](const typename pointcloud_t::ConstPtr &p, const cslibs_math_2d::Transform2d &) {
+        points += p->size();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    };
+}
+
+void compareCounts(const map_t &expected, const map_t &map)
+{
+    std::size_t bundles = 0;
+    expected.traverse([&map, &bundles](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *mb = map.get(bi);
+        ASSERT_NE(mb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(), mb->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), mb->at(i)->numOccupied());
+        }
+    });
+    map.traverse([&bundles](const index_t &, const typename map_t::distribution_bundle_t &) {
+        -- bundles;
+    });
+    EXPECT_EQ(0ul, bundles);
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionPipeline)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    map_t expected(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        expected.insertDeduplicated(scans[i], origin(i));
+
+    /// several producers, nothing is lost with a blocking queue
+    typename map_t::Ptr map(new map_t(0.5));
+    {
+        pipeline_t pipeline(map, 4ul, policy_t::BLOCK);
+        std::vector<std::thread> producers;
+        for (std::size_t t = 0 ; t < NUM_PRODUCERS ; ++ t) {
+            producers.emplace_back([&pipeline, &scans, t]() {
+                for (std::size_t i = t ; i < NUM_SCANS ; i += NUM_PRODUCERS)
+                    EXPECT_TRUE(pipeline.push(scans[i], origin(i)));
+            });
+        }
+        for (std::thread &p : producers)
+            p.join();
+        pipeline.flush();
+
+        const typename pipeline_t::metrics_t metrics = pipeline.getMetrics();
+        EXPECT_EQ(NUM_SCANS, metrics.pushed);
+        EXPECT_EQ(NUM_SCANS, metrics.inserted);
+        EXPECT_EQ(0ul, metrics.dropped);
+        EXPECT_EQ(0ul, metrics.depth);
+        EXPECT_LE(metrics.max_depth, 4ul);
+        EXPECT_EQ(NUM_SCANS, metrics.insert.n);
+    }
+
+    /// the insertion order does not change the counts
+    compareCounts(expected, *map);
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionBackPressure)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    for (const policy_t policy : {policy_t::DROP_NEWEST, policy_t::DROP_OLDEST, policy_t::MERGE}) {
+        std::atomic<std::size_t> points(0ul);
+        std::size_t accepted = 0;
+        typename pipeline_t::metrics_t metrics;
+        {
+            pipeline_t pipeline(slowInsert(points), 2ul, policy);
+            for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+                accepted += pipeline.push(scans[i], origin(i)) ? 1ul : 0ul;
+            pipeline.flush();
+            metrics = pipeline.getMetrics();
+        }
+
+        EXPECT_EQ(accepted, metrics.pushed);
+        EXPECT_LE(metrics.max_depth, 2ul);
+        switch (policy) {
+        case policy_t::DROP_NEWEST:
+            EXPECT_GT(metrics.dropped, 0ul);
+            EXPECT_EQ(NUM_SCANS, accepted + metrics.dropped);
+            EXPECT_EQ(accepted, metrics.inserted);
+            break;
+        case policy_t::DROP_OLDEST:
+            EXPECT_GT(metrics.dropped, 0ul);
+            EXPECT_EQ(NUM_SCANS, accepted);
+            EXPECT_EQ(NUM_SCANS, metrics.inserted + metrics.dropped);
+            break;
+        default:
+            /// merged items keep all points
+            EXPECT_GT(metrics.merged, 0ul);
+            EXPECT_EQ(NUM_SCANS, metrics.inserted + metrics.merged);
+            EXPECT_EQ(NUM_SCANS * NUM_SCAN_POINTS, points.load());
+            break;
+        }
+    }
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionMergeOrigins)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    map_t expected(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        expected.insertDeduplicated(scans[i], origin(i));
+
+    /// merged scans are carved from their own origins, as if inserted one by one
+    typename map_t::Ptr map(new map_t(0.5));
+    typename pipeline_t::metrics_t metrics;
+    {
+        pipeline_t pipeline([&map](const typename pointcloud_t::ConstPtr &p, const cslibs_math_2d::Transform2d &o) {
+                                map->insertDeduplicated(p, o);
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            }, 1ul, policy_t::MERGE);
+        for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+            EXPECT_TRUE(pipeline.push(scans[i], origin(i)));
+        pipeline.flush();
+        metrics = pipeline.getMetrics();
+    }
+    EXPECT_GT(metrics.merged, 0ul);
+    compareCounts(expected, *map);
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionInsertFailure)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    /// every third insert throws, the pipeline keeps going and flush returns
+    std::atomic<std::size_t> calls(0ul);
+    typename pipeline_t::metrics_t metrics;
+    {
+        pipeline_t pipeline([&calls](const typename pointcloud_t::ConstPtr &, const cslibs_math_2d::Transform2d &) {
+                                if (calls++ % 3 == 0)
+                                    throw std::runtime_error("insert failed");
+                            }, 4ul, policy_t::BLOCK);
+        for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+            EXPECT_TRUE(pipeline.push(scans[i], origin(i)));
+        pipeline.flush();
+        metrics = pipeline.getMetrics();
+    }
+    EXPECT_EQ(NUM_SCANS, calls.load());
+    EXPECT_EQ(NUM_SCANS / 3, metrics.failed);
+    EXPECT_EQ(NUM_SCANS - NUM_SCANS / 3, metrics.inserted);
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionDownsample)
+{
+    pointcloud_t cloud;
+    cloud.insert(point_t(0.1, 0.1));
+    cloud.insert(point_t(0.3, 0.2));
+    cloud.insert(point_t(1.2, 0.1));
+    cloud.insert(point_t(0.2, 0.3));
+    cloud.insert(point_t(-0.2, 0.1));
+
+    const typename pointcloud_t::Ptr downsampled = pipeline_t::downsample(cloud, 0.5);
+    ASSERT_EQ(3ul, downsampled->size());
+    EXPECT_NEAR(0.2, downsampled->at(0)(0), 1e-9);
+    EXPECT_NEAR(0.2, downsampled->at(0)(1), 1e-9);
+    EXPECT_NEAR(1.2, downsampled->at(1)(0), 1e-9);
+    EXPECT_NEAR(-0.2, downsampled->at(2)(0), 1e-9);
+}
+
+TEST(Test_cslibs_ndt_2d, testIngestionDownsamplePipeline)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    typename map_t::Ptr map(new map_t(0.5));
+    pipeline_t pipeline(map, 4ul, policy_t::BLOCK, 0.2);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        EXPECT_TRUE(pipeline.push(scans[i], origin(i)));
+    pipeline.flush();
+
+    const typename pipeline_t::metrics_t metrics = pipeline.getMetrics();
+    EXPECT_EQ(NUM_SCANS, metrics.inserted);
+    EXPECT_EQ(NUM_SCANS, metrics.downsample.n);
+    EXPECT_EQ(NUM_SCANS, metrics.total.n);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/static_maps/gridmap.hpp>
+
+using static_map_t  = cslibs_ndt_2d::static_maps::Gridmap<double>;
+using dynamic_map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename static_map_t::index_t;
+using point_t       = typename static_map_t::point_t;
+
+TEST(Test_cslibs_ndt_2d, testStaticMapBounds)
+{
+    static_map_t map(cslibs_math_2d::Transform2d(), 1.0,
+                     typename static_map_t::size_t{{10ul, 10ul}},
+                     index_t{{-10, -10}});
+    map.insert(point_t(12.0, 0.0));
+    map.insert(point_t(2.0, 0.0));
+    EXPECT_EQ(map.get(point_t(12.0, 0.0)), nullptr);
+    EXPECT_NE(map.get(point_t(2.0, 0.0)), nullptr);
+    EXPECT_EQ(map.getMinBundleIndex(), (index_t{{-10, -10}}));
+    EXPECT_EQ(map.getMaxBundleIndex(), (index_t{{9, 9}}));
+}
+
+TEST(Test_cslibs_ndt_2d, testDynamicMapBounds)
+{
+    dynamic_map_t map(1.0);
+    EXPECT_TRUE(map.empty());
+    map.insert(point_t(12.0, -3.0));
+    map.insert(point_t(-2.0, 0.0));
+    EXPECT_EQ(map.getMinBundleIndex(), (index_t{{-4, -6}}));
+    EXPECT_EQ(map.getMaxBundleIndex(), (index_t{{24, 0}}));
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
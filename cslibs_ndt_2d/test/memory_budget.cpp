@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 60;
+const std::size_t NUM_SCAN_POINTS   = 100;
+const std::size_t BUDGET            = 256 * 1024;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t        = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using ivm_t        = typename map_t::inverse_sensor_model_t;
+using index_t      = typename map_t::index_t;
+using pointcloud_t = typename map_t::pointcloud_t;
+
+/// scans taken along a straight drive
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-5.0, 5.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(cslibs_math_2d::Point2d(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+cslibs_math_2d::Transform2d scanOrigin(const std::size_t i)
+{
+    return cslibs_math_2d::Transform2d(static_cast<double>(i) * 4.0, 0.0, 0.0);
+}
+
+void testEqual(const map_t &map, const map_t &reference)
+{
+    std::size_t bundles = 0;
+    reference.traverse([&map, &bundles](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *bm = map.get(bi);
+        ASSERT_NE(bm, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(),     bm->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), bm->at(i)->numOccupied());
+        }
+    });
+
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    EXPECT_EQ(bundles, indices.size());
+}
+
+std::vector<std::string> tileFiles(const std::string &directory)
+{
+    std::vector<std::string> files;
+    DIR *dir = opendir(directory.c_str());
+    while (dirent *e = readdir(dir)) {
+        const std::string name(e->d_name);
+        if (name != "." && name != "..")
+            files.emplace_back(directory + "/" + name);
+    }
+    closedir(dir);
+    return files;
+}
+
+/// loads every evicted tile
+void sampleAll(const map_t &map, const typename ivm_t::Ptr &ivm)
+{
+    for (double x = -5.0 ; x < NUM_SCANS * 4.0 + 5.0 ; x += 1.0)
+        for (double y = -5.0 ; y < 5.0 ; y += 1.0)
+            map.sample(cslibs_math_2d::Point2d(x, y), ivm);
+}
+
+TEST(Test_cslibs_ndt_2d, testMemoryBudget)
+{
+    char directory[] = "/tmp/cslibs_ndt_tiles_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    map_t reference(0.5);
+    std::size_t max_size = 0;
+    {
+        map_t map(0.5);
+        map.setMemoryBudget(BUDGET, directory, 16);
+
+        for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+            map.insert(scans[i], scanOrigin(i));
+            reference.insert(scans[i], scanOrigin(i));
+            max_size = std::max(max_size, map.getByteSize());
+        }
+
+        /// traversals stream evicted tiles without loading them
+        const std::size_t size = map.getByteSize();
+        std::size_t bundles = 0;
+        map.traverse([&reference, &bundles](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+            ++ bundles;
+            const typename map_t::distribution_bundle_t *br = reference.get(bi);
+            ASSERT_NE(br, nullptr);
+            for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+                EXPECT_EQ(br->at(i)->numFree(),     b.at(i)->numFree());
+                EXPECT_EQ(br->at(i)->numOccupied(), b.at(i)->numOccupied());
+            }
+        });
+        std::vector<index_t> indices;
+        reference.getBundleIndices(indices);
+        EXPECT_EQ(indices.size(), bundles);
+
+        cslibs_ndt::utility::ThreadPool pool(2);
+        cslibs_ndt::utility::ThreadLocal<std::size_t> parallel(pool);
+        map.parallelTraverse([&parallel](const index_t &, const typename map_t::distribution_bundle_t &) {
+            ++ parallel.local();
+        }, pool);
+        EXPECT_EQ(bundles, parallel.combine(0ul, [](std::size_t a, std::size_t b) { return a + b; }));
+
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            std::size_t distributions = 0;
+            auto count = [&distributions](const index_t &, const typename map_t::distribution_t &) { ++ distributions; };
+            map.traverseDistributions(i, count);
+            const std::size_t evicted = distributions;
+            distributions = 0;
+            reference.traverseDistributions(i, count);
+            EXPECT_EQ(distributions, evicted);
+        }
+        EXPECT_EQ(size, map.getByteSize());
+        EXPECT_THROW(map.getStorages(), std::runtime_error);
+
+        /// evicted tiles are loaded again on access
+        rng_t<1> rng_x(-5.0, NUM_SCANS * 4.0 + 5.0);
+        rng_t<1> rng_y(-5.0, 5.0);
+        for (std::size_t i = 0 ; i < 500 ; ++ i) {
+            const cslibs_math_2d::Point2d p(rng_x.get(), rng_y.get());
+            EXPECT_NEAR(reference.sample(p, ivm), map.sample(p, ivm), 1e-9);
+        }
+
+        /// copies contain all tiles
+        const map_t copy(map);
+        testEqual(copy, reference);
+
+        /// the map stays usable after reloading tiles
+        for (std::size_t i = 0 ; i < scans.size() ; i += 7) {
+            map.insert(scans[i], scanOrigin(i));
+            reference.insert(scans[i], scanOrigin(i));
+        }
+
+        /// tiles which can not be read stay on disk and evicted
+        const std::vector<std::string> files = tileFiles(directory);
+        ASSERT_FALSE(files.empty());
+        for (const std::string &f : files)
+            ASSERT_EQ(std::rename(f.c_str(), (f + ".moved").c_str()), 0);
+        EXPECT_THROW(map.restoreEvictedTiles(), std::runtime_error);
+        EXPECT_THROW(sampleAll(map, ivm), std::runtime_error);
+        for (const std::string &f : files)
+            ASSERT_EQ(std::rename((f + ".moved").c_str(), f.c_str()), 0);
+
+        map.restoreEvictedTiles();
+        testEqual(map, reference);
+    }
+
+    EXPECT_LT(max_size, BUDGET * 5 / 4);
+    EXPECT_GT(reference.getByteSize(), 2 * BUDGET);
+
+    /// the tile files are removed with the map
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST(Test_cslibs_ndt_2d, testMemoryBudgetWriteError)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    /// tiles can not be written to a missing directory
+    map_t map(0.5);
+    map.setMemoryBudget(BUDGET, "/tmp/cslibs_ndt_missing_directory", 16);
+    EXPECT_THROW({
+        for (std::size_t i = 0 ; i < scans.size() ; ++ i)
+            map.insert(scans[i], scanOrigin(i));
+    }, std::runtime_error);
+
+    /// nothing was evicted, so all bundles are still there
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    EXPECT_FALSE(indices.empty());
+    for (const index_t &bi : indices)
+        EXPECT_NE(map.get(bi), nullptr);
+}
+
+TEST(Test_cslibs_ndt_2d, testMemoryBudgetRegrid)
+{
+    char directory[] = "/tmp/cslibs_ndt_tiles_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    map_t source(0.5), reference(0.5);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        source.insert(scans[i], scanOrigin(i));
+        reference.insert(scans[i], scanOrigin(i));
+    }
+
+    /// regridding evicts tiles while targets are allocated
+    const cslibs_math_2d::Transform2d w_T_source(0.3, 1.7, 0.4);
+    cslibs_ndt::utility::ThreadPool pool(2);
+    reference.insert(source, w_T_source, &pool);
+    {
+        map_t map(0.5);
+        map.setMemoryBudget(BUDGET, directory, 16);
+        for (std::size_t i = 0 ; i < scans.size() ; ++ i)
+            map.insert(scans[i], scanOrigin(i));
+        map.insert(source, w_T_source, &pool);
+
+        map.restoreEvictedTiles();
+        testEqual(map, reference);
+    }
+    EXPECT_EQ(rmdir(directory), 0);
+
+    /// and copies storages shared with a snapshot
+    map_t map(0.5);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i)
+        map.insert(scans[i], scanOrigin(i));
+    const typename map_t::Ptr snapshot = map.snapshot();
+    map.insert(source, w_T_source, &pool);
+    testEqual(map, reference);
+    testEqual(*snapshot, source);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
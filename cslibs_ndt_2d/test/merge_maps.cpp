@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/common/weighted_occupancy_distribution.hpp>
+#include <cslibs_ndt/map/merge_maps.hpp>
+
+#include "scan.hpp"
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cstdlib>
+#include <unistd.h>
+
+const std::size_t NUM_BEAMS = 360;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using gridmap_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using occupancy_map_t   = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t           = typename gridmap_t::index_t;
+using pointcloud_t      = typename gridmap_t::pointcloud_t;
+using point_t           = typename gridmap_t::point_t;
+using transform_t       = cslibs_math_2d::Transform2d;
+
+transform_t origin(const std::size_t i)
+{
+    return transform_t(0.2 * i, -0.1 * i, 0.05 * i);
+}
+
+template <typename map_t, typename compare_t>
+void compareMaps(const map_t &expected, const map_t &map, const compare_t &compare)
+{
+    std::size_t bundles = 0;
+    expected.traverse([&map, &bundles, &compare](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *mb = map.get(bi);
+        ASSERT_NE(mb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            compare(*b.at(i), *mb->at(i));
+    });
+    map.traverse([&bundles](const index_t &, const typename map_t::distribution_bundle_t &) {
+        -- bundles;
+    });
+    EXPECT_EQ(0ul, bundles);
+}
+
+void compareDistributions(const typename gridmap_t::distribution_t &a, const typename gridmap_t::distribution_t &b)
+{
+    ASSERT_EQ(a.data().getN(), b.data().getN());
+    for (std::size_t j = 0 ; j < 2 ; ++ j)
+        EXPECT_NEAR(a.data().getMean()(j), b.data().getMean()(j), 1e-6);
+    EXPECT_NEAR(0.0, (a.data().getCorrelated() - b.data().getCorrelated()).norm(), 1e-6);
+}
+
+void compareOccupancy(const typename occupancy_map_t::distribution_t &a, const typename occupancy_map_t::distribution_t &b)
+{
+    EXPECT_EQ(a.numFree(), b.numFree());
+    ASSERT_EQ(a.numOccupied(), b.numOccupied());
+    if (a.getDistribution()) {
+        for (std::size_t j = 0 ; j < 2 ; ++ j)
+            EXPECT_NEAR(a.getDistribution()->getMean()(j), b.getDistribution()->getMean()(j), 1e-6);
+        EXPECT_NEAR(0.0, (a.getDistribution()->getCorrelated() - b.getDistribution()->getCorrelated()).norm(), 1e-6);
+    }
+}
+
+TEST(Test_cslibs_ndt_2d, testMergeDistributions)
+{
+    rng_t<2> rng(-1.0, 1.0);
+    std::vector<point_t> samples;
+    for (std::size_t i = 0 ; i < 20 ; ++ i)
+        samples.emplace_back(point_t(rng.get()));
+
+    /// merging is the same as adding all samples to one distribution
+    typename gridmap_t::distribution_t a, b, all;
+    for (std::size_t i = 0 ; i < samples.size() ; ++ i) {
+        (i < 7 ? a : b).data().add(samples[i].data());
+        all.data().add(samples[i].data());
+    }
+    a.merge(b);
+    compareDistributions(all, a);
+
+    using occupancy_t = typename occupancy_map_t::distribution_t;
+    occupancy_t oa(3), ob(2), oall(5);
+    for (std::size_t i = 0 ; i < samples.size() ; ++ i) {
+        (i < 7 ? oa : ob).updateOccupied(samples[i].data());
+        oall.updateOccupied(samples[i].data());
+    }
+    occupancy_t empty;
+    empty.merge(oa);
+    empty.merge(ob);
+    compareOccupancy(oall, empty);
+
+    using weighted_t = cslibs_ndt::WeightedOccupancyDistribution<double,2>;
+    weighted_t wa(1, 0.5), wb(2, 1.5);
+    wa.updateOccupied(samples[0].data(), 0.5);
+    wb.updateOccupied(samples[1].data(), 2.0);
+    wa.merge(wb);
+    EXPECT_EQ(3ul, wa.numFree());
+    EXPECT_NEAR(2.0, wa.weightFree(), 1e-9);
+    EXPECT_NEAR(2.5, wa.weightOccupied(), 1e-9);
+
+    /// bundles of pointers only fill empty bins
+    using bundle_t = typename gridmap_t::distribution_bundle_t;
+    bundle_t ba, bb;
+    ba.data().fill(nullptr);
+    bb.data().fill(&b);
+    ba[0] = &a;
+    ba.merge(bb);
+    EXPECT_EQ(&a, ba[0]);
+    for (std::size_t i = 1 ; i < bundle_t::size() ; ++ i)
+        EXPECT_EQ(&b, ba[i]);
+}
+
+TEST(Test_cslibs_ndt_2d, testMergeMaps)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 4 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    /// two sessions in the same frame and one in a frame moved by whole cells
+    const transform_t b_T_c(3.0, -2.0, 0.0);
+    gridmap_t a(1.0), b(1.0), c(1.0), expected(1.0);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        (i < 2 ? a : b).insert(scans[i], origin(i));
+        c.insert(scans[i], origin(i));
+        expected.insert(scans[i], origin(i));
+    }
+
+    cslibs_ndt::utility::ThreadPool pool(2);
+    for (cslibs_ndt::utility::ThreadPool *p : {static_cast<cslibs_ndt::utility::ThreadPool*>(nullptr), &pool})
+        compareMaps(expected, *cslibs_ndt::map::mergeMaps(a, b, transform_t(), p), compareDistributions);
+
+    gridmap_t shifted(1.0);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i)
+        shifted.insert(scans[i], b_T_c * origin(i));
+    const typename gridmap_t::Ptr merged = cslibs_ndt::map::mergeMaps(c, gridmap_t(1.0), b_T_c, &pool);
+    compareMaps(shifted, *merged, compareDistributions);
+
+    /// the inputs are not changed
+    compareMaps(expected, c, compareDistributions);
+}
+
+TEST(Test_cslibs_ndt_2d, testMergeBudgetedMaps)
+{
+    char directory[] = "/tmp/cslibs_ndt_tiles_XXXXXX";
+    ASSERT_NE(mkdtemp(directory), nullptr);
+
+    /// scans along a drive, far more than the budget of a holds
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 16 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+    auto drive = [](const std::size_t i) {
+        return transform_t(25.0 * i, 0.0, 0.0);
+    };
+
+    const transform_t b_T_a(3.0, -2.0, 0.0);
+    gridmap_t expected(1.0), shifted(1.0);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        expected.insert(scans[i], drive(i));
+        shifted.insert(scans[i], b_T_a * drive(i));
+    }
+
+    {
+        gridmap_t a(1.0);
+        a.setMemoryBudget(128 * 1024, directory, 16);
+        for (std::size_t i = 0 ; i < scans.size() ; ++ i)
+            a.insert(scans[i], drive(i));
+        ASSERT_LT(a.getByteSize(), expected.getByteSize() / 2);
+
+        /// evicted tiles of a are merged as well, on the direct and the regridding path
+        cslibs_ndt::utility::ThreadPool pool(2);
+        compareMaps(expected, *cslibs_ndt::map::mergeMaps(a, gridmap_t(1.0), transform_t(), &pool), compareDistributions);
+        compareMaps(shifted,  *cslibs_ndt::map::mergeMaps(a, gridmap_t(1.0), b_T_a, &pool), compareDistributions);
+    }
+    EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST(Test_cslibs_ndt_2d, testMergeOccupancyMaps)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 4 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    const transform_t b_T_a(-1.0, 2.0, 0.0);
+    occupancy_map_t a(1.0), b(1.0), expected(1.0), aligned(1.0);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        if (i < 2)
+            a.insert(scans[i], origin(i));
+        else
+            b.insert(scans[i], origin(i));
+        expected.insert(scans[i], i < 2 ? b_T_a * origin(i) : origin(i));
+        aligned.insert(scans[i], origin(i));
+    }
+
+    cslibs_ndt::utility::ThreadPool pool(2);
+    compareMaps(expected, *cslibs_ndt::map::mergeMaps(a, b, b_T_a, &pool), compareOccupancy);
+    for (cslibs_ndt::utility::ThreadPool *p : {static_cast<cslibs_ndt::utility::ThreadPool*>(nullptr), &pool})
+        compareMaps(aligned, *cslibs_ndt::map::mergeMaps(a, b, transform_t(), p), compareOccupancy);
+}
+
+TEST(Test_cslibs_ndt_2d, testMergeRotatedMeans)
+{
+    /// tight clusters off the bundle centers, each one inside one cell of every bin
+    rng_t<2> rng_offset(-0.02, 0.02);
+    gridmap_t a(1.0);
+    const double r = a.getBundleResolution();
+    std::vector<point_t> means;
+    for (int x = -4 ; x < 4 ; ++ x) {
+        for (int y = -4 ; y < 4 ; ++ y) {
+            const point_t c((6 * x + 0.1) * r, (6 * y + 0.9) * r);
+            point_t mean(0.0, 0.0);
+            for (std::size_t n = 0 ; n < 10 ; ++ n) {
+                const point_t p = c + point_t(rng_offset.get());
+                a.insert(p);
+                mean += p;
+            }
+            means.emplace_back(mean / 10.0);
+        }
+    }
+
+    /// every merged mean lands in the distributions whose cells contain it
+    const transform_t b_T_a(1.3, -0.4, 0.7);
+    cslibs_ndt::utility::ThreadPool pool(2);
+    for (cslibs_ndt::utility::ThreadPool *p : {static_cast<cslibs_ndt::utility::ThreadPool*>(nullptr), &pool}) {
+        const typename gridmap_t::Ptr merged = cslibs_ndt::map::mergeMaps(a, gridmap_t(1.0), b_T_a, p);
+        const typename gridmap_t::distribution_storage_array_t storages = merged->getStorages();
+        for (const point_t &m : means) {
+            const point_t m_b = b_T_a * m;
+            const index_t bi{{static_cast<int>(std::floor(m_b(0) / r)), static_cast<int>(std::floor(m_b(1) / r))}};
+            const typename gridmap_t::index_list_t indices = cslibs_ndt::utility::generate_indices<typename gridmap_t::index_list_t, 2>(bi);
+            for (std::size_t i = 0 ; i < gridmap_t::bin_count ; ++ i) {
+                const typename gridmap_t::distribution_t *d = storages[i]->get(indices[i]);
+                ASSERT_NE(d, nullptr);
+                EXPECT_EQ(10ul, d->data().getN());
+                for (std::size_t j = 0 ; j < 2 ; ++ j)
+                    EXPECT_NEAR(m_b(j), d->data().getMean()(j), 1e-6);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/weighted_occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/conversion/probability_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+#include <stdexcept>
+
+const std::size_t NUM_POINTS    = 100000;
+const std::size_t NUM_THREADS   = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using point_t       = typename map_t::point_t;
+using bundle_t      = typename map_t::distribution_bundle_t;
+
+typename map_t::Ptr generateMap()
+{
+    rng_t<1> rng_coord(-50.0, 50.0);
+
+    typename map_t::Ptr map(new map_t(0.5));
+    for (std::size_t i = 0 ; i < NUM_POINTS ; ++ i)
+        map->insert(point_t(rng_coord.get(), rng_coord.get()));
+    return map;
+}
+
+TEST(Test_cslibs_ndt_2d, testParallelTraverse)
+{
+    const typename map_t::Ptr map = generateMap();
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    std::set<index_t> expected;
+    std::size_t expected_n = 0;
+    map->traverse([&expected, &expected_n](const index_t &bi, const bundle_t &b) {
+        expected.insert(bi);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            expected_n += b.at(i)->data().getN();
+    });
+
+    /// every bundle is visited exactly once
+    cslibs_ndt::utility::ThreadLocal<std::vector<index_t>> visited(pool);
+    cslibs_ndt::utility::ThreadLocal<std::size_t> n(pool, 0ul);
+    map->parallelTraverse([&visited, &n](const index_t &bi, const bundle_t &b) {
+        visited.local().emplace_back(bi);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            n.local() += b.at(i)->data().getN();
+    }, pool);
+
+    std::set<index_t> actual;
+    visited.traverse([&actual](const std::vector<index_t> &bis) {
+        for (const index_t &bi : bis)
+            EXPECT_TRUE(actual.insert(bi).second);
+    });
+    EXPECT_TRUE(expected == actual);
+    EXPECT_EQ(expected_n, n.combine(0ul, [](std::size_t a, std::size_t b) { return a + b; }));
+
+    /// the pool is reusable and hands exceptions to the caller
+    EXPECT_THROW(pool.run(100ul, [](const std::size_t task) {
+        if (task == 42ul)
+            throw std::runtime_error("task failed");
+    }), std::runtime_error);
+    std::atomic<std::size_t> tasks(0ul);
+    pool.run(100ul, [&tasks](const std::size_t) { ++ tasks; });
+    EXPECT_EQ(tasks.load(), 100ul);
+}
+
+TEST(Test_cslibs_ndt_2d, testParallelAllocation)
+{
+    const typename map_t::Ptr serial   = generateMap();
+    const typename map_t::Ptr parallel = generateMap();
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    serial->allocatePartiallyAllocatedBundles();
+    parallel->allocatePartiallyAllocatedBundles(&pool);
+
+    std::vector<index_t> serial_indices, parallel_indices;
+    serial->getBundleIndices(serial_indices);
+    parallel->getBundleIndices(parallel_indices);
+    EXPECT_EQ(std::set<index_t>(serial_indices.begin(), serial_indices.end()),
+              std::set<index_t>(parallel_indices.begin(), parallel_indices.end()));
+}
+
+TEST(Test_cslibs_ndt_2d, testParallelConversion)
+{
+    using gridmap_t = cslibs_gridmaps::static_maps::ProbabilityGridmap<double,double>;
+
+    const typename map_t::Ptr serial_map   = generateMap();
+    const typename map_t::Ptr parallel_map = generateMap();
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    typename gridmap_t::Ptr serial, parallel;
+    cslibs_ndt_2d::conversion::from<double>(serial_map, serial, 0.05);
+    cslibs_ndt_2d::conversion::from<double>(parallel_map, parallel, 0.05, true, &pool);
+
+    ASSERT_NE(serial, nullptr);
+    ASSERT_NE(parallel, nullptr);
+    EXPECT_TRUE(serial->getData() == parallel->getData());
+}
+
+template <typename occupancy_map_t, typename compare_t>
+void testParallelCarving(const compare_t &compare)
+{
+    using bundle_t = typename occupancy_map_t::distribution_bundle_t;
+    using pointcloud_t = typename occupancy_map_t::pointcloud_t;
+
+    rng_t<1> rng_coord(-20.0, 20.0);
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t i = 0 ; i < 10000 ; ++ i)
+        scan->insert(point_t(rng_coord.get(), rng_coord.get()));
+    const cslibs_math_2d::Transform2d origin(1.0, -0.5, 0.2);
+
+    occupancy_map_t serial(0.5), parallel(0.5);
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+    serial.insert(scan, origin);
+    parallel.insertDeduplicated(scan, origin, &pool);
+
+    std::size_t bundles = 0;
+    serial.traverse([&parallel, &bundles, &compare](const index_t &bi, const bundle_t &b) {
+        ++ bundles;
+        const bundle_t *bb = parallel.get(bi);
+        ASSERT_NE(bb, nullptr);
+        for (std::size_t i = 0 ; i < occupancy_map_t::bin_count ; ++ i)
+            compare(*b.at(i), *bb->at(i));
+    });
+    parallel.traverse([&bundles](const index_t &, const bundle_t &) {
+        -- bundles;
+    });
+    EXPECT_EQ(0ul, bundles);
+}
+
+TEST(Test_cslibs_ndt_2d, testParallelCarving)
+{
+    using occupancy_distribution_t = cslibs_ndt::OccupancyDistribution<double,2>;
+    testParallelCarving<cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>>(
+                [](const occupancy_distribution_t &a, const occupancy_distribution_t &b) {
+        EXPECT_EQ(a.numFree(), b.numFree());
+        EXPECT_EQ(a.numOccupied(), b.numOccupied());
+    });
+
+    using weighted_distribution_t = cslibs_ndt::WeightedOccupancyDistribution<double,2>;
+    testParallelCarving<cslibs_ndt_2d::dynamic_maps::WeightedOccupancyGridmap<double>>(
+                [](const weighted_distribution_t &a, const weighted_distribution_t &b) {
+        EXPECT_EQ(a.numFree(), b.numFree());
+        EXPECT_NEAR(a.weightFree(), b.weightFree(), 1e-9 * std::max(1.0, a.weightFree()));
+        EXPECT_NEAR(a.weightOccupied(), b.weightOccupied(), 1e-9 * std::max(1.0, a.weightOccupied()));
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
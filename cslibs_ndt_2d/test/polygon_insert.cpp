@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "scan.hpp"
+
+#include <set>
+
+const std::size_t NUM_BEAMS = 1080;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using bundle_t      = typename map_t::distribution_bundle_t;
+using distribution_t = typename map_t::distribution_t;
+
+/// even-odd rule for a point in bundle coordinates
+bool inside(const std::vector<point_t> &polygon, const double x, const double y)
+{
+    bool in = false;
+    for (std::size_t k = 0, l = polygon.size() - 1 ; k < polygon.size() ; l = k ++) {
+        const point_t &a = polygon[k], &b = polygon[l];
+        if ((a(1) > y) != (b(1) > y) && x < a(0) + (y - a(1)) * (b(0) - a(0)) / (b(1) - a(1)))
+            in = !in;
+    }
+    return in;
+}
+
+TEST(Test_cslibs_ndt_2d, testPolygonInsert)
+{
+    map_t map(cslibs_math_2d::Transform2d(0.3, -0.2, 0.1), 0.5);
+    const typename pointcloud_t::Ptr scan = generateScan(NUM_BEAMS);
+    const cslibs_math_2d::Transform2d origin(1.0, 2.0, 0.4);
+    map.insertPolygon(scan, origin);
+
+    const double inv = 1.0 / map.getBundleResolution();
+    const cslibs_math_2d::Transform2d m_T_w = map.getInitialOrigin().inverse();
+    std::vector<point_t> polygon(1, m_T_w * origin.translation() * inv);
+    typename map_t::point_list_t points_w;
+    for (const point_t &p : *scan) {
+        points_w.emplace_back(origin * p);
+        polygon.emplace_back(m_T_w * points_w.back() * inv);
+    }
+    std::vector<index_t> end_indices;
+    map.toBundleIndices(points_w.begin(), points_w.end(), end_indices);
+    const std::set<index_t> ends(end_indices.begin(), end_indices.end());
+
+    /// exactly the bundles with their center inside of the polygon are free
+    std::set<index_t> expected = ends;
+    std::size_t free = 0;
+    for (int x = -100 ; x < 100 ; ++ x) {
+        for (int y = -100 ; y < 100 ; ++ y) {
+            const index_t bi{{x, y}};
+            if (ends.count(bi) == 0 && inside(polygon, x + 0.5, y + 0.5)) {
+                expected.insert(bi);
+                ++ free;
+            }
+        }
+    }
+
+    std::set<index_t> bundles;
+    std::set<const distribution_t*> distributions;
+    map.traverse([&bundles, &distributions](const index_t &bi, const bundle_t &b) {
+        bundles.insert(bi);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            distributions.insert(b.at(i));
+    });
+    EXPECT_EQ(expected, bundles);
+
+    /// one free update per bundle, which is shared by its distributions
+    std::size_t num_free = 0;
+    for (const distribution_t *d : distributions)
+        num_free += d->numFree();
+    EXPECT_EQ(map_t::bin_count * free, num_free);
+    for (const index_t &bi : ends)
+        EXPECT_GT(map.get(bi)->at(0)->numOccupied(), 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
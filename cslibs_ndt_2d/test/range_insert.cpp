@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/weighted_occupancy_gridmap.hpp>
+
+#include "scan.hpp"
+
+#include <limits>
+
+const std::size_t NUM_BEAMS = 1080;
+const double ANGLE_MIN      = -0.75 * M_PI;
+const double ANGLE_INC      = 1.5 * M_PI / (NUM_BEAMS - 1);
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using bundle_t      = typename map_t::distribution_bundle_t;
+using ray_table_t   = typename map_t::ray_table_t;
+
+/// ranges of a wavy room, with a few invalid beams
+std::vector<float> generateRanges()
+{
+    const std::vector<double> room = generateScanRanges(NUM_BEAMS);
+    std::vector<float> ranges(room.begin(), room.end());
+    ranges[10]  = std::numeric_limits<float>::quiet_NaN();
+    ranges[20]  = 0.01f;
+    ranges[30]  = 100.0f;
+    return ranges;
+}
+
+/// what the conversion to a pointcloud does for each scan
+typename pointcloud_t::Ptr toPointcloud(const std::vector<float> &ranges)
+{
+    typename pointcloud_t::Ptr cloud(new pointcloud_t);
+    for (std::size_t i = 0 ; i < ranges.size() ; ++ i) {
+        const double r = static_cast<double>(ranges[i]);
+        if (!std::isfinite(r) || r < 0.1 || r > 30.0)
+            continue;
+        const double angle = ANGLE_MIN + static_cast<double>(i) * ANGLE_INC;
+        cloud->insert(point_t(r * std::cos(angle), r * std::sin(angle)));
+    }
+    return cloud;
+}
+
+template <typename occupancy_map_t, typename compare_t>
+void testRangeInsert(const compare_t &compare)
+{
+    const typename occupancy_map_t::ray_table_t rays(ANGLE_MIN, ANGLE_INC, NUM_BEAMS);
+    EXPECT_EQ(NUM_BEAMS, rays.size());
+
+    occupancy_map_t cloud_map(0.5), range_map(0.5);
+    cslibs_ndt::utility::ThreadPool pool(2);
+    for (std::size_t i = 0 ; i < 3 ; ++ i) {
+        const std::vector<float> ranges = generateRanges();
+        const cslibs_math_2d::Transform2d origin(0.5 * i, -0.25 * i, 0.1 * i);
+        cloud_map.insertDeduplicated(toPointcloud(ranges), origin);
+        range_map.insertRanges(rays, ranges.data(), origin, 0.1, 30.0, i == 2 ? &pool : nullptr);
+    }
+
+    std::size_t bundles = 0;
+    cloud_map.traverse([&range_map, &bundles, &compare](const index_t &bi, const typename occupancy_map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename occupancy_map_t::distribution_bundle_t *rb = range_map.get(bi);
+        ASSERT_NE(rb, nullptr);
+        for (std::size_t i = 0 ; i < occupancy_map_t::bin_count ; ++ i)
+            compare(*b.at(i), *rb->at(i));
+    });
+    range_map.traverse([&bundles](const index_t &, const typename occupancy_map_t::distribution_bundle_t &) {
+        -- bundles;
+    });
+    EXPECT_EQ(0ul, bundles);
+}
+
+TEST(Test_cslibs_ndt_2d, testRangeInsert)
+{
+    /// the same scan as a pointcloud gives up to rounding the same map
+    using occupancy_distribution_t = cslibs_ndt::OccupancyDistribution<double,2>;
+    testRangeInsert<map_t>([](const occupancy_distribution_t &a, const occupancy_distribution_t &b) {
+        EXPECT_EQ(a.numFree(), b.numFree());
+        EXPECT_EQ(a.numOccupied(), b.numOccupied());
+    });
+
+    using weighted_distribution_t = cslibs_ndt::WeightedOccupancyDistribution<double,2>;
+    testRangeInsert<cslibs_ndt_2d::dynamic_maps::WeightedOccupancyGridmap<double>>(
+                [](const weighted_distribution_t &a, const weighted_distribution_t &b) {
+        EXPECT_EQ(a.numFree(), b.numFree());
+        EXPECT_NEAR(a.weightOccupied(), b.weightOccupied(), 1e-9 * std::max(1.0, a.weightOccupied()));
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
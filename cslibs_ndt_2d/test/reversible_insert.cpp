@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include "scan.hpp"
+
+const std::size_t NUM_BEAMS     = 720;
+const std::size_t NUM_SCANS     = 40;
+const std::size_t NUM_CORRECTED = 4;
+
+using map_t          = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t        = typename map_t::index_t;
+using pointcloud_t   = typename map_t::pointcloud_t;
+using point_t        = typename map_t::point_t;
+using bundle_t       = typename map_t::distribution_bundle_t;
+using contribution_t = typename map_t::contribution_t;
+
+cslibs_math_2d::Transform2d origin(const std::size_t i)
+{
+    return cslibs_math_2d::Transform2d(0.2 * i, 0.1 * i, 0.03 * i);
+}
+
+/// equal statistics, bundles which only exist in map have to be empty
+template <typename m_t>
+std::array<const typename m_t::distribution_t*, m_t::bin_count> findDistributions(const m_t &map, const index_t &bi)
+{
+    const typename m_t::distribution_storage_array_t storages = map.getStorages();
+    const typename m_t::index_list_t indices = cslibs_ndt::utility::generate_indices<typename m_t::index_list_t, 2>(bi);
+    std::array<const typename m_t::distribution_t*, m_t::bin_count> distributions;
+    for (std::size_t i = 0 ; i < m_t::bin_count ; ++ i)
+        distributions[i] = storages[i]->get(indices[i]);
+    return distributions;
+}
+
+void compare(const map_t &expected, const map_t &map)
+{
+    expected.traverse([&map](const index_t &bi, const bundle_t &) {
+        EXPECT_NE(map.get(bi), nullptr);
+    });
+    map.traverse([&expected](const index_t &bi, const bundle_t &b) {
+        const std::array<const typename map_t::distribution_t*, map_t::bin_count> e = findDistributions(expected, bi);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            const typename map_t::distribution_t *d = b.at(i);
+            if (!e.at(i)) {
+                EXPECT_EQ(0ul, d->numFree());
+                EXPECT_EQ(0ul, d->numOccupied());
+                EXPECT_EQ(nullptr, d->getDistribution());
+                continue;
+            }
+            EXPECT_EQ(e.at(i)->numFree(), d->numFree());
+            ASSERT_EQ(e.at(i)->numOccupied(), d->numOccupied());
+            if (d->getDistribution()) {
+                for (std::size_t j = 0 ; j < 2 ; ++ j)
+                    EXPECT_NEAR(e.at(i)->getDistribution()->getMean()(j), d->getDistribution()->getMean()(j), 1e-6);
+                EXPECT_NEAR(0.0, (e.at(i)->getDistribution()->getCorrelated() - d->getDistribution()->getCorrelated()).norm(), 1e-6);
+            }
+        }
+    });
+}
+
+TEST(Test_cslibs_ndt_2d, testRemoveScan)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 3 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    map_t map(0.5), expected(0.5);
+    std::vector<contribution_t> contributions(scans.size());
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        map.insertRecorded(scans[i], origin(i), contributions[i]);
+        EXPECT_FALSE(contributions[i].empty());
+    }
+    expected.insertDeduplicated(scans[0], origin(0));
+    expected.insertDeduplicated(scans[2], origin(2));
+
+    map.remove(contributions[1]);
+    compare(expected, map);
+
+    /// removing all scans leaves an empty map
+    map.remove(contributions[0]);
+    map.remove(contributions[2]);
+    compare(map_t(0.5), map);
+}
+
+TEST(Test_cslibs_ndt_2d, testReinsertScan)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 4 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+    const cslibs_math_2d::Transform2d corrected(0.5, -0.3, 0.2);
+
+    map_t map(0.5), expected(0.5);
+    std::vector<contribution_t> contributions(scans.size());
+    cslibs_ndt::utility::ThreadPool pool(2);
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        map.insertRecorded(scans[i], origin(i), contributions[i], &pool);
+        expected.insertDeduplicated(scans[i], i == 2 ? corrected : origin(i));
+    }
+
+    map.reinsert(scans[2], corrected, contributions[2]);
+    compare(expected, map);
+}
+
+using gridmap_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+
+void compareGridmaps(const gridmap_t &expected, const gridmap_t &map)
+{
+    expected.traverse([&map](const index_t &bi, const typename gridmap_t::distribution_bundle_t &) {
+        EXPECT_NE(map.get(bi), nullptr);
+    });
+    map.traverse([&expected](const index_t &bi, const typename gridmap_t::distribution_bundle_t &b) {
+        const std::array<const typename gridmap_t::distribution_t*, gridmap_t::bin_count> e = findDistributions(expected, bi);
+        for (std::size_t i = 0 ; i < gridmap_t::bin_count ; ++ i) {
+            const typename gridmap_t::distribution_t::distribution_t &d = b.at(i)->data();
+            if (!e.at(i)) {
+                EXPECT_EQ(0ul, d.getN());
+                continue;
+            }
+            ASSERT_EQ(e.at(i)->data().getN(), d.getN());
+            if (d.getN() == 0)
+                continue;
+            for (std::size_t j = 0 ; j < 2 ; ++ j)
+                EXPECT_NEAR(e.at(i)->data().getMean()(j), d.getMean()(j), 1e-6);
+            EXPECT_NEAR(0.0, (e.at(i)->data().getCorrelated() - d.getCorrelated()).norm(), 1e-6);
+        }
+    });
+}
+
+TEST(Test_cslibs_ndt_2d, testReinsertGridmapScan)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < 4 ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+    const cslibs_math_2d::Transform2d corrected(0.5, -0.3, 0.2);
+
+    gridmap_t map(0.5), removed(0.5), expected(0.5);
+    std::vector<typename gridmap_t::contribution_t> contributions(scans.size());
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        map.insertRecorded(scans[i], origin(i), contributions[i]);
+        EXPECT_FALSE(contributions[i].empty());
+        expected.insert(scans[i], i == 2 ? corrected : origin(i));
+        if (i != 1)
+            removed.insert(scans[i], origin(i));
+    }
+
+    gridmap_t copy(map);
+    copy.remove(contributions[1]);
+    compareGridmaps(removed, copy);
+
+    map.reinsert(scans[2], corrected, contributions[2]);
+    compareGridmaps(expected, map);
+}
+
+TEST(Test_cslibs_ndt_2d, testReinsertLoopClosure)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    std::vector<cslibs_math_2d::Transform2d> corrected;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        scans.emplace_back(generateScan(NUM_BEAMS));
+        corrected.emplace_back(origin(i));
+    }
+
+    map_t map(0.5);
+    std::vector<contribution_t> contributions(NUM_SCANS);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insertRecorded(scans[i], origin(i), contributions[i]);
+
+    /// a loop closure corrects the poses of the last scans
+    for (std::size_t i = NUM_SCANS - NUM_CORRECTED ; i < NUM_SCANS ; ++ i)
+        corrected[i] = cslibs_math_2d::Transform2d(0.05, 0.05, 0.01) * origin(i);
+
+    map_t rebuilt(0.5);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        rebuilt.insertDeduplicated(scans[i], corrected[i]);
+    for (std::size_t i = NUM_SCANS - NUM_CORRECTED ; i < NUM_SCANS ; ++ i)
+        map.reinsert(scans[i], corrected[i], contributions[i]);
+
+    compare(rebuilt, map);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
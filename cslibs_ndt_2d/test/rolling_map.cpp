@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/rolling_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/rolling_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <set>
+#include <cmath>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 20;
+const std::size_t NUM_SCAN_POINTS   = 100;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using pointcloud_t = cslibs_math_2d::Pointcloud2<double>;
+
+typename pointcloud_t::ConstPtr generateScan(const cslibs_math_2d::Point2d &center)
+{
+    rng_t<1> rng_coord(-8.0, 8.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+        scan->insert(cslibs_math_2d::Point2d(center(0) + rng_coord.get(), center(1) + rng_coord.get()));
+    return scan;
+}
+
+template <typename index_t>
+bool inside(const index_t &bi, const index_t &min, const index_t &max)
+{
+    return bi[0] >= min[0] && bi[0] <= max[0] && bi[1] >= min[1] && bi[1] <= max[1];
+}
+
+TEST(Test_cslibs_ndt_2d, testRollingGridmap)
+{
+    using map_t         = cslibs_ndt_2d::rolling_maps::Gridmap<double>;
+    using index_t       = typename map_t::index_t;
+    using index_list_t  = typename map_t::index_list_t;
+
+    map_t map(cslibs_math_2d::Transform2d(), 1.0,
+              typename map_t::size_t{{10ul, 10ul}},
+              index_t{{-10, -10}});
+
+    std::set<index_t> evicted;
+    map.setEvictionCallback([&evicted](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        EXPECT_TRUE(evicted.insert(bi).second);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            EXPECT_NE(b.at(i), nullptr);
+    });
+
+    /// drive along a path, including a move further than the window
+    rng_t<1> rng_step(-4.0, 4.0);
+    cslibs_math_2d::Point2d position;
+    std::vector<index_t> windows;
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        position = cslibs_math_2d::Point2d(position(0) + rng_step.get(), position(1) + rng_step.get());
+        if (i == NUM_SCANS / 2)
+            position = cslibs_math_2d::Point2d(position(0) + 25.0, position(1));
+
+        const index_t min_before = map.getMinBundleIndex();
+        const index_t max_before = map.getMaxBundleIndex();
+        std::vector<index_t> before;
+        map.getBundleIndices(before);
+
+        evicted.clear();
+        map.moveTo(position);
+
+        /// exactly the bundles outside of the new window were evicted
+        const index_t min = map.getMinBundleIndex();
+        const index_t max = map.getMaxBundleIndex();
+        EXPECT_EQ(max[0] - min[0] + 1, 20);
+        EXPECT_EQ(max[1] - min[1] + 1, 20);
+        std::size_t leaving = 0;
+        for (const index_t &bi : before) {
+            EXPECT_TRUE(inside(bi, min_before, max_before));
+            if (!inside(bi, min, max)) {
+                ++ leaving;
+                EXPECT_EQ(evicted.count(bi), 1ul);
+            }
+        }
+        EXPECT_EQ(leaving, evicted.size());
+
+        scans.emplace_back(generateScan(position));
+        windows.emplace_back(min);
+        map.insert(scans.back());
+    }
+
+    /// a distribution holds all points inserted since it last left the window
+    auto bin_range = [](const std::size_t i, const index_t &min, const std::size_t d) {
+        index_t bmin = min, bmax = min;
+        bmax[0] += 19;
+        bmax[1] += 19;
+        return std::make_pair(cslibs_ndt::utility::generate_indices<index_list_t,2>(bmin)[i][d],
+                              cslibs_ndt::utility::generate_indices<index_list_t,2>(bmax)[i][d]);
+    };
+    auto in_range = [&bin_range](const std::size_t i, const index_t &min, const index_t &index) {
+        for (std::size_t d = 0 ; d < 2 ; ++ d) {
+            const auto r = bin_range(i, min, d);
+            if (index[d] < r.first || index[d] > r.second)
+                return false;
+        }
+        return true;
+    };
+
+    std::size_t count = 0;
+    map.traverse([&](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ count;
+        EXPECT_TRUE(inside(bi, map.getMinBundleIndex(), map.getMaxBundleIndex()));
+
+        const index_list_t indices = cslibs_ndt::utility::generate_indices<index_list_t,2>(bi);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            std::size_t first = 0;
+            for (std::size_t k = 0 ; k < windows.size() ; ++ k)
+                if (!in_range(i, windows[k], indices[i]))
+                    first = k + 1;
+
+            typename map_t::distribution_t::distribution_t expected;
+            for (std::size_t k = first ; k < scans.size() ; ++ k) {
+                for (const auto &p : *scans[k]) {
+                    index_t pi;
+                    for (std::size_t d = 0 ; d < 2 ; ++ d)
+                        pi[d] = static_cast<int>(std::floor(p(d) / map.getBundleResolution()));
+                    if (inside(pi, windows[k], index_t{{windows[k][0] + 19, windows[k][1] + 19}}) &&
+                            cslibs_ndt::utility::generate_indices<index_list_t,2>(pi)[i] == indices[i])
+                        expected.add(p);
+                }
+            }
+
+            EXPECT_EQ(expected.getN(), b.at(i)->data().getN());
+            if (expected.getN() > 0) {
+                EXPECT_NEAR(expected.getMean()(0), b.at(i)->data().getMean()(0), 1e-9);
+                EXPECT_NEAR(expected.getMean()(1), b.at(i)->data().getMean()(1), 1e-9);
+            }
+        }
+    });
+    EXPECT_GT(count, 0ul);
+
+    /// points outside of the window are dropped
+    typename pointcloud_t::Ptr outside(new pointcloud_t);
+    outside->insert(cslibs_math_2d::Point2d(position(0) + 100.0, position(1)));
+    map.insert(outside);
+    EXPECT_EQ(map.get(cslibs_math_2d::Point2d(position(0) + 100.0, position(1))), nullptr);
+}
+
+TEST(Test_cslibs_ndt_2d, testRollingOccupancyGridmap)
+{
+    using map_t   = cslibs_ndt_2d::rolling_maps::OccupancyGridmap<double>;
+    using ivm_t   = typename map_t::inverse_sensor_model_t;
+    using index_t = typename map_t::index_t;
+
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    typename map_t::Ptr map(new map_t(cslibs_math_2d::Transform2d(), 0.5,
+                                      typename map_t::size_t{{20ul, 20ul}},
+                                      index_t{{-20, -20}}));
+
+    std::size_t evicted = 0;
+    map->setEvictionCallback([&evicted](const index_t &, const typename map_t::distribution_bundle_t &) {
+        ++ evicted;
+    });
+
+    const cslibs_math_2d::Point2d position(3.0, -2.0);
+    const typename pointcloud_t::ConstPtr first  = generateScan(cslibs_math_2d::Point2d());
+    const typename pointcloud_t::ConstPtr second = generateScan(cslibs_math_2d::Point2d());
+    map->insert(first, cslibs_math_2d::Transform2d());
+    typename map_t::ConstPtr snapshot = map->snapshot();
+    std::vector<index_t> before;
+    snapshot->getBundleIndices(before);
+
+    map->moveTo(position);
+    map->insert(second, cslibs_math_2d::Transform2d(position(0), position(1), 0.0));
+    EXPECT_GT(evicted, 0ul);
+
+    /// moving under a snapshot records the removals, the result equals a move without one
+    map_t reference(cslibs_math_2d::Transform2d(), 0.5,
+                    typename map_t::size_t{{20ul, 20ul}},
+                    index_t{{-20, -20}});
+    reference.insert(first, cslibs_math_2d::Transform2d());
+    reference.moveTo(position);
+    reference.insert(second, cslibs_math_2d::Transform2d(position(0), position(1), 0.0));
+
+    auto compare = [&ivm, &reference](const map_t &map) {
+        std::vector<index_t> expected, indices;
+        reference.getBundleIndices(expected);
+        map.getBundleIndices(indices);
+        EXPECT_EQ(expected.size(), indices.size());
+        for (const index_t &bi : indices) {
+            EXPECT_TRUE(inside(bi, reference.getMinBundleIndex(), reference.getMaxBundleIndex()));
+            const typename map_t::distribution_bundle_t *b = map.get(bi);
+            const typename map_t::distribution_bundle_t *r = reference.get(bi);
+            ASSERT_NE(b, nullptr);
+            ASSERT_NE(r, nullptr);
+            for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+                EXPECT_NEAR(b->at(i)->getOccupancy(ivm), r->at(i)->getOccupancy(ivm), 1e-9);
+        }
+    };
+    compare(*map);
+
+    /// snapshots keep the old window
+    std::vector<index_t> after;
+    snapshot->getBundleIndices(after);
+    EXPECT_EQ(before.size(), after.size());
+    EXPECT_EQ(snapshot->getMinBundleIndex(), (index_t{{-20, -20}}));
+
+    map->traverse([&ivm](const index_t &, const typename map_t::distribution_bundle_t &b) {
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            const double occupancy = b.at(i)->getOccupancy(ivm);
+            EXPECT_GE(occupancy, 0.0);
+            EXPECT_LE(occupancy, 1.0);
+        }
+    });
+
+    /// without the snapshot the removals are folded into the storages
+    snapshot.reset();
+    map->insert(second, cslibs_math_2d::Transform2d(position(0), position(1), 0.0));
+    reference.insert(second, cslibs_math_2d::Transform2d(position(0), position(1), 0.0));
+    compare(*map);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
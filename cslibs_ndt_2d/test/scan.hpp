@@ -0,0 +1,42 @@
+#ifndef CSLIBS_NDT_2D_TEST_SCAN_HPP
+#define CSLIBS_NDT_2D_TEST_SCAN_HPP
+
+#include <cslibs_math_2d/linear/pointcloud.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cmath>
+#include <vector>
+
+/// angle of beam i of a 270 degree laser scan with num_beams beams
+inline double scanAngle(const std::size_t i,
+                        const std::size_t num_beams)
+{
+    return -0.75 * M_PI + 1.5 * M_PI * static_cast<double>(i) / (num_beams - 1);
+}
+
+/// ranges of a 270 degree laser scan in a wavy room, with some noise
+inline std::vector<double> generateScanRanges(const std::size_t num_beams)
+{
+    cslibs_math::random::Uniform<double, 1> rng_noise(-0.05, 0.05);
+
+    std::vector<double> ranges;
+    for (std::size_t i = 0 ; i < num_beams ; ++ i)
+        ranges.emplace_back(10.0 + 4.0 * std::sin(3.0 * scanAngle(i, num_beams)) + rng_noise.get());
+    return ranges;
+}
+
+/// 270 degree laser scan in a wavy room
+inline cslibs_math_2d::Pointcloud2<double>::Ptr generateScan(const std::size_t num_beams)
+{
+    const std::vector<double> ranges = generateScanRanges(num_beams);
+
+    cslibs_math_2d::Pointcloud2<double>::Ptr scan(new cslibs_math_2d::Pointcloud2<double>);
+    for (std::size_t i = 0 ; i < num_beams ; ++ i) {
+        const double angle = scanAngle(i, num_beams);
+        scan->insert(cslibs_math_2d::Point2d(ranges[i] * std::cos(angle), ranges[i] * std::sin(angle)));
+    }
+    return scan;
+}
+
+#endif // CSLIBS_NDT_2D_TEST_SCAN_HPP
@@ -410,6 +410,120 @@ TEST(Test_cslibs_ndt_2d, testStaticOccupancyGridmapFileBinarySerialization)
     testStaticOccMap(map, map_from_file);
 }
 
+TEST(Test_cslibs_ndt_2d, testDynamicGridmapFileBinaryYamlBundles)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+    const typename map_t::Ptr map = generateDynamicMap();
+    cslibs_ndt_2d::dynamic_maps::saveBinary<double>(map, "/tmp/dynamic_map_yaml_2d");
+    EXPECT_TRUE(boost::filesystem::exists("/tmp/dynamic_map_yaml_2d/bundles.bin"));
+
+    // layout before bundles.bin, with the bundle indices in map.yaml
+    std::vector<typename map_t::index_t> indices;
+    map->getBundleIndices(indices);
+    YAML::Node n = YAML::LoadFile("/tmp/dynamic_map_yaml_2d/map.yaml");
+    EXPECT_FALSE(n["bundles"]);
+    n["bundles"] = indices;
+    {
+        std::ofstream out("/tmp/dynamic_map_yaml_2d/map.yaml", std::fstream::trunc);
+        YAML::Emitter yaml(out);
+        yaml << n;
+    }
+    boost::filesystem::remove("/tmp/dynamic_map_yaml_2d/bundles.bin");
+
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_2d::dynamic_maps::loadBinary<double>("/tmp/dynamic_map_yaml_2d", map_from_file);
+    EXPECT_TRUE(success);
+    testDynamicMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_2d, testDynamicGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+    const typename map_t::Ptr map = generateDynamicMap();
+
+    // to file
+    cslibs_ndt_2d::dynamic_maps::saveContainer<double>(map, "/tmp/dynamic_map_2d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_2d::dynamic_maps::loadContainer<double>("/tmp/dynamic_map_2d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testDynamicMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_2d, testDynamicOccupancyGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+    const typename map_t::Ptr map = generateDynamicOccMap();
+
+    // to file
+    cslibs_ndt_2d::dynamic_maps::saveContainer<double>(map, "/tmp/dynamic_occ_map_2d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_2d::dynamic_maps::loadContainer<double>("/tmp/dynamic_occ_map_2d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testDynamicOccMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_2d, testStaticGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_2d::static_maps::Gridmap<double>;
+    const typename map_t::Ptr map = cslibs_ndt_2d::conversion::from<double>(generateDynamicMap());
+
+    // to file
+    cslibs_ndt_2d::static_maps::saveContainer<double>(map, "/tmp/static_map_2d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_2d::static_maps::loadContainer<double>("/tmp/static_map_2d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testStaticMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_2d, testStaticOccupancyGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_2d::static_maps::OccupancyGridmap<double>;
+    const typename map_t::Ptr map = cslibs_ndt_2d::conversion::from<double>(generateDynamicOccMap());
+
+    // to file
+    cslibs_ndt_2d::static_maps::saveContainer<double>(map, "/tmp/static_occ_map_2d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_2d::static_maps::loadContainer<double>("/tmp/static_occ_map_2d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testStaticOccMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_2d, testLargeContainerSerialization)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+    rng_t<1> rng_coord(-200.0, 200.0);
+    rng_t<1> rng_range(-5.0, 5.0);
+    typename map_t::Ptr map(new map_t(cslibs_math_2d::Transform2d(), 0.5));
+    for (int i = 0 ; i < 10000 ; ++ i) {
+        const cslibs_math_2d::Point2d p(rng_coord.get(), rng_coord.get());
+        map->insert(p, p + cslibs_math_2d::Point2d(rng_range.get(), rng_range.get()));
+    }
+
+    cslibs_ndt_2d::dynamic_maps::saveBinary<double>(map, "/tmp/large_occ_map_binary_2d");
+    cslibs_ndt_2d::dynamic_maps::saveContainer<double>(map, "/tmp/large_occ_map_2d.ndt");
+
+    typename map_t::Ptr from_binary, from_container;
+    EXPECT_TRUE(cslibs_ndt_2d::dynamic_maps::loadBinary<double>("/tmp/large_occ_map_binary_2d", from_binary));
+    EXPECT_TRUE(cslibs_ndt_2d::dynamic_maps::loadContainer<double>("/tmp/large_occ_map_2d.ndt", from_container));
+    testDynamicOccMap(from_binary, from_container);
+}
+
 int main(int argc, char *argv[])
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/static_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 20;
+const std::size_t NUM_SCAN_POINTS   = 50;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using pointcloud_t = cslibs_math_2d::Pointcloud2<double>;
+
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(cslibs_math_2d::Point2d(rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+template <typename map_t>
+void testEqual(const map_t &map, const map_t &reference)
+{
+    std::size_t bundles = 0;
+    reference.traverse([&map, &bundles](const typename map_t::index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *bm = map.get(bi);
+        ASSERT_NE(bm, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(),     bm->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), bm->at(i)->numOccupied());
+            if (b.at(i)->getDistribution() && bm->at(i)->getDistribution()) {
+                EXPECT_NEAR(b.at(i)->getDistribution()->getMean()(0), bm->at(i)->getDistribution()->getMean()(0), 1e-9);
+                EXPECT_NEAR(b.at(i)->getDistribution()->getMean()(1), bm->at(i)->getDistribution()->getMean()(1), 1e-9);
+            }
+        }
+    });
+
+    std::vector<typename map_t::index_t> indices;
+    map.getBundleIndices(indices);
+    EXPECT_EQ(bundles, indices.size());
+
+    EXPECT_EQ(map.getMinBundleIndex(), reference.getMinBundleIndex());
+    EXPECT_EQ(map.getMaxBundleIndex(), reference.getMaxBundleIndex());
+}
+
+template <typename map_t, typename... args_t>
+void testSnapshots(const args_t&... args)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const cslibs_math_2d::Transform2d origin(1.0, 0.0, 0.0);
+
+    typename map_t::Ptr map(new map_t(args...));
+    const typename map_t::distribution_storage_t *base = map->getStorages()[0].get();
+    std::vector<typename map_t::ConstPtr> snapshots;
+    std::vector<typename map_t::Ptr> references;
+
+    typename map_t::Ptr reference(new map_t(args...));
+    for (std::size_t i = 0 ; i < scans.size() ; ++ i) {
+        map->insert(scans[i], origin);
+        reference->insert(scans[i], origin);
+
+        /// keep every other snapshot, dropped ones get folded back
+        const typename map_t::ConstPtr snapshot = map->snapshot();
+        if (i % 2 == 0) {
+            snapshots.emplace_back(snapshot);
+            references.emplace_back(new map_t(*reference));
+        }
+    }
+
+    testEqual(*map, *reference);
+    for (std::size_t i = 0 ; i < snapshots.size() ; ++ i)
+        testEqual(*snapshots[i], *references[i]);
+
+    /// copies and storages merge pending changes
+    const map_t copy(*map);
+    testEqual(copy, *reference);
+    const typename map_t::distribution_storage_array_t storages = map->getStorages();
+    for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+        std::size_t count = 0, count_reference = 0;
+        storages[i]->traverse([&count](const typename map_t::index_t &, const typename map_t::distribution_t &) { ++ count; });
+        reference->getStorages()[i]->traverse([&count_reference](const typename map_t::index_t &, const typename map_t::distribution_t &) { ++ count_reference; });
+        EXPECT_EQ(count, count_reference);
+    }
+
+    /// once all snapshots are gone everything is folded back into the base storages
+    snapshots.clear();
+    map->insert(scans.front(), origin);
+    reference->insert(scans.front(), origin);
+    EXPECT_EQ(map->getStorages()[0].get(), base);
+    testEqual(*map, *reference);
+}
+
+TEST(Test_cslibs_ndt_2d, testDynamicOccupancyGridmapSnapshot)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+    testSnapshots<map_t>(cslibs_math_2d::Transform2d(), 0.5);
+}
+
+TEST(Test_cslibs_ndt_2d, testStaticOccupancyGridmapSnapshot)
+{
+    using map_t = cslibs_ndt_2d::static_maps::OccupancyGridmap<double>;
+    testSnapshots<map_t>(cslibs_math_2d::Transform2d(), 0.5,
+                         typename map_t::size_t{{60ul, 60ul}},
+                         typename map_t::index_t{{-60, -60}});
+}
+
+TEST(Test_cslibs_ndt_2d, testSnapshotBackgroundReader)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    typename map_t::Ptr map(new map_t(0.5));
+    map->insert(scans.front());
+    const typename map_t::ConstPtr snapshot = map->snapshot();
+    const map_t reference(*map);
+
+    /// the snapshot is read in the background while mapping continues
+    std::size_t mismatches = 0;
+    std::thread reader([&snapshot, &reference, &mismatches]() {
+        for (std::size_t n = 0 ; n < 10 ; ++ n) {
+            reference.traverse([&snapshot, &mismatches](const typename map_t::index_t &bi, const typename map_t::distribution_bundle_t &b) {
+                const typename map_t::distribution_bundle_t *bs = snapshot->get(bi);
+                if (!bs || bs->at(0)->data().getN() != b.at(0)->data().getN())
+                    ++ mismatches;
+            });
+        }
+    });
+    for (const auto &scan : scans)
+        map->insert(scan);
+    reader.join();
+
+    EXPECT_EQ(mismatches, 0ul);
+}
+
+TEST(Test_cslibs_ndt_2d, testSnapshotConcurrentSample)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    typename map_t::Ptr map(new map_t(0.5));
+    for (const auto &scan : scans)
+        map->insert(scan);
+    const map_t reference(*map);
+    const typename map_t::ConstPtr snapshot = map->snapshot();
+
+    std::vector<double> expected;
+    for (const auto &scan : scans)
+        for (const auto &p : *scan)
+            expected.emplace_back(reference.sample(p));
+
+    /// the snapshot shares the distributions of the live map, sampling both
+    /// from different threads must not race on the cached statistics
+    std::size_t mismatches = 0;
+    std::thread reader([&snapshot, &scans, &expected, &mismatches]() {
+        for (std::size_t n = 0 ; n < 10 ; ++ n) {
+            std::size_t i = 0;
+            for (const auto &scan : scans)
+                for (const auto &p : *scan)
+                    if (std::abs(snapshot->sample(p) - expected[i++]) > 1e-9)
+                        ++ mismatches;
+        }
+    });
+    for (std::size_t n = 0 ; n < 10 ; ++ n) {
+        std::size_t i = 0;
+        for (const auto &scan : scans)
+            for (const auto &p : *scan)
+                EXPECT_NEAR(map->sample(p), expected[i++], 1e-9);
+    }
+    reader.join();
+
+    EXPECT_EQ(mismatches, 0ul);
+}
+
+TEST(Test_cslibs_ndt_2d, testMoveIsShallow)
+{
+    using map_t = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+
+    map_t map(0.5);
+    map.insert(scans.front());
+    const typename map_t::distribution_storage_t *storage = map.getStorages()[0].get();
+
+    const map_t moved(std::move(map));
+    EXPECT_EQ(moved.getStorages()[0].get(), storage);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
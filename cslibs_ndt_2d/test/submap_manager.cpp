@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt/map/submap_manager.hpp>
+
+#include "scan.hpp"
+
+#include <map>
+#include <set>
+
+const std::size_t NUM_BEAMS     = 360;
+const std::size_t NUM_SCANS     = 60;
+const std::size_t NUM_PER_MAP   = 10;
+
+using gridmap_t         = cslibs_ndt_2d::dynamic_maps::Gridmap<double>;
+using occupancy_map_t   = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t           = typename gridmap_t::index_t;
+using pointcloud_t      = typename gridmap_t::pointcloud_t;
+using point_t           = typename gridmap_t::point_t;
+using transform_t       = cslibs_math_2d::Transform2d;
+using ivm_t             = typename occupancy_map_t::inverse_sensor_model_t;
+
+/// anchors on the grid of a resolution of 1, which moves distributions without re-binning
+transform_t origin(const std::size_t i)
+{
+    return transform_t(static_cast<double>(i % 7), -static_cast<double>(i % 5), 0.0);
+}
+
+template <typename map_t, typename compare_t>
+void compareMaps(const map_t &expected, const map_t &map, const compare_t &compare)
+{
+    std::size_t bundles = 0;
+    expected.traverse([&map, &bundles, &compare](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename map_t::distribution_bundle_t *mb = map.get(bi);
+        ASSERT_NE(mb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            compare(*b.at(i), *mb->at(i));
+    });
+    map.traverse([&bundles](const index_t &, const typename map_t::distribution_bundle_t &) {
+        -- bundles;
+    });
+    EXPECT_EQ(0ul, bundles);
+}
+
+void compareDistributions(const typename gridmap_t::distribution_t &a, const typename gridmap_t::distribution_t &b)
+{
+    ASSERT_EQ(a.data().getN(), b.data().getN());
+    for (std::size_t j = 0 ; j < 2 ; ++ j)
+        EXPECT_NEAR(a.data().getMean()(j), b.data().getMean()(j), 1e-6);
+    EXPECT_NEAR(0.0, (a.data().getCorrelated() - b.data().getCorrelated()).norm(), 1e-6);
+}
+
+/// re-anchoring subtracts stale layers, bundles only they covered are left allocated,
+/// so only the distributions holding samples have to match
+void compareSamples(const gridmap_t &expected, const gridmap_t &map)
+{
+    using distribution_t = typename gridmap_t::distribution_t;
+    for (std::size_t i = 0 ; i < gridmap_t::bin_count ; ++ i) {
+        std::map<index_t, const distribution_t*> distributions;
+        map.traverseDistributions(i, [&distributions](const index_t &index, const distribution_t &d) {
+            if (d.data().getN() > 0)
+                distributions[index] = &d;
+        });
+        expected.traverseDistributions(i, [&distributions](const index_t &index, const distribution_t &d) {
+            if (d.data().getN() == 0)
+                return;
+            const auto it = distributions.find(index);
+            ASSERT_TRUE(it != distributions.end());
+            compareDistributions(d, *it->second);
+            distributions.erase(it);
+        });
+        EXPECT_TRUE(distributions.empty());
+    }
+}
+
+/// number of samples in the first bin storage, each distribution once
+std::size_t samples(const gridmap_t &map)
+{
+    std::set<const typename gridmap_t::distribution_t*> distributions;
+    map.traverse([&distributions](const index_t &, const typename gridmap_t::distribution_bundle_t &b) {
+        distributions.insert(b.at(0));
+    });
+    std::size_t n = 0;
+    for (const typename gridmap_t::distribution_t *d : distributions)
+        n += d->data().getN();
+    return n;
+}
+
+TEST(Test_cslibs_ndt_2d, testInsertMap)
+{
+    const typename pointcloud_t::Ptr scan = generateScan(NUM_BEAMS);
+
+    /// an identical grid gives an identical map
+    gridmap_t map(1.0), copy(1.0);
+    map.insert(scan, transform_t(0.3, 0.2, 0.1));
+    copy.insert(map);
+    compareMaps(map, copy, compareDistributions);
+
+    /// removing it again leaves the bundles without samples
+    copy.remove(map);
+    EXPECT_EQ(0ul, samples(copy));
+
+    /// moving by whole cells only moves the distributions
+    const transform_t shift(3.0, -2.0, 0.0);
+    gridmap_t shifted(1.0), moved(1.0);
+    shifted.insert(scan, shift * transform_t(0.3, 0.2, 0.1));
+    moved.insert(map, shift);
+    compareMaps(shifted, moved, compareDistributions);
+
+    /// a rotated map keeps all samples
+    gridmap_t rotated(1.0);
+    rotated.insert(map, transform_t(0.5, 0.5, 0.7));
+    EXPECT_EQ(samples(map), samples(rotated));
+}
+
+TEST(Test_cslibs_ndt_2d, testSubmapManager)
+{
+    std::vector<typename pointcloud_t::Ptr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        scans.emplace_back(generateScan(NUM_BEAMS));
+
+    cslibs_ndt::map::SubmapManager<gridmap_t> submaps(1.0, NUM_PER_MAP);
+    gridmap_t expected(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        EXPECT_EQ(i / NUM_PER_MAP, submaps.insert(scans[i], origin(i)));
+        expected.insert(scans[i], origin(i));
+    }
+    EXPECT_EQ(NUM_SCANS / NUM_PER_MAP, submaps.size());
+    EXPECT_EQ(origin(NUM_PER_MAP).tx(), submaps.getAnchor(1).tx());
+    compareMaps(expected, *submaps.getMap(), compareDistributions);
+    EXPECT_EQ(submaps.getMap(), submaps.getMap());
+
+    /// pose graph correction of two submaps, the map follows their anchors
+    const transform_t correction(2.0, 1.0, 0.0);
+    for (const std::size_t id : {1ul, NUM_SCANS / NUM_PER_MAP - 1})
+        submaps.setAnchor(id, correction * submaps.getAnchor(id));
+    gridmap_t corrected(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        const std::size_t id = i / NUM_PER_MAP;
+        corrected.insert(scans[i], (id == 1 || id == NUM_SCANS / NUM_PER_MAP - 1) ? correction * origin(i) : origin(i));
+    }
+    compareSamples(corrected, *submaps.getMap());
+
+    const point_t p = expected.getMax() * 0.5 + expected.getMin() * 0.5;
+    EXPECT_NEAR(corrected.sample(p), submaps.sample(p), 1e-9);
+
+    /// re-anchoring twice before the next request subtracts the layer once
+    submaps.setAnchor(1, transform_t(1.0, 0.0, 0.0) * submaps.getAnchor(1));
+    submaps.setAnchor(1, correction.inverse() * transform_t(-1.0, 0.0, 0.0) * submaps.getAnchor(1));
+    gridmap_t restored(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        restored.insert(scans[i], i / NUM_PER_MAP == NUM_SCANS / NUM_PER_MAP - 1 ? correction * origin(i) : origin(i));
+    compareSamples(restored, *submaps.getMap());
+}
+
+TEST(Test_cslibs_ndt_2d, testOccupancySubmapManager)
+{
+    const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+    cslibs_ndt::map::SubmapManager<occupancy_map_t> submaps(1.0, 2);
+    occupancy_map_t expected(1.0);
+    for (std::size_t i = 0 ; i < 5 ; ++ i) {
+        const typename pointcloud_t::Ptr scan = generateScan(NUM_BEAMS);
+        submaps.insert(scan, origin(i));
+        expected.insert(scan, origin(i));
+    }
+
+    compareMaps(expected, *submaps.getMap(), [](const typename occupancy_map_t::distribution_t &a,
+                                                 const typename occupancy_map_t::distribution_t &b) {
+        EXPECT_EQ(a.numFree(), b.numFree());
+        EXPECT_EQ(a.numOccupied(), b.numOccupied());
+    });
+    for (std::size_t i = 0 ; i < 100 ; ++ i) {
+        const point_t p(-5.0 + 0.1 * i, 2.0 - 0.03 * i);
+        EXPECT_NEAR(expected.sample(p, ivm), submaps.sample(p, ivm), 1e-9);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
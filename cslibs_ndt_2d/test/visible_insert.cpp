@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_2d/dynamic_maps/occupancy_gridmap.hpp>
+#include <cslibs_ndt_2d/dynamic_maps/weighted_occupancy_gridmap.hpp>
+
+#include "scan.hpp"
+
+#include <set>
+
+const std::size_t NUM_BEAMS = 1080;
+
+using map_t         = cslibs_ndt_2d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using ivm_t         = typename map_t::inverse_sensor_model_t;
+
+const typename ivm_t::Ptr ivm(new ivm_t(0.5, 0.45, 0.65));
+/// rays die after a few steps through unknown space, but pass known free space
+const typename ivm_t::Ptr ivm_visibility(new ivm_t(0.1, 0.1, 1.0));
+
+template <typename occupancy_map_t>
+std::set<index_t> bundles(const occupancy_map_t &map)
+{
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    return std::set<index_t>(indices.begin(), indices.end());
+}
+
+using weighted_map_t = cslibs_ndt_2d::dynamic_maps::WeightedOccupancyGridmap<double>;
+
+/// the weighted map takes the origin first
+void insertVisible(map_t &map, const typename pointcloud_t::Ptr &scan, const cslibs_math_2d::Transform2d &origin)
+{
+    map.insertVisible(scan, origin, ivm, ivm_visibility);
+}
+
+void insertVisible(weighted_map_t &map, const typename pointcloud_t::Ptr &scan, const cslibs_math_2d::Transform2d &origin)
+{
+    map.insertVisible(origin, scan, ivm, ivm_visibility);
+}
+
+template <typename occupancy_map_t>
+void testVisibleInsert()
+{
+    const cslibs_math_2d::Transform2d known(0.0, 0.0, 0.0);
+    const cslibs_math_2d::Transform2d origin(1.0, 0.5, 0.8);
+    const typename pointcloud_t::Ptr scan = generateScan(NUM_BEAMS);
+    const std::vector<point_t> points(scan->begin(), scan->end());
+    const typename pointcloud_t::Ptr reversed(new pointcloud_t);
+    for (auto it = points.rbegin() ; it != points.rend() ; ++ it)
+        reversed->insert(*it);
+
+    /// the same known map, then one scan from a shifted origin
+    occupancy_map_t insert_map(0.5), visible_map(0.5), reversed_map(0.5);
+    for (occupancy_map_t *map : {&insert_map, &visible_map, &reversed_map})
+        map->insert(scan, known);
+    const std::set<index_t> known_bundles = bundles(visible_map);
+
+    insert_map.insert(scan, origin);
+    insertVisible(visible_map, scan, origin);
+    insertVisible(reversed_map, reversed, origin);
+
+    /// only bundles on the rays are allocated, no occlusion neighbours
+    const std::set<index_t> insert_bundles  = bundles(insert_map);
+    const std::set<index_t> visible_bundles = bundles(visible_map);
+    for (const index_t &bi : visible_bundles)
+        EXPECT_EQ(1ul, insert_bundles.count(bi));
+    EXPECT_GT(visible_bundles.size(), known_bundles.size());
+    EXPECT_LT(visible_bundles.size(), insert_bundles.size());
+
+    /// the scan is evaluated against the map before it, independent of the ray order
+    EXPECT_EQ(visible_bundles, bundles(reversed_map));
+    visible_map.traverse([&reversed_map](const index_t &bi, const typename occupancy_map_t::distribution_bundle_t &b) {
+        const typename occupancy_map_t::distribution_bundle_t *rb = reversed_map.get(bi);
+        ASSERT_NE(rb, nullptr);
+        for (std::size_t i = 0 ; i < occupancy_map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(), rb->at(i)->numFree());
+            EXPECT_NEAR(b.at(i)->getOccupancy(ivm), rb->at(i)->getOccupancy(ivm), 1e-9);
+        }
+    });
+}
+
+TEST(Test_cslibs_ndt_2d, testVisibleInsert)
+{
+    testVisibleInsert<map_t>();
+    testVisibleInsert<weighted_map_t>();
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 1000;
+const std::size_t NUM_PROBES        = 100000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using static_map_t  = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+typename pointcloud_t::ConstPtr generateScan()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+        scan->insert(point_t(rng_coord.get(), rng_coord.get(), rng_coord.get()));
+    return scan;
+}
+
+/// a map without bundle storage has to derive each bundle from its distributions
+template <typename m_t>
+std::array<const typename m_t::distribution_t*, m_t::bin_count> findDistributions(const typename m_t::distribution_storage_array_t &storages,
+                                                                                  const index_t &bi)
+{
+    const typename m_t::index_list_t indices = cslibs_ndt::utility::generate_indices<typename m_t::index_list_t, 3>(bi);
+    std::array<const typename m_t::distribution_t*, m_t::bin_count> distributions;
+    for (std::size_t i = 0 ; i < m_t::bin_count ; ++ i)
+        distributions[i] = storages[i]->get(indices[i]);
+    return distributions;
+}
+
+/// what the bundle storage costs in memory and what deriving bundles costs per lookup
+template <typename m_t>
+void measureBundleStorage(const std::string &name, m_t &map)
+{
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insert(generateScan());
+
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    std::size_t distribution_bytes = 0;
+    for (const auto &storage : map.getStorages())
+        distribution_bytes += storage->byte_size();
+    const std::size_t bundle_bytes = map.getByteSize() - sizeof(map) - distribution_bytes;
+
+    rng_t<1> rng_index(0.0, static_cast<double>(indices.size()));
+    std::vector<index_t> probes;
+    for (std::size_t i = 0 ; i < NUM_PROBES ; ++ i)
+        probes.emplace_back(indices[static_cast<std::size_t>(rng_index.get()) % indices.size()]);
+
+    std::size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const index_t &bi : probes)
+        found += map.get(bi) ? 1ul : 0ul;
+    const double bundle_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_PROBES;
+
+    const typename m_t::distribution_storage_array_t storages = map.getStorages();
+    start = std::chrono::steady_clock::now();
+    for (const index_t &bi : probes)
+        found += findDistributions<m_t>(storages, bi)[0] ? 1ul : 0ul;
+    const double derived_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / NUM_PROBES;
+
+    std::cout << "[BundleStorage]: " << name << ", " << indices.size() << " bundles, "
+              << "bundle storage " << bundle_bytes << " bytes (" << bundle_bytes / indices.size() << " per bundle, "
+              << 100.0 * bundle_bytes / (bundle_bytes + distribution_bytes) << "% of the map), "
+              << "distribution storages " << distribution_bytes << " bytes, "
+              << "stored bundle " << bundle_ns << "ns/lookup, "
+              << "derived bundle " << derived_ns << "ns/lookup, "
+              << found << " found" << std::endl;
+}
+
+/// stored against derived bundles on the kdtree and the array backed map
+int main()
+{
+    map_t map(1.0);
+    measureBundleStorage("kdtree", map);
+
+    static_map_t static_map(cslibs_math_3d::Transform3d(), 1.0,
+                            typename static_map_t::size_t{{44ul, 44ul, 44ul}},
+                            index_t{{-22, -22, -22}});
+    measureBundleStorage("array", static_map);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_SCANS         = 5;
+const std::size_t NUM_SCAN_POINTS   = 20000;
+const std::size_t NUM_THREADS       = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+/// dense scan of a shell around the sensor, rays overlap close to the sensor
+typename pointcloud_t::ConstPtr generateScan()
+{
+    rng_t<1> rng_direction(-1.0, 1.0);
+    rng_t<1> rng_range(8.0, 10.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j) {
+        const point_t d(rng_direction.get(), rng_direction.get(), rng_direction.get());
+        scan->insert(d * (rng_range.get() / d.length()));
+    }
+    return scan;
+}
+
+/// per-ray insertion against deduplicated insertion, serial and on a pool
+int main()
+{
+    map_t map(0.5), deduplicated(0.5), parallel(0.5);
+    const cslibs_math_3d::Transform3d origin(cslibs_math_3d::Vector3d(0.5, -1.0, 0.25),
+                                             cslibs_math_3d::Quaternion<double>(0.1, 0.0, 0.3));
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    double insert_ms = 0.0, deduplicated_ms = 0.0, parallel_ms = 0.0;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        const typename pointcloud_t::ConstPtr scan = generateScan();
+
+        auto start = std::chrono::steady_clock::now();
+        map.insert(scan, origin);
+        insert_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        deduplicated.insertDeduplicated(scan, origin);
+        deduplicated_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        parallel.insertDeduplicated(scan, origin, &pool);
+        parallel_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<index_t> indices;
+    map.getBundleIndices(indices);
+    std::cout << "[DeduplicatedInsert]: " << indices.size() << " bundles, "
+              << "insert " << insert_ms / NUM_SCANS << "ms/scan, "
+              << "deduplicated " << deduplicated_ms / NUM_SCANS << "ms/scan, "
+              << NUM_THREADS << " threads " << parallel_ms / NUM_SCANS << "ms/scan" << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt/backend/morton.hpp>
+#include <cslibs_ndt/conversion/map.hpp>
+#include <cslibs_ndt/serialization/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 2000;
+const std::size_t NUM_RUNS          = 3;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using array_map_t   = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using morton_map_t  = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::Morton>;
+using kdtree_map_t  = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using index_t       = typename morton_map_t::index_t;
+using pointcloud_t  = typename morton_map_t::pointcloud_t;
+using point_t       = typename morton_map_t::point_t;
+
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-20.0, 20.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_coord.get(), rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+template <typename Fn>
+double measure(const Fn &function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0 ; i < NUM_RUNS ; ++ i)
+        function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / NUM_RUNS;
+}
+
+/// conversion, serialization and neighbour traversal of the array against the Morton backend
+int main()
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    typename kdtree_map_t::Ptr kdtree_map(new kdtree_map_t(1.0));
+    for (const auto &scan : scans)
+        kdtree_map->insert(scan);
+
+    using to_array_t    = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::static_map,cslibs_ndt::map::tags::dynamic_map,
+                                                          3,cslibs_ndt::Distribution,double>;
+    using to_morton_t   = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::static_map,cslibs_ndt::map::tags::dynamic_map,
+                                                          3,cslibs_ndt::Distribution,double,cslibs_ndt::backend::Morton>;
+    using from_array_t  = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::dynamic_map,cslibs_ndt::map::tags::static_map,
+                                                          3,cslibs_ndt::Distribution,double>;
+    using from_morton_t = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::dynamic_map,cslibs_ndt::map::tags::static_map,
+                                                          3,cslibs_ndt::Distribution,double,
+                                                          cslibs_ndt::map::tags::default_types<cslibs_ndt::map::tags::dynamic_map>::default_backend_t,
+                                                          cslibs_ndt::map::tags::default_types<cslibs_ndt::map::tags::dynamic_map>::default_dynamic_backend_t,
+                                                          cslibs_ndt::backend::Morton>;
+
+    typename array_map_t::Ptr  array_map;
+    typename morton_map_t::Ptr morton_map;
+    const double to_array_ms  = measure([&]() { array_map  = to_array_t::from(kdtree_map); });
+    const double to_morton_ms = measure([&]() { morton_map = to_morton_t::from(kdtree_map); });
+    const double from_array_ms  = measure([&]() { from_array_t::from(array_map); });
+    const double from_morton_ms = measure([&]() { from_morton_t::from(morton_map); });
+
+    std::vector<index_t> array_indices;
+    array_map->getBundleIndices(array_indices);
+
+    const double save_array_ms  = measure([&]() {
+        cslibs_ndt::serialization::saveBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double>(
+                    array_map, "/tmp/array_map_binary_3d");
+    });
+    const double save_morton_ms = measure([&]() {
+        cslibs_ndt::serialization::saveBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                              cslibs_ndt::backend::Morton>(morton_map, "/tmp/morton_map_binary_3d");
+    });
+
+    typename array_map_t::Ptr  array_loaded;
+    typename morton_map_t::Ptr morton_loaded;
+    const double load_array_ms  = measure([&]() {
+        cslibs_ndt::serialization::loadBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double>(
+                    "/tmp/array_map_binary_3d", array_loaded);
+    });
+    const double load_morton_ms = measure([&]() {
+        cslibs_ndt::serialization::loadBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                              cslibs_ndt::backend::Morton>("/tmp/morton_map_binary_3d", morton_loaded);
+    });
+
+    /// neighbour access as in D2D matching, in storage order and in Morton order
+    auto neighbours = [&kdtree_map](const index_t &bi, const typename kdtree_map_t::distribution_bundle_t &) {
+        kdtree_map->get(index_t{{bi[0] + 1, bi[1], bi[2]}});
+    };
+    const double traverse_ms        = measure([&]() { kdtree_map->traverse(neighbours); });
+    const double traverse_morton_ms = measure([&]() { kdtree_map->traverseMorton(neighbours); });
+
+    std::cout << "[Morton]: " << array_indices.size() << " bundles, "
+              << "to static array " << to_array_ms << "ms / Morton " << to_morton_ms << "ms, "
+              << "from static array " << from_array_ms << "ms / Morton " << from_morton_ms << "ms, "
+              << "save array " << save_array_ms << "ms / Morton " << save_morton_ms << "ms, "
+              << "load array " << load_array_ms << "ms / Morton " << load_morton_ms << "ms, "
+              << "kdtree neighbours traverse " << traverse_ms << "ms / traverseMorton " << traverse_morton_ms << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt/backend/paged.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 1000;
+const std::size_t NUM_PROBES        = 100000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using array_map_t   = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using paged_map_t   = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::Paged>;
+using kdtree_map_t  = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using index_t       = typename paged_map_t::index_t;
+using pointcloud_t  = typename paged_map_t::pointcloud_t;
+using point_t       = typename paged_map_t::point_t;
+
+/// a thin corridor through a large extent, as in a long drive
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_x(-90.0, 90.0);
+    rng_t<1> rng_y(-4.0, 4.0);
+    rng_t<1> rng_z(0.0, 3.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_x.get(), rng_y.get(), rng_z.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+template <typename map_t>
+double lookup(const map_t &map, const std::vector<point_t> &probes, double &sum)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (const point_t &p : probes) {
+        const double v = map.sample(p);
+        sum += std::isnormal(v) ? v : 0.0;
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / probes.size();
+}
+
+/// memory and sampling cost of the array, paged and kdtree backends on a sparse extent
+int main()
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const typename paged_map_t::size_t size{{200ul, 200ul, 10ul}};
+    const index_t min_index{{-200, -200, -4}};
+
+    array_map_t  array_map(cslibs_math_3d::Transform3d(), 1.0, size, min_index);
+    paged_map_t  paged_map(cslibs_math_3d::Transform3d(), 1.0, size, min_index);
+    kdtree_map_t kdtree_map(1.0);
+    for (const auto &scan : scans) {
+        array_map.insert(scan);
+        paged_map.insert(scan);
+        kdtree_map.insert(scan);
+    }
+
+    rng_t<1> rng_x(-90.0, 90.0);
+    rng_t<1> rng_y(-4.0, 4.0);
+    rng_t<1> rng_z(0.0, 3.0);
+    std::vector<point_t> probes;
+    for (std::size_t i = 0 ; i < NUM_PROBES ; ++ i)
+        probes.emplace_back(rng_x.get(), rng_y.get(), rng_z.get());
+
+    double sum = 0.0;
+    const double array_ns  = lookup(array_map,  probes, sum);
+    const double paged_ns  = lookup(paged_map,  probes, sum);
+    const double kdtree_ns = lookup(kdtree_map, probes, sum);
+
+    std::vector<index_t> indices;
+    paged_map.getBundleIndices(indices);
+    std::cout << "[PagedStorage]: " << indices.size() << " bundles, "
+              << "array "  << array_map.getByteSize()  << " bytes " << array_ns  << "ns/sample, "
+              << "paged "  << paged_map.getByteSize()  << " bytes " << paged_ns  << "ns/sample, "
+              << "kdtree " << kdtree_map.getByteSize() << " bytes " << kdtree_ns << "ns/sample, "
+              << "checksum " << sum << std::endl;
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <chrono>
+#include <iostream>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 1000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+
+typename pointcloud_t::ConstPtr generateScan()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+        scan->insert(point_t(rng_coord.get(), rng_coord.get(), rng_coord.get()));
+    return scan;
+}
+
+/// range query against filtering a full traversal
+int main()
+{
+    map_t map(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insert(generateScan());
+
+    std::size_t visited = 0;
+    auto start = std::chrono::steady_clock::now();
+    map.traverse([&visited](const index_t &bi, const typename map_t::distribution_bundle_t &) {
+        /// bundle centers in [-4, 4] with a bundle resolution of 0.5
+        visited += (bi[0] >= -8 && bi[0] <= 7 && bi[1] >= -8 && bi[1] <= 7 && bi[2] >= -8 && bi[2] <= 7) ? 1ul : 0ul;
+    });
+    const double filter_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t queried = 0;
+    start = std::chrono::steady_clock::now();
+    map.traverseRange(point_t(-4.0, -4.0, -4.0), point_t(4.0, 4.0, 4.0),
+                      [&queried](const index_t &, const typename map_t::distribution_bundle_t &) { ++ queried; });
+    const double range_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[RangeQuery]: " << queried << " of " << visited << " bundles, "
+              << "filtered traversal " << filter_us << "us, "
+              << "range query " << range_us << "us" << std::endl;
+    return 0;
+}
@@ -10,7 +10,7 @@ namespace cslibs_ndt_3d {
 namespace conversion {
 template <typename T>
 inline Distribution from(const cslibs_math::statistics::Distribution<T, 3, 3> &d,
-                         const int &id,
+                         const uint64_t &id,
                          const T &prob)
 {
     Distribution distr;
@@ -30,11 +30,13 @@ inline Distribution from(const cslibs_math::statistics::Distribution<T, 3, 3> &d
 template <typename T>
 inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::Gridmap<T>::Ptr &src,
-        cslibs_ndt_3d::DistributionArray::Ptr &dst)
+        cslibs_ndt_3d::DistributionArray::Ptr &dst,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_3d::dynamic_maps::Gridmap<T>;
     using dst_map_t = cslibs_ndt_3d::DistributionArray;
@@ -60,17 +62,21 @@ inline void from(
     };
 
     using index_t = std::array<int, 3>;
-    auto process_bundle = [&dst, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
+    cslibs_ndt::utility::ThreadLocal<std::vector<Distribution>> distributions(pool);
+    auto process_bundle = [&distributions, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
         typename distribution_t::distribution_t d;
         for (std::size_t i = 0; i < 8; ++ i)
             d += b.at(i)->data();
         if (d.getN() == 0)
             return;
 
-        dst->data.emplace_back(from(d, b.id(), sample_bundle(b, point_t(d.getMean()))));
+        distributions.local().emplace_back(from(d, cslibs_ndt::utility::bundle_id<3>(bi), sample_bundle(b, point_t(d.getMean()))));
     };
 
-    src->traverse(process_bundle);
+    src->traverse(process_bundle, pool);
+    distributions.traverse([&dst](const std::vector<Distribution> &d) {
+        dst->data.insert(dst->data.end(), d.begin(), d.end());
+    });
 }
 
 template <typename T>
@@ -78,11 +84,13 @@ inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<T>::Ptr &src,
         cslibs_ndt_3d::DistributionArray::Ptr &dst,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
-    src->allocatePartiallyAllocatedBundles();
+    src->allocatePartiallyAllocatedBundles(pool);
+    src->finalize();
 
     using src_map_t = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<T>;
     using dst_map_t = cslibs_ndt_3d::DistributionArray;
@@ -113,7 +121,8 @@ inline void from(
     };    
 
     using index_t = std::array<int, 3>;
-    auto process_bundle = [&dst, &ivm, &threshold, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
+    cslibs_ndt::utility::ThreadLocal<std::vector<Distribution>> distributions(pool);
+    auto process_bundle = [&distributions, &ivm, &threshold, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
         typename distribution_t::distribution_t d;
         T occupancy = 0.0;
 
@@ -126,9 +135,12 @@ inline void from(
         if (d.getN() == 0 || occupancy < threshold)
             return;
 
-        dst->data.emplace_back(from(d, b.id(), sample_bundle(b, point_t(d.getMean()))));
+        distributions.local().emplace_back(from(d, cslibs_ndt::utility::bundle_id<3>(bi), sample_bundle(b, point_t(d.getMean()))));
     };
-    src->traverse(process_bundle);
+    src->traverse(process_bundle, pool);
+    distributions.traverse([&dst](const std::vector<Distribution> &d) {
+        dst->data.insert(dst->data.end(), d.begin(), d.end());
+    });
 }
 }
 }
@@ -46,9 +46,11 @@ template<typename T,
                                             || std::is_same<ndt_t, cslibs_ndt_3d::static_maps::Gridmap<T>>::value>::type>
 inline void from(
         ndt_t &src,
-        sensor_msgs::PointCloud2 &dst)
+        sensor_msgs::PointCloud2 &dst,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
-    src.allocatePartiallyAllocatedBundles();
+    src.allocatePartiallyAllocatedBundles(pool);
+    src.finalize();
 
     using index_t = std::array<int, 3>;
     using point_t = typename ndt_t::point_t;
@@ -70,8 +72,8 @@ inline void from(
                         sample(b.at(7), p));
     };
 
-    std::vector<float> tmp;
-    auto process_bundle = [&src, &tmp, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
+    cslibs_ndt::utility::ThreadLocal<std::vector<float>> tmp_local(pool);
+    auto process_bundle = [&tmp_local, &sample_bundle](const index_t &, const distribution_bundle_t &b) {
         cslibs_math::statistics::Distribution<T, 3, 3> d;
         for (std::size_t i = 0 ; i < 8 ; ++i)
             d += b.at(i)->data();
@@ -79,24 +81,31 @@ inline void from(
             return;
 
         cslibs_math_3d::Point3<T> mean(d.getMean());
+        std::vector<float> &tmp = tmp_local.local();
         tmp.emplace_back(static_cast<float>(mean(0)));
         tmp.emplace_back(static_cast<float>(mean(1)));
         tmp.emplace_back(static_cast<float>(mean(2)));
         tmp.emplace_back(static_cast<float>(sample_bundle(b, mean)));
     };
-    src.traverse(process_bundle);
+    src.traverse(process_bundle, pool);
+
+    std::vector<float> tmp;
+    tmp_local.traverse([&tmp](const std::vector<float> &t) {
+        tmp.insert(tmp.end(), t.begin(), t.end());
+    });
     from(tmp, dst);
 }
 
 template <typename T>
 inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::Gridmap<T>::Ptr &src,
-        sensor_msgs::PointCloud2 &dst)
+        sensor_msgs::PointCloud2 &dst,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
 
-    from<T>(*src, dst);
+    from<T>(*src, dst, pool);
 }
 
 template<typename T,
@@ -107,9 +116,11 @@ inline void from(
         ndt_t &src,
         sensor_msgs::PointCloud2 &dst,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
-    src.allocatePartiallyAllocatedBundles();
+    src.allocatePartiallyAllocatedBundles(pool);
+    src.finalize();
 
     using index_t = std::array<int, 3>;
     using point_t = typename ndt_t::point_t;
@@ -136,8 +147,8 @@ inline void from(
                         sample(b.at(7), p));
     };
 
-    std::vector<float> tmp;
-    auto process_bundle = [&src, &tmp, &ivm, &threshold, &sample_bundle](const index_t &bi, const distribution_bundle_t &b) {
+    cslibs_ndt::utility::ThreadLocal<std::vector<float>> tmp_local(pool);
+    auto process_bundle = [&tmp_local, &ivm, &threshold, &sample_bundle](const index_t &, const distribution_bundle_t &b) {
         cslibs_math::statistics::Distribution<T, 3, 3> d;
         T occupancy = 0.0;
 
@@ -151,12 +162,18 @@ inline void from(
             return;
 
         cslibs_math_3d::Point3<T> mean(d.getMean());
+        std::vector<float> &tmp = tmp_local.local();
         tmp.emplace_back(static_cast<float>(mean(0)));
         tmp.emplace_back(static_cast<float>(mean(1)));
         tmp.emplace_back(static_cast<float>(mean(2)));
         tmp.emplace_back(static_cast<float>(sample_bundle(b, mean)));
     };
-    src.traverse(process_bundle);
+    src.traverse(process_bundle, pool);
+
+    std::vector<float> tmp;
+    tmp_local.traverse([&tmp](const std::vector<float> &t) {
+        tmp.insert(tmp.end(), t.begin(), t.end());
+    });
     from(tmp, dst);
 }
 
@@ -165,12 +182,13 @@ inline void from(
         const typename cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<T>::Ptr &src,
         sensor_msgs::PointCloud2 &dst,
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
-        const T &threshold = 0.169)
+        const T &threshold = 0.169,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
 
-    from<T>(*src, dst, ivm, threshold);
+    from<T>(*src, dst, ivm, threshold, pool);
 }
 
 }
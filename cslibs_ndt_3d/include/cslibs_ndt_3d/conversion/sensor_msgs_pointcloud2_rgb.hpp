@@ -33,10 +33,12 @@ inline void rgbFrom(
         sensor_msgs::PointCloud2 &dst,
         const T sampling_resolution,
         const T& threshold = 0.196,
-        const bool& allocate_all = false)
+        const bool& allocate_all = false,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (allocate_all)
-        src.allocatePartiallyAllocatedBundles();
+        src.allocatePartiallyAllocatedBundles(pool);
+    src.finalize();
 
     using index_t = std::array<int, 3>;
     using point_t = typename ndt_t::point_t;
@@ -62,7 +64,9 @@ inline void rgbFrom(
     const T bundle_resolution = src.getBundleResolution();
     const int chunk_step = static_cast<int>(bundle_resolution / sampling_resolution);
 
-    auto process_bundle = [&src, &cloud, &sample_bundle, &chunk_step, &bundle_resolution, &sampling_resolution, &threshold](
+    using point_list_t = std::vector<cslibs_math_3d::Point3<T>, Eigen::aligned_allocator<cslibs_math_3d::Point3<T>>>;
+    cslibs_ndt::utility::ThreadLocal<point_list_t> points(pool);
+    auto process_bundle = [&points, &sample_bundle, &chunk_step, &bundle_resolution, &sampling_resolution, &threshold](
             const index_t &bi, const distribution_bundle_t &b) {
         for (int k = 0 ; k < chunk_step ; ++ k) {
             for (int l = 0 ; l < chunk_step ; ++ l) {
@@ -71,12 +75,16 @@ inline void rgbFrom(
                                                       static_cast<T>(bi[1]) * bundle_resolution + (static_cast<T>(l)+0.5) * sampling_resolution,
                                                       static_cast<T>(bi[2]) * bundle_resolution + (static_cast<T>(m)+0.5) * sampling_resolution);
                     if (sample_bundle(b, p) >= threshold)
-                        cloud->insert(cslibs_math_3d::PointRGB3<T>(p));
+                        points.local().emplace_back(p);
                 }
             }
         }
     };
-    src.traverse(process_bundle);
+    src.traverse(process_bundle, pool);
+    points.traverse([&cloud](const point_list_t &ps) {
+        for (const cslibs_math_3d::Point3<T> &p : ps)
+            cloud->insert(cslibs_math_3d::PointRGB3<T>(p));
+    });
 
     const T min_z = cloud->min().getPoint()(2);
     const T max_z = cloud->max().getPoint()(2);
@@ -90,12 +98,13 @@ inline void rgbFrom(
         sensor_msgs::PointCloud2 &dst,
         const T sampling_resolution,
         const T& threshold = 0.196,
-        const bool& allocate_all = false)
+        const bool& allocate_all = false,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
 
-    rgbFrom<T>(*src, dst, sampling_resolution, threshold, allocate_all);
+    rgbFrom<T>(*src, dst, sampling_resolution, threshold, allocate_all, pool);
 }
 
 template<typename T,
@@ -108,10 +117,12 @@ inline void rgbFrom(
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
         const T sampling_resolution,
         const T& threshold = 0.196,
-        const bool& allocate_all = false)
+        const bool& allocate_all = false,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (allocate_all)
-        src.allocatePartiallyAllocatedBundles();
+        src.allocatePartiallyAllocatedBundles(pool);
+    src.finalize();
 
     using index_t = std::array<int, 3>;
     using point_t = typename ndt_t::point_t;
@@ -143,7 +154,9 @@ inline void rgbFrom(
     const T bundle_resolution = src.getBundleResolution();
     const int chunk_step = static_cast<int>(bundle_resolution / sampling_resolution);
 
-    auto process_bundle = [&src, &cloud, &sample_bundle, &chunk_step, &bundle_resolution, &sampling_resolution, &threshold](
+    using point_list_t = std::vector<cslibs_math_3d::Point3<T>, Eigen::aligned_allocator<cslibs_math_3d::Point3<T>>>;
+    cslibs_ndt::utility::ThreadLocal<point_list_t> points(pool);
+    auto process_bundle = [&points, &sample_bundle, &chunk_step, &bundle_resolution, &sampling_resolution, &threshold](
             const index_t &bi, const distribution_bundle_t &b) {
         for (int k = 0 ; k < chunk_step ; ++ k) {
             for (int l = 0 ; l < chunk_step ; ++ l) {
@@ -152,12 +165,16 @@ inline void rgbFrom(
                                                       static_cast<T>(bi[1]) * bundle_resolution + (static_cast<T>(l)+0.5) * sampling_resolution,
                                                       static_cast<T>(bi[2]) * bundle_resolution + (static_cast<T>(m)+0.5) * sampling_resolution);
                     if (sample_bundle(b, p) >= threshold)
-                        cloud->insert(cslibs_math_3d::PointRGB3<T>(p));
+                        points.local().emplace_back(p);
                 }
             }
         }
     };
-    src.traverse(process_bundle);
+    src.traverse(process_bundle, pool);
+    points.traverse([&cloud](const point_list_t &ps) {
+        for (const cslibs_math_3d::Point3<T> &p : ps)
+            cloud->insert(cslibs_math_3d::PointRGB3<T>(p));
+    });
 
     const T min_z = cloud->min().getPoint()(2);
     const T max_z = cloud->max().getPoint()(2);
@@ -172,12 +189,13 @@ inline void rgbFrom(
         const typename cslibs_gridmaps::utility::InverseModel<T>::Ptr &ivm,
         const T sampling_resolution,
         const T& threshold = 0.196,
-        const bool& allocate_all = false)
+        const bool& allocate_all = false,
+        cslibs_ndt::utility::ThreadPool *pool = nullptr)
 {
     if (!src)
         return;
 
-    rgbFrom<T>(*src, dst, ivm, sampling_resolution, threshold, allocate_all);
+    rgbFrom<T>(*src, dst, ivm, sampling_resolution, threshold, allocate_all, pool);
 }
 
 }
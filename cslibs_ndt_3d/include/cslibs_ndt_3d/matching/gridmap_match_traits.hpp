@@ -49,7 +49,32 @@ struct MatchTraits<MapT, typename std::enable_if<IsGridmap<MapT>::value>::type>
                                 gradient_t& g,
                                 hessian_t& h)
     {
-        auto* bundle = map.getDistributionBundle(point);
+        computeGradient(map.getDistributionBundle(point), point, J, H, param, score, g, h);
+    }
+
+    /// bi is the bundle index of point, see AbstractMap::toBundleIndices
+    static void computeGradient(const MapT& map,
+                                const point_t& point,
+                                const index_t& bi,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        computeGradient(map.getDistributionBundle(bi), point, J, H, param, score, g, h);
+    }
+
+    static void computeGradient(const distribution_bundle_t* bundle,
+                                const point_t& point,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
         if (!bundle)
             return;
 
@@ -28,6 +28,8 @@ struct MatchTraits<MapT, typename std::enable_if<IsOccupancyGridmap<MapT>::value
     using point_t = cslibs_math_3d::Point3d;
     using transform_t = cslibs_math_3d::Transform3d;
     using parameter_t = cslibs_ndt::matching::OccupancyParameter;
+    using distribution_bundle_t = typename MapT::distribution_bundle_t;
+    using index_t     = typename MapT::index_t;
 
     static transform_t makeTransform(const Eigen::Vector3d& linear,
                                      const Eigen::Vector3d& angular)
@@ -46,11 +48,36 @@ struct MatchTraits<MapT, typename std::enable_if<IsOccupancyGridmap<MapT>::value
                                 double& score,
                                 gradient_t& g,
                                 hessian_t& h)
+    {
+        computeGradient(map.getDistributionBundle(point), point, J, H, param, score, g, h);
+    }
+
+    /// bi is the bundle index of point, see AbstractMap::toBundleIndices
+    static void computeGradient(const MapT& map,
+                                const point_t& point,
+                                const index_t& bi,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
+    {
+        computeGradient(map.getDistributionBundle(bi), point, J, H, param, score, g, h);
+    }
+
+    static void computeGradient(const distribution_bundle_t* bundle,
+                                const point_t& point,
+                                const Jacobian& J,
+                                const Hessian& H,
+                                const parameter_t& param,
+                                double& score,
+                                gradient_t& g,
+                                hessian_t& h)
     {
         static constexpr double d1 = 0.95;
         static constexpr double d2 = 1 - d1;
 
-        auto* bundle = map.getDistributionBundle(point);
         if (!bundle)
             return;
 
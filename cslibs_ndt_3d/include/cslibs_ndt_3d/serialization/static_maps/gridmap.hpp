@@ -20,6 +20,20 @@ inline bool loadBinary(const std::string &path,
 {
     return cslibs_ndt::serialization::loadBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,T>(path, map);
 }
+
+template <typename T>
+inline bool saveContainer(const typename cslibs_ndt_3d::static_maps::Gridmap<T>::Ptr &map,
+                          const std::string &path)
+{
+    return cslibs_ndt::serialization::saveContainer<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,T>(map, path);
+}
+
+template <typename T>
+inline bool loadContainer(const std::string &path,
+                          typename cslibs_ndt_3d::static_maps::Gridmap<T>::Ptr &map)
+{
+    return cslibs_ndt::serialization::loadContainer<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,T>(path, map);
+}
 }
 }
 
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_3d/dynamic_maps/occupancy_gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+const std::size_t NUM_SCANS         = 5;
+const std::size_t NUM_SCAN_POINTS   = 20000;
+const std::size_t NUM_THREADS       = 4;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using bundle_t      = typename map_t::distribution_bundle_t;
+
+/// dense scan of a shell around the sensor, rays overlap close to the sensor
+typename pointcloud_t::ConstPtr generateScan()
+{
+    rng_t<1> rng_direction(-1.0, 1.0);
+    rng_t<1> rng_range(8.0, 10.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j) {
+        const point_t d(rng_direction.get(), rng_direction.get(), rng_direction.get());
+        scan->insert(d * (rng_range.get() / d.length()));
+    }
+    return scan;
+}
+
+TEST(Test_cslibs_ndt_3d, testDeduplicatedInsert)
+{
+    map_t map(0.5), deduplicated(0.5), parallel(0.5);
+    const cslibs_math_3d::Transform3d origin(cslibs_math_3d::Vector3d(0.5, -1.0, 0.25),
+                                             cslibs_math_3d::Quaternion<double>(0.1, 0.0, 0.3));
+    cslibs_ndt::utility::ThreadPool pool(NUM_THREADS);
+
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        const typename pointcloud_t::ConstPtr scan = generateScan();
+        map.insert(scan, origin);
+        deduplicated.insertDeduplicated(scan, origin);
+        parallel.insertDeduplicated(scan, origin, &pool);
+    }
+
+    /// free and occupied counts are exactly the same
+    std::size_t bundles = 0;
+    map.traverse([&deduplicated, &parallel, &bundles](const index_t &bi, const bundle_t &b) {
+        ++ bundles;
+        const bundle_t *bb = deduplicated.get(bi);
+        const bundle_t *pb = parallel.get(bi);
+        ASSERT_NE(bb, nullptr);
+        ASSERT_NE(pb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(), bb->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), bb->at(i)->numOccupied());
+            EXPECT_EQ(b.at(i)->numFree(), pb->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), pb->at(i)->numOccupied());
+        }
+    });
+    std::size_t deduplicated_bundles = 0, parallel_bundles = 0;
+    deduplicated.traverse([&deduplicated_bundles](const index_t &, const bundle_t &) {
+        ++ deduplicated_bundles;
+    });
+    parallel.traverse([&parallel_bundles](const index_t &, const bundle_t &) {
+        ++ parallel_bundles;
+    });
+    EXPECT_GT(bundles, 0ul);
+    EXPECT_EQ(bundles, deduplicated_bundles);
+    EXPECT_EQ(bundles, parallel_bundles);
+}
+
+TEST(Test_cslibs_ndt_3d, testDDAInsert)
+{
+    map_t map(0.5), deduplicated(0.5);
+    const typename pointcloud_t::ConstPtr scan = generateScan();
+    map.insert<typename map_t::dda_iterator_t>(scan);
+    deduplicated.insertDeduplicated<typename map_t::dda_iterator_t>(scan);
+
+    /// the traversal visits all bundles a ray passes, starting at the sensor
+    const bundle_t *b = map.get(point_t(0.1, 0.1, 0.1));
+    ASSERT_NE(b, nullptr);
+    EXPECT_GT(b->at(0)->numFree(), 0ul);
+    map.traverse([&deduplicated](const index_t &bi, const bundle_t &b) {
+        const bundle_t *bb = deduplicated.get(bi);
+        ASSERT_NE(bb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i)
+            EXPECT_EQ(b.at(i)->numFree(), bb->at(i)->numFree());
+    });
+}
+
+TEST(Test_cslibs_ndt_3d, testRangeImageInsert)
+{
+    /// 16 rows of 900 beams, like a spinning scanner
+    std::vector<double> elevations, azimuths;
+    for (std::size_t r = 0 ; r < 16 ; ++ r)
+        elevations.emplace_back(-0.26 + 0.035 * r);
+    for (std::size_t c = 0 ; c < 900 ; ++ c)
+        azimuths.emplace_back(-M_PI + 2.0 * M_PI * c / 900.0);
+    const typename map_t::ray_table_t rays(elevations, azimuths);
+    ASSERT_EQ(16ul * 900ul, rays.size());
+
+    rng_t<1> rng_range(5.0, 15.0);
+    std::vector<double> ranges;
+    typename pointcloud_t::Ptr cloud(new pointcloud_t);
+    for (std::size_t k = 0 ; k < rays.size() ; ++ k) {
+        ranges.emplace_back(rng_range.get());
+        cloud->insert(rays[k] * ranges.back());
+    }
+    const cslibs_math_3d::Transform3d origin(cslibs_math_3d::Vector3d(0.5, -1.0, 0.25),
+                                             cslibs_math_3d::Quaternion<double>(0.1, 0.0, 0.3));
+
+    map_t cloud_map(0.5), range_map(0.5);
+    cloud_map.insertDeduplicated(cloud, origin);
+    range_map.insertRanges(rays, ranges.data(), origin, 0.0, 100.0);
+
+    std::size_t bundles = 0;
+    cloud_map.traverse([&range_map, &bundles](const index_t &bi, const bundle_t &b) {
+        ++ bundles;
+        const bundle_t *rb = range_map.get(bi);
+        ASSERT_NE(rb, nullptr);
+        for (std::size_t i = 0 ; i < map_t::bin_count ; ++ i) {
+            EXPECT_EQ(b.at(i)->numFree(), rb->at(i)->numFree());
+            EXPECT_EQ(b.at(i)->numOccupied(), rb->at(i)->numOccupied());
+        }
+    });
+    EXPECT_GT(bundles, 0ul);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
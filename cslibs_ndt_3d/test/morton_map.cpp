@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt/backend/morton.hpp>
+#include <cslibs_ndt/conversion/map.hpp>
+#include <cslibs_ndt/serialization/map.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <vector>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 2000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using array_map_t   = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using morton_map_t  = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::Morton>;
+using kdtree_map_t  = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using index_t       = typename morton_map_t::index_t;
+using pointcloud_t  = typename morton_map_t::pointcloud_t;
+using point_t       = typename morton_map_t::point_t;
+
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_coord(-20.0, 20.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_coord.get(), rng_coord.get(), rng_coord.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+index_t offset(const index_t &bi, const index_t &origin)
+{
+    return index_t{{bi[0] - origin[0], bi[1] - origin[1], bi[2] - origin[2]}};
+}
+
+TEST(Test_cslibs_ndt_3d, testMortonTraversal)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const typename morton_map_t::size_t size{{24ul, 24ul, 24ul}};
+    const index_t min_index{{-24, -24, -24}};
+
+    array_map_t  array_map(cslibs_math_3d::Transform3d(), 2.0, size, min_index);
+    morton_map_t morton_map(cslibs_math_3d::Transform3d(), 2.0, size, min_index);
+    kdtree_map_t kdtree_map(2.0);
+    for (const auto &scan : scans) {
+        array_map.insert(scan);
+        morton_map.insert(scan);
+        kdtree_map.insert(scan);
+    }
+
+    /// the Morton backend keeps the bundles in Z-order of their offset to the extent
+    uint64_t last = 0ull;
+    std::size_t bundles = 0;
+    morton_map.traverse([&](const index_t &bi, const typename morton_map_t::distribution_bundle_t &b) {
+        const uint64_t code = cslibs_ndt::utility::morton_code<3>(offset(bi, morton_map.getMinBundleIndex()));
+        EXPECT_LT(last, code);
+        last = code;
+        ++ bundles;
+
+        const typename array_map_t::distribution_bundle_t *ba = array_map.get(bi);
+        ASSERT_NE(ba, nullptr);
+        for (std::size_t i = 0 ; i < morton_map_t::bin_count ; ++ i)
+            EXPECT_EQ(ba->at(i)->data().getN(), b.at(i)->data().getN());
+    });
+    std::vector<index_t> indices;
+    array_map.getBundleIndices(indices);
+    EXPECT_EQ(bundles, indices.size());
+
+    /// traverseMorton sorts any backend
+    auto sorted = [](const kdtree_map_t &map) {
+        uint64_t last = 0ull;
+        std::size_t bundles = 0;
+        map.traverseMorton([&last, &bundles](const index_t &bi, const typename kdtree_map_t::distribution_bundle_t &) {
+            const uint64_t code = cslibs_ndt::utility::morton_code<3>(bi);
+            EXPECT_LT(last, code);
+            last = code;
+            ++ bundles;
+        });
+        return bundles;
+    };
+    indices.clear();
+    kdtree_map.getBundleIndices(indices);
+    EXPECT_EQ(sorted(kdtree_map), indices.size());
+
+    const typename kdtree_map_t::ConstPtr snapshot = kdtree_map.snapshot();
+    kdtree_map.insert(scans.front(), cslibs_math_3d::Transform3d(50.0, 0.0, 0.0, 0.0, 0.0, 0.0));
+    indices.clear();
+    kdtree_map.getBundleIndices(indices);
+    EXPECT_EQ(sorted(kdtree_map), indices.size());
+}
+
+TEST(Test_cslibs_ndt_3d, testMortonConversion)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    typename kdtree_map_t::Ptr kdtree_map(new kdtree_map_t(1.0));
+    for (const auto &scan : scans)
+        kdtree_map->insert(scan);
+
+    using to_array_t    = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::static_map,cslibs_ndt::map::tags::dynamic_map,
+                                                          3,cslibs_ndt::Distribution,double>;
+    using to_morton_t   = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::static_map,cslibs_ndt::map::tags::dynamic_map,
+                                                          3,cslibs_ndt::Distribution,double,cslibs_ndt::backend::Morton>;
+    using from_array_t  = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::dynamic_map,cslibs_ndt::map::tags::static_map,
+                                                          3,cslibs_ndt::Distribution,double>;
+    using from_morton_t = cslibs_ndt::conversion::convert<cslibs_ndt::map::tags::dynamic_map,cslibs_ndt::map::tags::static_map,
+                                                          3,cslibs_ndt::Distribution,double,
+                                                          cslibs_ndt::map::tags::default_types<cslibs_ndt::map::tags::dynamic_map>::default_backend_t,
+                                                          cslibs_ndt::map::tags::default_types<cslibs_ndt::map::tags::dynamic_map>::default_dynamic_backend_t,
+                                                          cslibs_ndt::backend::Morton>;
+
+    const typename array_map_t::Ptr  array_map  = to_array_t::from(kdtree_map);
+    const typename morton_map_t::Ptr morton_map = to_morton_t::from(kdtree_map);
+    ASSERT_NE(array_map, nullptr);
+    ASSERT_NE(morton_map, nullptr);
+    EXPECT_NE(from_array_t::from(array_map), nullptr);
+    EXPECT_NE(from_morton_t::from(morton_map), nullptr);
+
+    std::vector<index_t> array_indices, morton_indices;
+    array_map->getBundleIndices(array_indices);
+    morton_map->getBundleIndices(morton_indices);
+    EXPECT_EQ(array_indices.size(), morton_indices.size());
+
+    typename morton_map_t::Ptr morton_loaded;
+    EXPECT_TRUE((cslibs_ndt::serialization::saveBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                                       cslibs_ndt::backend::Morton>(morton_map, "/tmp/morton_map_binary_3d")));
+    ASSERT_TRUE((cslibs_ndt::serialization::loadBinary<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                                       cslibs_ndt::backend::Morton>("/tmp/morton_map_binary_3d", morton_loaded)));
+    morton_indices.clear();
+    morton_loaded->getBundleIndices(morton_indices);
+    EXPECT_EQ(array_indices.size(), morton_indices.size());
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
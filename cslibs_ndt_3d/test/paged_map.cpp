@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+#include <cslibs_ndt/backend/paged.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cmath>
+#include <vector>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 1000;
+const std::size_t NUM_PROBES        = 1000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using array_map_t   = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using paged_map_t   = cslibs_ndt::map::Map<cslibs_ndt::map::tags::static_map,3,cslibs_ndt::Distribution,double,
+                                           cslibs_ndt::backend::Paged>;
+using index_t       = typename paged_map_t::index_t;
+using pointcloud_t  = typename paged_map_t::pointcloud_t;
+using point_t       = typename paged_map_t::point_t;
+
+/// a thin corridor through a large extent, as in a long drive
+std::vector<typename pointcloud_t::ConstPtr> generateScans()
+{
+    rng_t<1> rng_x(-90.0, 90.0);
+    rng_t<1> rng_y(-4.0, 4.0);
+    rng_t<1> rng_z(0.0, 3.0);
+
+    std::vector<typename pointcloud_t::ConstPtr> scans;
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i) {
+        typename pointcloud_t::Ptr scan(new pointcloud_t);
+        for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+            scan->insert(point_t(rng_x.get(), rng_y.get(), rng_z.get()));
+        scans.emplace_back(scan);
+    }
+    return scans;
+}
+
+struct value_t {
+    int v;
+    inline void merge(const value_t &) { }
+    inline std::size_t byte_size() const { return sizeof(*this); }
+};
+
+TEST(Test_cslibs_ndt_3d, testPagedStorage)
+{
+    using storage_t = cslibs_ndt::backend::PagedStorage<value_t, index_t>;
+
+    storage_t storage;
+    storage.set<cis::option::tags::array_size>(typename storage_t::size_t{{100ul, 50ul, 20ul}});
+    storage.set<cis::option::tags::array_offset>(index_t{{-50, -25, -3}});
+    EXPECT_EQ(storage.allocatedPages(), 0ul);
+
+    const std::vector<index_t> indices = {{{-50, -25, -3}}, {{49, 24, 16}}, {{-35, 0, 0}}, {{0, -10, 12}}, {{-36, 0, 0}}};
+    for (std::size_t i = 0 ; i < indices.size() ; ++ i)
+        storage.insert(indices[i], value_t{static_cast<int>(i)});
+
+    EXPECT_EQ(storage.size(), indices.size());
+    EXPECT_EQ(storage.allocatedPages(), 4ul);
+    for (std::size_t i = 0 ; i < indices.size() ; ++ i) {
+        const value_t *v = storage.get(indices[i]);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(v->v, static_cast<int>(i));
+    }
+    EXPECT_EQ(storage.get(index_t{{-51, 0, 0}}), nullptr);
+    EXPECT_EQ(storage.get(index_t{{0, 25, 0}}), nullptr);
+    EXPECT_EQ(storage.get(index_t{{0, 0, 1}}), nullptr);
+
+    std::size_t visited = 0;
+    storage.traverse([&indices, &visited](const index_t &index, const value_t &v) {
+        EXPECT_EQ(indices[v.v], index);
+        ++ visited;
+    });
+    EXPECT_EQ(visited, indices.size());
+
+    const storage_t copy(storage);
+    EXPECT_TRUE(storage.remove(indices[0]));
+    EXPECT_EQ(storage.get(indices[0]), nullptr);
+    EXPECT_NE(copy.get(indices[0]), nullptr);
+
+    storage_t assigned;
+    assigned = copy;
+    EXPECT_EQ(assigned.size(), indices.size());
+    assigned.remove(indices[1]);
+    EXPECT_NE(copy.get(indices[1]), nullptr);
+
+    EXPECT_THROW(storage.insert(index_t{{50, 0, 0}}, value_t{0}), std::out_of_range);
+}
+
+TEST(Test_cslibs_ndt_3d, testPagedGridmap)
+{
+    const std::vector<typename pointcloud_t::ConstPtr> scans = generateScans();
+    const typename paged_map_t::size_t size{{200ul, 200ul, 10ul}};
+    const index_t min_index{{-200, -200, -4}};
+
+    array_map_t  array_map(cslibs_math_3d::Transform3d(), 1.0, size, min_index);
+    paged_map_t  paged_map(cslibs_math_3d::Transform3d(), 1.0, size, min_index);
+    for (const auto &scan : scans) {
+        array_map.insert(scan);
+        paged_map.insert(scan);
+    }
+
+    std::size_t bundles = 0;
+    array_map.traverse([&paged_map, &bundles](const index_t &bi, const typename array_map_t::distribution_bundle_t &b) {
+        ++ bundles;
+        const typename paged_map_t::distribution_bundle_t *bp = paged_map.get(bi);
+        ASSERT_NE(bp, nullptr);
+        for (std::size_t i = 0 ; i < paged_map_t::bin_count ; ++ i)
+            EXPECT_EQ(b.at(i)->data().getN(), bp->at(i)->data().getN());
+    });
+    std::vector<index_t> indices;
+    paged_map.getBundleIndices(indices);
+    EXPECT_EQ(bundles, indices.size());
+
+    rng_t<1> rng_x(-90.0, 90.0);
+    rng_t<1> rng_y(-4.0, 4.0);
+    rng_t<1> rng_z(0.0, 3.0);
+    for (std::size_t i = 0 ; i < NUM_PROBES ; ++ i) {
+        const point_t p(rng_x.get(), rng_y.get(), rng_z.get());
+        const double expected = array_map.sample(p);
+        const double actual   = paged_map.sample(p);
+        if (std::isfinite(expected))
+            EXPECT_NEAR(expected, actual, 1e-9);
+        else
+            EXPECT_EQ(std::isnan(expected), std::isnan(actual));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cslibs_ndt_3d/dynamic_maps/gridmap.hpp>
+#include <cslibs_ndt_3d/static_maps/gridmap.hpp>
+
+#include <cslibs_math/random/random.hpp>
+
+#include <cmath>
+#include <set>
+
+const std::size_t NUM_SCANS         = 10;
+const std::size_t NUM_SCAN_POINTS   = 1000;
+
+template <std::size_t Dim>
+using rng_t = typename cslibs_math::random::Uniform<double, Dim>;
+
+using map_t         = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+using static_map_t  = cslibs_ndt_3d::static_maps::Gridmap<double>;
+using index_t       = typename map_t::index_t;
+using pointcloud_t  = typename map_t::pointcloud_t;
+using point_t       = typename map_t::point_t;
+using transform_t   = cslibs_math_3d::Transform3d;
+
+typename pointcloud_t::ConstPtr generateScan()
+{
+    rng_t<1> rng_coord(-10.0, 10.0);
+
+    typename pointcloud_t::Ptr scan(new pointcloud_t);
+    for (std::size_t j = 0 ; j < NUM_SCAN_POINTS ; ++ j)
+        scan->insert(point_t(rng_coord.get(), rng_coord.get(), rng_coord.get()));
+    return scan;
+}
+
+point_t bundleCenter(const transform_t &origin, const double bundle_resolution, const index_t &bi)
+{
+    return origin * point_t((bi[0] + 0.5) * bundle_resolution,
+                            (bi[1] + 0.5) * bundle_resolution,
+                            (bi[2] + 0.5) * bundle_resolution);
+}
+
+/// the query must yield exactly the bundles of a full traversal whose center is inside
+template <typename map_t, typename Query, typename Contains>
+std::size_t compare(const map_t &map, const transform_t &origin, const Query &query, const Contains &contains)
+{
+    std::set<index_t> expected;
+    map.traverse([&](const index_t &bi, const typename map_t::distribution_bundle_t &) {
+        if (contains(bundleCenter(origin, map.getBundleResolution(), bi)))
+            expected.insert(bi);
+    });
+
+    std::set<index_t> actual;
+    query([&](const index_t &bi, const typename map_t::distribution_bundle_t &b) {
+        EXPECT_TRUE(actual.insert(bi).second);
+        EXPECT_EQ(map.get(bi), &b);
+    });
+    EXPECT_TRUE(expected == actual);
+    return actual.size();
+}
+
+template <typename map_t>
+void testQueries(const map_t &map, const transform_t &origin)
+{
+    using bundle_t = typename map_t::distribution_bundle_t;
+    using fn_t     = std::function<void(const index_t&, const bundle_t&)>;
+
+    const point_t min(-3.0, -1.0, 2.0), max(4.5, 6.0, 5.5);
+    EXPECT_GT(compare(map, origin, [&](const fn_t &fn) { map.traverseRange(min, max, fn); },
+                      [&](const point_t &p) {
+        return p(0) >= min(0) && p(0) <= max(0) && p(1) >= min(1) && p(1) <= max(1) && p(2) >= min(2) && p(2) <= max(2);
+    }), 0ul);
+
+    const point_t center(1.0, -2.0, 0.5);
+    EXPECT_GT(compare(map, origin, [&](const fn_t &fn) { map.traverseRadius(center, 4.0, fn); },
+                      [&](const point_t &p) { return (p - center).length2() <= 16.0; }), 0ul);
+
+    /// a camera looking along the diagonal
+    const transform_t view(cslibs_math_3d::Vector3d(-8.0, -8.0, 0.0),
+                           cslibs_math_3d::Quaternion<double>(0.0, 0.0, M_PI / 4.0));
+    const std::array<double, 2> fov{{M_PI / 3.0, M_PI / 4.0}};
+    const transform_t v_T_w = view.inverse();
+    EXPECT_GT(compare(map, origin, [&](const fn_t &fn) { map.traverseFrustum(view, fov, 1.0, 12.0, fn); },
+                      [&](const point_t &p) {
+        const point_t p_v = v_T_w * p;
+        return p_v(0) >= 1.0 && p_v(0) <= 12.0 &&
+               std::abs(p_v(1)) <= p_v(0) * std::tan(fov[0] / 2.0) &&
+               std::abs(p_v(2)) <= p_v(0) * std::tan(fov[1] / 2.0);
+    }), 0ul);
+
+    /// regions outside of the map are empty
+    compare(map, origin, [&](const fn_t &fn) { map.traverseRadius(point_t(100.0, 0.0, 0.0), 1.0, fn); },
+            [](const point_t &) { return false; });
+}
+
+TEST(Test_cslibs_ndt_3d, testRangeQueries)
+{
+    map_t map(1.0);
+    for (std::size_t i = 0 ; i < NUM_SCANS ; ++ i)
+        map.insert(generateScan());
+    testQueries(map, transform_t());
+
+    /// pending copy-on-write changes are visited as well
+    const typename map_t::ConstPtr snapshot = map.snapshot();
+    map.insert(generateScan());
+    testQueries(map, transform_t());
+
+    const transform_t origin(cslibs_math_3d::Vector3d(0.5, -1.0, 0.25),
+                             cslibs_math_3d::Quaternion<double>(0.0, 0.0, 0.4));
+    map_t rotated(origin, 1.0);
+    rotated.insert(generateScan());
+    testQueries(rotated, origin);
+
+    static_map_t static_map(origin, 1.0,
+                            typename static_map_t::size_t{{20ul, 20ul, 20ul}},
+                            index_t{{-20, -20, -20}});
+    static_map.insert(generateScan());
+    testQueries(static_map, origin);
+}
+
+int main(int argc, char *argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
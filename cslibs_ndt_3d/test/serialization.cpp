@@ -10,6 +10,7 @@
 
 #include <cslibs_math/random/random.hpp>
 #include <fstream>
+#include <limits>
 
 const std::size_t MIN_NUM_SAMPLES = 10;
 const std::size_t MAX_NUM_SAMPLES = 100;
@@ -455,6 +456,146 @@ TEST(Test_cslibs_ndt_3d, testStaticOccupancyGridmapFileBinarySerialization)
     testStaticOccMap(map, map_from_file);
 }
 
+TEST(Test_cslibs_ndt_3d, testDynamicGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_3d::dynamic_maps::Gridmap<double>;
+    const typename map_t::Ptr map = generateDynamicMap();
+
+    // to file
+    cslibs_ndt_3d::dynamic_maps::saveContainer<double>(map, "/tmp/dynamic_map_3d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_3d::dynamic_maps::loadContainer<double>("/tmp/dynamic_map_3d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testDynamicMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_3d, testDynamicOccupancyGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_3d::dynamic_maps::OccupancyGridmap<double>;
+    const typename map_t::Ptr map = generateDynamicOccMap();
+
+    // to file
+    cslibs_ndt_3d::dynamic_maps::saveContainer<double>(map, "/tmp/dynamic_occ_map_3d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_3d::dynamic_maps::loadContainer<double>("/tmp/dynamic_occ_map_3d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testDynamicOccMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_3d, testStaticGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_3d::static_maps::Gridmap<double>;
+    const typename map_t::Ptr map = cslibs_ndt_3d::conversion::from<double>(generateDynamicMap());
+    EXPECT_NE(map, nullptr);
+
+    // to file
+    cslibs_ndt_3d::static_maps::saveContainer<double>(map, "/tmp/static_map_3d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/static_map_3d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testStaticMap(map, map_from_file);
+}
+
+TEST(Test_cslibs_ndt_3d, testStaticOccupancyGridmapFileContainerSerialization)
+{
+    using map_t = cslibs_ndt_3d::static_maps::OccupancyGridmap<double>;
+    const typename map_t::Ptr map = cslibs_ndt_3d::conversion::from<double>(generateDynamicOccMap());
+    EXPECT_NE(map, nullptr);
+
+    // to file
+    cslibs_ndt_3d::static_maps::saveContainer<double>(map, "/tmp/static_occ_map_3d.ndt");
+
+    // from file
+    typename map_t::Ptr map_from_file;
+    const bool success = cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/static_occ_map_3d.ndt", map_from_file);
+
+    // tests
+    EXPECT_TRUE(success);
+    testStaticOccMap(map, map_from_file);
+}
+
+/// rewrite a container in place, the section table follows the header
+template <typename Fn>
+void corrupt(const std::string &from, const std::string &to, const Fn &modify)
+{
+    using namespace cslibs_ndt::serialization::container;
+    std::ifstream in(from, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    header_t h;
+    std::memcpy(&h, bytes.data(), sizeof(header_t));
+    for (std::size_t i = 0 ; i < h.section_count ; ++i) {
+        section_t s;
+        char *entry = &bytes[sizeof(header_t) + i * sizeof(section_t)];
+        std::memcpy(&s, entry, sizeof(section_t));
+        modify(s, &bytes[0]);
+        std::memcpy(entry, &s, sizeof(section_t));
+    }
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+TEST(Test_cslibs_ndt_3d, testCorruptedContainer)
+{
+    using namespace cslibs_ndt::serialization::container;
+    using map_t = cslibs_ndt_3d::static_maps::Gridmap<double>;
+    const typename map_t::Ptr map = cslibs_ndt_3d::conversion::from<double>(generateDynamicMap());
+    ASSERT_NE(map, nullptr);
+    cslibs_ndt_3d::static_maps::saveContainer<double>(map, "/tmp/static_map_3d.ndt");
+
+    /// a distribution index outside of the extent of the static storage
+    corrupt("/tmp/static_map_3d.ndt", "/tmp/corrupted_map_3d.ndt", [](section_t &s, char *bytes) {
+        if (s.type == section_type::INDEX && s.id == 1 && s.count > 0) {
+            const std::array<int, 3> far{{1 << 20, 0, 0}};
+            std::memcpy(bytes + s.offset, far.data(), sizeof(far));
+        }
+    });
+    typename map_t::Ptr map_from_file;
+    EXPECT_FALSE(cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/corrupted_map_3d.ndt", map_from_file));
+    EXPECT_EQ(map_from_file, nullptr);
+
+    /// the same for a bundle index
+    corrupt("/tmp/static_map_3d.ndt", "/tmp/corrupted_map_3d.ndt", [](section_t &s, char *bytes) {
+        if (s.type == section_type::BUNDLES && s.count > 0) {
+            const std::array<int, 3> far{{0, -(1 << 20), 0}};
+            std::memcpy(bytes + s.offset, far.data(), sizeof(far));
+        }
+    });
+    EXPECT_FALSE(cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/corrupted_map_3d.ndt", map_from_file));
+
+    /// offset + size wraps around and would pass a naive bounds check
+    corrupt("/tmp/static_map_3d.ndt", "/tmp/corrupted_map_3d.ndt", [](section_t &s, char *) {
+        if (s.type == section_type::DATA && s.id == 0) {
+            s.offset = std::numeric_limits<std::uint64_t>::max() - 8;
+            s.size   = 16;
+        }
+    });
+    Reader reader;
+    EXPECT_FALSE(reader.open("/tmp/corrupted_map_3d.ndt"));
+    EXPECT_FALSE(cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/corrupted_map_3d.ndt", map_from_file));
+
+    /// a record count whose byte size overflows
+    corrupt("/tmp/static_map_3d.ndt", "/tmp/corrupted_map_3d.ndt", [](section_t &s, char *) {
+        if (s.type == section_type::INDEX && s.id == 0)
+            s.count += (std::numeric_limits<std::uint64_t>::max() / sizeof(std::array<int, 3>)) + 1;
+    });
+    EXPECT_FALSE(cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/corrupted_map_3d.ndt", map_from_file));
+
+    EXPECT_TRUE(cslibs_ndt_3d::static_maps::loadContainer<double>("/tmp/static_map_3d.ndt", map_from_file));
+    testStaticMap(map, map_from_file);
+}
+
 int main(int argc, char *argv[])
 {
     testing::InitGoogleTest(&argc, argv);